@@ -44,6 +44,7 @@
 #define MAIN_H_
 
 #include <API.h>
+#include <robot.h>
 
 // Allow usage of this file in C++ programs
 #ifdef __cplusplus
@@ -112,6 +113,52 @@ void initialize();
  */
 void operatorControl();
 
+//RPi communication digital port definitions
+#define READY 1 //High while the command queue has room
+#define CMDA 2 //Least significant bit
+#define CMDB 3
+#define CMD0 4 //Least significant bit
+#define CMD1 5
+#define CMD2 6
+#define CMD3 7
+#define STROBE 8 //Toggled by the Pi once a command is on CMDA-CMD3
+#define DONE 9 //Toggled each time a command finishes or is dropped
+
+#define COMMAND_CANCEL 0
+#define COMMAND_LEFT 1
+#define COMMAND_RIGHT 2
+#define COMMAND_FIRE 3
+
+// Number of commands the Pi may have outstanding before READY goes low
+#define COMMAND_QUEUE_SIZE 8
+
+/**
+ * A command latched from the Pi. seq numbers commands in the order they were strobed in.
+ */
+typedef struct {
+	unsigned int seq;
+	unsigned char type;
+	unsigned char dist;
+} Command;
+
+/**
+ * Configures the Pi communication pins and starts the task that queues incoming commands.
+ * Must be called from a task once the scheduler is running.
+ */
+void commandInit(void);
+/**
+ * Waits for the next queued command and removes it from the queue.
+ *
+ * @return the oldest pending command
+ */
+Command commandNext(void);
+/**
+ * Notifies the Pi that a command returned by commandNext() has finished executing.
+ *
+ * @param cmd the finished command
+ */
+void commandDone(const Command *cmd);
+
 // End C++ export structure
 #ifdef __cplusplus
 }
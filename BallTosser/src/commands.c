@@ -0,0 +1,235 @@
+/** @file commands.c
+ * @brief Command queue between the vision Pi and the robot
+ *
+ * The Pi presents a command on CMDA-CMDB/CMD0-CMD3 and then toggles STROBE. A reader task
+ * latches the command on every STROBE edge and appends it to a bounded queue, so the Pi can
+ * keep streaming commands while the robot is still turning or firing. READY is held high
+ * while the queue has room for another command; the Pi must not toggle STROBE while it is low.
+ *
+ * Every command that finishes (or is dropped before it starts) toggles DONE and is reported on
+ * the serial port as "done <seq> <cmd>" / "drop <seq> <cmd>". Commands are numbered from 0 in
+ * the order their STROBE edges were seen, so the Pi can match notifications to commands either
+ * by counting DONE edges (each level is held for at least 2 ms) or by reading the serial log.
+ * A notifier task sends them, so neither holding DONE nor printing ever delays the reader;
+ * READY also goes low while too many notifications are waiting to be sent.
+ *
+ * Commands (CMDB:CMDA)
+ * 0: Cancel every pending command that has not started yet
+ * 1: Turn left by dist (CMD3:CMD0)
+ * 2: Turn right by dist (CMD3:CMD0)
+ * 3: Fire
+ *
+ * A turn queued behind another pending turn replaces it instead of being appended, so a fresh
+ * aim from the vision loop always supersedes a stale one that has not been acted on yet.
+ */
+
+#include "main.h"
+
+#ifndef MAX_DELAY
+#define MAX_DELAY ((unsigned long)-1)
+#endif
+
+//How often the reader task samples STROBE, in ms
+#define COMMAND_POLL_MS 1
+//How long DONE holds each level, so a drop and a done in a row are not one invisible blip
+#define COMMAND_DONE_HOLD_MS 2
+//Notifications waiting to be sent: room for a cancel over a full queue with a backlog
+#define COMMAND_NOTIFY_SIZE (COMMAND_QUEUE_SIZE * 2 + 2)
+//Most notifications one strobed command can cause: a cancel drops a full queue and is done
+#define COMMAND_NOTIFY_BURST (COMMAND_QUEUE_SIZE + 1)
+
+//A finished or dropped command waiting for the notifier
+typedef struct {
+	const char *what;
+	Command cmd;
+} Notification;
+
+static Command queue[COMMAND_QUEUE_SIZE];
+static unsigned int queueHead = 0; //Index of the oldest pending command
+static unsigned int queueCount = 0;
+static unsigned int nextSeq = 0;
+
+static Mutex queueLock;
+static Semaphore queueReady; //Given whenever a command is added
+static bool doneState = LOW;
+
+static Notification notifications[COMMAND_NOTIFY_SIZE];
+static unsigned int notifyHead = 0;
+static unsigned int notifyCount = 0;
+static Semaphore notifyReady; //Given whenever a notification is queued
+
+static void commandReader(void *ignore);
+
+//Reads the command currently presented on the command pins
+static Command commandLatch(void) {
+	Command cmd;
+
+	cmd.type = digitalRead(CMDA)
+			   + digitalRead(CMDB) * 2;
+	cmd.dist = digitalRead(CMD0)
+			   + digitalRead(CMD1) * 2
+			   + digitalRead(CMD2) * 4
+			   + digitalRead(CMD3) * 8;
+	return cmd;
+}
+
+//Index of the i-th pending command; queueLock must be held
+static unsigned int queueIndex(unsigned int i) {
+	return (queueHead + i) % COMMAND_QUEUE_SIZE;
+}
+
+//Queues a finished or dropped command for the notifier; queueLock must be held. READY keeps
+//room for every notification, so it is only full if the Pi ignored READY
+static bool commandNotify(const char *what, const Command *cmd) {
+	Notification *note;
+
+	if (notifyCount >= COMMAND_NOTIFY_SIZE)
+		return false;
+	note = &notifications[(notifyHead + notifyCount) % COMMAND_NOTIFY_SIZE];
+	note->what = what;
+	note->cmd = *cmd;
+	notifyCount++;
+	semaphoreGive(notifyReady);
+	return true;
+}
+
+//Sets READY while the queue and the notifications both have room for another command;
+//queueLock must be held
+static void commandReady(void) {
+	digitalWrite(READY, queueCount < COMMAND_QUEUE_SIZE &&
+		notifyCount + COMMAND_NOTIFY_BURST < COMMAND_NOTIFY_SIZE);
+}
+
+//Drops every pending command; queueLock must be held
+static void queueFlush(void) {
+	while (queueCount > 0) {
+		commandNotify("drop", &queue[queueHead]);
+		queueHead = queueIndex(1);
+		queueCount--;
+	}
+}
+
+//Adds a latched command to the queue, applying cancel and aim replacement rules
+static void queuePush(Command cmd) {
+	mutexTake(queueLock, MAX_DELAY);
+	cmd.seq = nextSeq++;
+
+	if (cmd.type == COMMAND_CANCEL) {
+		queueFlush();
+		commandNotify("done", &cmd);
+	}
+	else {
+		unsigned int tail = queueIndex(queueCount > 0 ? queueCount - 1 : 0);
+
+		if (cmd.type != COMMAND_FIRE && queueCount > 0 && queue[tail].type != COMMAND_FIRE) {
+			//Newer aim replaces the one still waiting
+			commandNotify("drop", &queue[tail]);
+			queue[tail] = cmd;
+		}
+		else if (queueCount < COMMAND_QUEUE_SIZE) {
+			queue[queueIndex(queueCount)] = cmd;
+			queueCount++;
+		}
+		else {
+			//Pi ignored READY; nothing sensible to do but refuse it
+			commandNotify("drop", &cmd);
+		}
+		semaphoreGive(queueReady);
+	}
+
+	commandReady();
+	mutexGive(queueLock);
+}
+
+//Samples STROBE and latches a new command on every edge
+static void commandReader(void *ignore) {
+	bool strobe = digitalRead(STROBE);
+
+	while (1) {
+		if (digitalRead(STROBE) != strobe) {
+			strobe = !strobe;
+			queuePush(commandLatch());
+		}
+		delay(COMMAND_POLL_MS);
+	}
+}
+
+//Toggles DONE and reports each queued notification on the serial port, outside queueLock
+static void commandNotifier(void *ignore) {
+	Notification note;
+
+	while (1) {
+		semaphoreTake(notifyReady, MAX_DELAY);
+		while (1) {
+			mutexTake(queueLock, MAX_DELAY);
+			if (notifyCount == 0) {
+				mutexGive(queueLock);
+				break;
+			}
+			note = notifications[notifyHead];
+			notifyHead = (notifyHead + 1) % COMMAND_NOTIFY_SIZE;
+			notifyCount--;
+			commandReady();
+			mutexGive(queueLock);
+			doneState = !doneState;
+			digitalWrite(DONE, doneState);
+			printf("%s %u %d\r\n", note.what, note.cmd.seq, note.cmd.type);
+			delay(COMMAND_DONE_HOLD_MS);
+		}
+	}
+}
+
+//Sets up the command pins and starts the reader task
+void commandInit(void) {
+	pinMode(READY, OUTPUT);
+	pinMode(DONE, OUTPUT);
+	pinMode(STROBE, INPUT);
+	pinMode(CMDA, INPUT);
+	pinMode(CMDB, INPUT);
+	pinMode(CMD0, INPUT);
+	pinMode(CMD1, INPUT);
+	pinMode(CMD2, INPUT);
+	pinMode(CMD3, INPUT);
+	digitalWrite(DONE, doneState);
+
+	queueLock = mutexCreate();
+	queueReady = semaphoreCreate();
+	notifyReady = semaphoreCreate();
+	digitalWrite(READY, HIGH);
+
+	taskCreate(commandReader, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+	taskCreate(commandNotifier, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+}
+
+//Blocks until a command is pending, then removes and returns it
+Command commandNext(void) {
+	Command cmd;
+
+	while (1) {
+		mutexTake(queueLock, MAX_DELAY);
+		if (queueCount > 0) {
+			cmd = queue[queueHead];
+			queueHead = queueIndex(1);
+			queueCount--;
+			commandReady();
+			mutexGive(queueLock);
+			return cmd;
+		}
+		mutexGive(queueLock);
+		semaphoreTake(queueReady, MAX_DELAY);
+	}
+}
+
+//Reports that a command returned by commandNext() has finished executing
+void commandDone(const Command *cmd) {
+	bool queued;
+
+	//READY keeps room for this; only a Pi that ignored it makes the wait
+	do {
+		mutexTake(queueLock, MAX_DELAY);
+		queued = commandNotify("done", cmd);
+		mutexGive(queueLock);
+		if (!queued)
+			delay(COMMAND_DONE_HOLD_MS);
+	} while (!queued);
+}
@@ -44,14 +44,10 @@
 //Sensors
 #define TRIGPOT 1 //Analog
 
-//RPi communication digital port definitions
-#define READY 1
-#define CMDA 2 //Least significant bit
-#define CMDB 3
-#define CMD0 4 //Least significant bit
-#define CMD1 5
-#define CMD2 6
-#define CMD3 7
+static const DriveConfig driveConfig = {
+	.left = { 1, { LDRIVE }, { -1 } },
+	.right = { 1, { RDRIVE }, { 1 } },
+};
 
 void turn(int, int);
 void fire(void);
@@ -74,50 +70,25 @@ void fire(void);
  * This task should never exit; it should end with some kind of infinite loop, even if empty.
  */
 void operatorControl() {
-	bool isReady = 1;
-	int command = 0;
-	int dist = 0;
-
-	//Prepare pins
-	pinMode(READY, OUTPUT);
-	pinMode(CMDA, INPUT);
-	pinMode(CMDB, INPUT);
-	pinMode(CMD0, INPUT);
-	pinMode(CMD1, INPUT);
-	pinMode(CMD2, INPUT);
-	pinMode(CMD3, INPUT);
+	Command cmd;
+
+	driveInit(&driveConfig);
+
+	//Start latching commands from the Pi
+	commandInit();
 
 	while (1) {
-		digitalWrite(READY, isReady);
-
-		/* Commands
-		 * 0: do nothing
-		 * 1: Turn left
-		 * 2: Turn right
-		 * 3: Fire
-		 */
-		command = digitalRead(CMDA)
-				  + digitalRead(CMDB)*2;
-		if (command == 3) {
-			isReady = 0;
-			digitalWrite(READY, isReady);
+		//Commands keep queueing up while this one runs
+		cmd = commandNext();
 
+		if (cmd.type == COMMAND_FIRE) {
 			fire();
-
-			isReady = 1;
 		}
 		else {
-			dist = digitalRead(CMD0)
-				   + digitalRead(CMD1) * 2
-				   +  digitalRead(CMD2) * 4
-				   +  digitalRead(CMD3) * 8;
-			isReady = 0;
-			digitalWrite(READY, isReady);
-
-			turn(command - 1, dist);
-
-			isReady = 1;
+			turn(cmd.type - COMMAND_LEFT, cmd.dist);
 		}
+
+		commandDone(&cmd);
 	}
 }
 
@@ -129,19 +100,12 @@ void turn(int dir, int dist) {
 	dist = dist*distScale;
 
 	if (dir) {
-		motorSet(LDRIVE, -speed);
-		motorSet(RDRIVE, -speed);
-		delay(dist);
-		motorStop(LDRIVE);
-		motorStop(RDRIVE);
+		driveDeadReckon(speed, -speed, dist);
 	}
 	else {
-		motorSet(LDRIVE, speed);
-		motorSet(RDRIVE, speed);
-		delay(dist);
-		motorStop(LDRIVE);
-		motorStop(RDRIVE);
+		driveDeadReckon(-speed, speed, dist);
 	}
+	driveStop();
 }
 
 void fire(void) {
@@ -0,0 +1,148 @@
+/** @file scenarios.c
+ * @brief Simulated scenarios for the BallTosser launcher and Pi command queue
+ *
+ * The model: the trigger pot drops 2000 per second at full trigger power and rests at 600.
+ * Commands are presented the way the Pi does it, on CMDA-CMD3 followed by a STROBE toggle,
+ * with operatorControl() running in its own task.
+ */
+
+#include "main.h"
+#include "sim.h"
+
+//Ports from opcontrol.c
+#define LDRIVE 1
+#define RDRIVE 10
+#define TRIG 2
+#define LAUNCHA 4
+#define TRIGPOT 1
+
+void fire(void);
+
+// Trigger pot reading at rest
+#define TRIG_REST 600
+
+static bool done, launching;
+static unsigned int doneEdges;
+static unsigned int shots;
+static bool turnedLeft, turnedRight;
+
+// Counts DONE toggles, shots and which ways the drive turned
+static void watch(void) {
+	if (simGetDigital(DONE) != done) {
+		done = !done;
+		doneEdges++;
+	}
+	if ((simGetMotor(LAUNCHA) > 0) != launching) {
+		launching = !launching;
+		if (launching)
+			shots++;
+	}
+	//LDRIVE is negative forwards
+	turnedLeft |= simGetMotor(LDRIVE) > 0 && simGetMotor(RDRIVE) > 0;
+	turnedRight |= simGetMotor(LDRIVE) < 0 && simGetMotor(RDRIVE) < 0;
+}
+
+static void ballTosser(void) {
+	simLinkAnalog(TRIGPOT, TRIG, -2000, 0, 4095);
+	simSetAnalog(TRIGPOT, TRIG_REST);
+	launching = false;
+	shots = 0;
+	turnedLeft = turnedRight = false;
+	simSetStep(watch);
+	initialize();
+}
+
+static void operatorControlTask(void *ignore) {
+	operatorControl();
+}
+
+// Starts operatorControl() and waits for it to set up the command pins
+static void startOperatorControl(void) {
+	taskCreate(operatorControlTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	delay(10);
+	//DONE keeps its level from the previous scenario; count edges from here
+	done = simGetDigital(DONE);
+	doneEdges = 0;
+}
+
+// Presents one command and strobes it in, as the Pi does
+static void send(unsigned char type, unsigned char dist) {
+	SIM_CHECK(simGetDigital(READY));
+	simSetDigital(CMDA, type & 1);
+	simSetDigital(CMDB, (type >> 1) & 1);
+	simSetDigital(CMD0, dist & 1);
+	simSetDigital(CMD1, (dist >> 1) & 1);
+	simSetDigital(CMD2, (dist >> 2) & 1);
+	simSetDigital(CMD3, (dist >> 3) & 1);
+	simSetDigital(STROBE, !simGetDigital(STROBE));
+	delay(5);
+}
+
+// Waits until the robot has reported this many finished or dropped commands
+static void waitDone(unsigned int count) {
+	while (doneEdges < count)
+		delay(1);
+}
+
+static void fireResets(void) {
+	ballTosser();
+	fire();
+	SIM_CHECK(shots == 1);
+	SIM_CHECK(simGetAnalog(TRIGPOT) >= 500);
+	SIM_CHECK(simGetMotor(TRIG) == 0);
+	SIM_CHECK(simGetMotor(LAUNCHA) == 0);
+}
+
+static void commandsQueueWhileFiring(void) {
+	ballTosser();
+	startOperatorControl();
+	send(COMMAND_FIRE, 0);
+	send(COMMAND_LEFT, 3);
+	//Fresher aim replaces the left turn, which is dropped
+	send(COMMAND_RIGHT, 4);
+	waitDone(3);
+	SIM_CHECK(shots == 1);
+	SIM_CHECK(turnedRight);
+	SIM_CHECK(!turnedLeft);
+	SIM_CHECK(simGetDigital(READY));
+}
+
+static void cancelDropsPending(void) {
+	ballTosser();
+	startOperatorControl();
+	send(COMMAND_FIRE, 0);
+	send(COMMAND_FIRE, 0);
+	send(COMMAND_CANCEL, 0);
+	//Second shot dropped, cancel done, first shot done
+	waitDone(3);
+	delay(100);
+	SIM_CHECK(doneEdges == 3);
+	SIM_CHECK(shots == 1);
+}
+
+static void cancelKeepsStrobing(void) {
+	unsigned char i;
+
+	ballTosser();
+	startOperatorControl();
+	for (i = 0; i < 5; i++)
+		send(COMMAND_FIRE, 0);
+	//The cancel's five notifications take 10 ms to send; both strobes after it land inside
+	send(COMMAND_CANCEL, 0);
+	send(COMMAND_FIRE, 0);
+	send(COMMAND_FIRE, 0);
+	//Four shots dropped and the cancel, then the first shot and both new ones done
+	while (doneEdges < 8 && millis() < 6000)
+		delay(1);
+	delay(100);
+	//A lost strobe pair would leave six
+	SIM_CHECK(doneEdges == 8);
+}
+
+const SimScenario simScenarios[] = {
+	{ "fire resets trigger", fireResets, 5000 },
+	{ "commands queue while firing", commandsQueueWhileFiring, 5000 },
+	{ "cancel drops pending commands", cancelDropsPending, 5000 },
+	{ "cancel keeps strobing", cancelKeepsStrobing, 10000 },
+	{ NULL, NULL, 0 }
+};
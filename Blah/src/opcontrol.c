@@ -39,6 +39,15 @@
 #define DRIVEFR 2
 #define DRIVEFL 9 //Forward -127
 #define DRIVERL 10
+// Drive stick shaping: no creep near the centre, finer control at low speed
+#define DRIVE_CURVE(x) CURVE_EXPO(CURVE_DEADBAND(x, 10), 40)
+
+static const DriveConfig driveConfig = {
+	.left = { 2, { DRIVEFL, DRIVERL }, { -1, -1 } },
+	.right = { 2, { DRIVERR, DRIVEFR }, { 1, 1 } },
+};
+
+static CURVE_TABLE(driveCurve, DRIVE_CURVE);
 
 /*
  * Runs the user operator control code. This function will be started in its own task with the
@@ -58,11 +67,11 @@
  * This task should never exit; it should end with some kind of infinite loop, even if empty.
  */
 void operatorControl() {
+	driveInit(&driveConfig);
+
 	while (1) {
-		motorSet(DRIVERR, joystickGetAnalog(1,2));
-		motorSet(DRIVEFR, joystickGetAnalog(1,2));
-		motorSet(DRIVEFL, -joystickGetAnalog(1,3));
-		motorSet(DRIVERL, -joystickGetAnalog(1,3));
+		driveTank(curveApply(driveCurve, joystickGetAnalog(1,3)),
+			curveApply(driveCurve, joystickGetAnalog(1,2)));
 
 		if(joystickGetDigital(1,6,JOY_UP) == 1) {
 			motorSet(ARM, 127);
@@ -2,8 +2,12 @@
 # This file should only be edited by advanced users
 
 DEVICE=VexCortex
+# Shared robot library (drive, arm, sensors, telemetry) linked into every project
+ROBOTLIB=$(ROOT)/../robotlib
+# Its archive for the options below, built in a directory of its own for each variant
+ROBOTLIBOUT=$(ROBOTLIB)/bin/$(VARIANT)/librobot.a
 # Libraries to include in the link (use -L and -l) e.g. -lm, -lmyLib
-LIBRARIES=$(ROOT)/firmware/*.a -lgcc -lm
+LIBRARIES=$(ROBOTLIBOUT) $(ROOT)/firmware/*.a -lgcc -lm
 # Prefix for ARM tools (must be on the path)
 MCUPREFIX=arm-none-eabi-
 # Flags applied to the assembler, compiler, and linker command lines
@@ -21,21 +25,65 @@ ASMEXT=s
 CEXT=c
 CPPEXT=cpp
 HEXT=h
-INCLUDE=-I$(ROOT)/include -I$(ROOT)/src
+INCLUDE=-I$(ROOT)/include -I$(ROOT)/src -I$(ROBOTLIB)/include
 OUTBIN=output.bin
 OUTNAME=output.elf
+OUTMAP=output.map
+# Flash/RAM report generator and the saved report it compares against
+SIZEREPORT=$(ROOT)/../tools/sizereport.sh
+SIZEBASELINE=$(ROOT)/sizereport.baseline
+# RAM map report generator
+RAMMAP=$(ROOT)/../tools/rammap.sh
+# Trajectory planner run on the host by make trajectories
+TRAJGEN=$(ROOT)/../tools/trajgen/trajgen.c
+
+# Set LTO=1 to build with link-time optimization
+LTO?=
+ifneq ($(LTO),)
+LTOFLAGS=-flto
+endif
+
+# Set ENCODERS=1 to take drive feedback from quadrature encoders instead of IMEs (see drive.h);
+# rebuild the project with make clean all after changing it (the library keeps each variant)
+ENCODERS?=
+ifneq ($(ENCODERS),)
+DRIVEFLAGS=-DDRIVE_ENCODERS
+endif
+
+# Set RECORD=1 to log sensor reads and motor commands for make replay (see record.h); rebuild
+# the project with make clean all after changing it (the library keeps each variant)
+RECORD?=
+ifneq ($(RECORD),)
+RECORDDEFS=-DRECORD
+RECORDFLAGS=-Wl,--wrap=analogRead,--wrap=digitalRead,--wrap=imeGet,--wrap=imeGetVelocity \
+	-Wl,--wrap=encoderGet,--wrap=ultrasonicGet,--wrap=millis,--wrap=motorSet,--wrap=motorStop
+endif
+
+# Library build variant of the options above; must match VARIANT in robotlib/common.mk
+VARIANT:=arm$(if $(LTO),-lto)$(if $(ENCODERS),-encoders)$(if $(RECORD),-record)
 
 # Advanced flags for the compiler and linker specifying optimization, warning, and error options
 AFLAGS:=$(MCUAFLAGS)
 ARFLAGS:=$(MCUCFLAGS)
-CCFLAGS:=-c -Wall $(MCUCFLAGS) -Os -ffunction-sections -fsigned-char -fomit-frame-pointer -fsingle-precision-constant
+CCFLAGS:=-c -Wall $(MCUCFLAGS) -Os -ffunction-sections -fsigned-char -fomit-frame-pointer -fsingle-precision-constant -MMD -MP $(LTOFLAGS) $(DRIVEFLAGS) $(RECORDDEFS)
 CFLAGS:=$(CCFLAGS) -std=gnu99 -Werror=implicit-function-declaration
-CPPFLAGS:=$(CCFLAGS) -fno-exceptions -fno-rtti -felide-constructors
-LDFLAGS:=-Wall $(MCUCFLAGS) $(MCULFLAGS) -Wl,--gc-sections
+CPPFLAGS:=$(CCFLAGS) -std=gnu++11 -fno-exceptions -fno-rtti -felide-constructors
+LDFLAGS:=-Wall $(MCUCFLAGS) $(MCULFLAGS) -Wl,--gc-sections -Wl,-Map=$(BINDIR)/$(OUTMAP) $(LTOFLAGS) $(RECORDFLAGS)
+
+# Host compiler and flags for the simulated scenarios run by make test and make bench; the
+# record log is always built there, for scenarios that replay a run
+HOSTCC=gcc
+HOSTSIM=$(ROOT)/../host
+HOSTDIR=$(BINDIR)/host
+HOSTCFLAGS:=-std=gnu99 -O1 -g -Wall -fsigned-char -fcommon -Werror=implicit-function-declaration \
+	$(DRIVEFLAGS) -DRECORD
+
+# Compiler cache to wrap the compilers with, e.g. make CCACHE=ccache (empty disables)
+CCACHE?=
 
 # Aliases to the tools used
 AR:=$(MCUPREFIX)ar
 AS:=$(MCUPREFIX)as
-CC:=$(MCUPREFIX)gcc
-CPPCC:=$(MCUPREFIX)g++
+CC:=$(CCACHE) $(MCUPREFIX)gcc
+CPPCC:=$(CCACHE) $(MCUPREFIX)g++
 OBJCOPY:=$(MCUPREFIX)objcopy
@@ -39,7 +39,15 @@
 #define TRIGGER 2
 #define LAUNCH_1 4
 #define LAUNCH_2 5
+// Drive stick shaping: no creep near the centre, finer control at low speed
+#define DRIVE_CURVE(x) CURVE_EXPO(CURVE_DEADBAND(x, 10), 40)
 
+static const DriveConfig driveConfig = {
+	.left = { 1, { DRIVE_L }, { -1 } },
+	.right = { 1, { DRIVE_R }, { 1 } },
+};
+
+static CURVE_TABLE(driveCurve, DRIVE_CURVE);
 
 /*
  * Runs the user operator control code. This function will be started in its own task with the
@@ -61,9 +69,11 @@
 
 
 void operatorControl() {
+	driveInit(&driveConfig);
+
 	while(1) {
-		motorSet(DRIVE_L, -joystickGetAnalog(1,3));
-		motorSet(DRIVE_R, joystickGetAnalog(1,2));
+		driveTank(curveApply(driveCurve, joystickGetAnalog(1,3)),
+			curveApply(driveCurve, joystickGetAnalog(1,2)));
 
 		if (joystickGetDigital(1, 5, JOY_UP)) {
 			motorSet(TRIGGER, 127);
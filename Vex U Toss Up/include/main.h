@@ -44,6 +44,7 @@
 #define MAIN_H_
 
 #include <API.h>
+#include <robot.h>
 
 // Allow usage of this file in C++ programs
 #ifdef __cplusplus
@@ -111,6 +112,93 @@ void initialize();
  * This task should never exit; it should end with some kind of infinite loop, even if empty.
  */
 void operatorControl();
+/**
+ * Lets the autonomous routine and alliance be chosen on the LCD, or loads the saved choice.
+ * Called from initialize().
+ */
+void autonomousInit();
+/**
+ * Sets the arm to hold where it is. Call before the first pass of driverControl().
+ */
+void driverControlInit();
+/**
+ * Runs one pass of the driver controls. operatorControl() calls it in a loop, and autonomous()
+ * while it plays a route recorded in driver control (see route.h).
+ */
+void driverControl();
+
+// Robot port definitions shared by autonomous and operator control
+#define DRIVE_FL 6 //Left drive 127 is forward
+#define DRIVE_ML 7
+#define DRIVE_MR 8 //right drive -127 is forward
+#define DRIVE_FR 9
+
+#define ARM_TL 2 //-127 is up? lolsure
+#define ARM_TR 3 //-127 is up
+#define ARM_BL 4 //-127 is up
+#define ARM_BR 5 //127 is up
+#define ARM_IDLE_SPEED 8
+
+//Measured on the robot and saved with calib.h; see calibration in init.c for the defaults
+#define ARM_POS_BOT (calibration.armBot)
+#define ARM_POS_LOW (calibration.armLow)
+#define ARM_POS_MID (calibration.armMid)
+#define ARM_POS_TOP (calibration.armTop)
+//Driver control arm presets
+#define ARM_PRESET_HIGH (calibration.presetHigh)
+#define ARM_PRESET_LOW (calibration.presetLow)
+
+#define IN_L 1 //-127 intake
+#define IN_R 10
+
+#define LIMIT_TOP 3
+#define LIMIT_BOT 2
+
+#define ARM_POT 1
+#define LINESENSE_L 2
+#define LINESENSE_R 3
+
+#define LINE_THRESH (calibration.lineThresh)
+//Ultrasonic readings that put the robot in scoring range of the goal
+#define GOAL_NEAR (calibration.goalNear)
+#define GOAL_FAR (calibration.goalFar)
+
+//Events posted by the sensor watches set up in initialize()
+#define EVENT_LINE_LEFT (EVENT_USER)
+#define EVENT_LINE_RIGHT (EVENT_USER + 1)
+#define EVENT_GOAL_IN_RANGE (EVENT_USER + 2)
+
+#define IME_LEFT 0
+#define IME_RIGHT 1
+//Drive geometry for odometry in inches; measure both on the robot
+#define DRIVE_WHEEL_DIAMETER 4.0f
+#define DRIVE_TRACK_WIDTH 15.0f
+//Drive quadrature encoders, used instead of the IMEs when built with ENCODERS=1
+#define ENC_LEFT_TOP 5
+#define ENC_LEFT_BOT 7
+#define ENC_RIGHT_TOP 9
+#define ENC_RIGHT_BOT 12
+
+// Front ultrasonic, set up in initialize()
+extern Ultrasonic ultraFront;
+
+// Drive tables planned from paths/ by make trajectories
+extern const Trajectory ramCurve;
+
+// Positions and thresholds that change when sensors are re-mounted, loaded in initialize()
+typedef struct {
+	int armBot;
+	int armLow;
+	int armMid;
+	int armTop;
+	int presetHigh;
+	int presetLow;
+	int lineThresh;
+	int goalNear;
+	int goalFar;
+} Calibration;
+
+extern Calibration calibration;
 
 // End C++ export structure
 #ifdef __cplusplus
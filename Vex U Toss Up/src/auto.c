@@ -33,80 +33,54 @@
 */
 
 #include "main.h"
-#include "api.h"
 
-#define DRIVE_FL 6 //Left drive 127 is forward
-#define DRIVE_ML 7
-#define DRIVE_MR 8 //right drive -127 is forward
-#define DRIVE_FR 9
-
-#define ARM_TL 2 //-127 is up? lolsure
-#define ARM_TR 3 //-127 is up
-#define ARM_BL 4 //-127 is up
-#define ARM_BR 5 //127 is up
-#define ARM_IDLE_SPEED 8
-
-#define ARM_POS_BOT 4000
-#define ARM_POS_LOW 3550
-#define ARM_POS_MID 3100
-#define ARM_POS_TOP 2000
-
-#define IN_L 1 //-127 intake
-#define IN_R 10
-
-#define LIMIT_TOP 3
-#define LIMIT_BOT 2
-#define COLOUR_JUMPER 9
-
-#define ARM_POT 1
-#define LINESENSE_L 2
-#define LINESENSE_R 3
-
-#define LINE_THRESH 300
-
-#define IME_LEFT 0
-#define IME_RIGHT 1
+//Time the autonomous selector waits for an LCD button before keeping the saved choice
+#define SELECT_TIME 5000
 
 #define LED_R 6
 #define LED_g 8
 
-Ultrasonic ultraFront;
-
 
-void motorsLeft(int speed);
-void motorsRight(int speed);
-void motorsArm(int speed);
 void intake(void);
 void outtake(void);
-void stopDrive(void);
-void stopArm(void);
 void stopIntake(void);
-void clearEncoders (void);
-void driveStraight(int dist, int speed);
-void driveToLine(bool forwards);
-void driveTurn(int angle, int speed, bool colour);
 void driveTurn90(bool dir, bool colour);
-void driveBrake(void);
-void driveDeadReckon(int speedL, int speedR, int time);
-void armTo(int pos, int speed);
 void stopEmergency(void);
-void driveStop(void);
 
+//Backwards from the wall to the middle for blue, sketched from the timed arc and ram it
+//replaces; check it on the field. Red mirrors it across the x axis
+#define RAM_PATH_POINTS 4
+static const Waypoint ramPathBlue[RAM_PATH_POINTS] = {
+	{ 0, 0 }, { -14, 4 }, { -38, 16 }, { -64, 24 },
+};
+//Feedforward for the 100 rpm drive's 1000 counts/s at full power and its lag in speeding up,
+//then 0.3 of power per count behind the table; tune kS and kP on the robot
+static const TrajectoryGains ramGains = { { 8, 127, 10 }, 300 };
+
+//How autoScore() gets from the wall to the middle: the timed arc and ram, ramPathBlue by pure
+//pursuit, or the ramCurve table planned from paths/ramCurve.path
+typedef enum {
+	RAM_TIMED,
+	RAM_PURSUIT,
+	RAM_TABLE,
+} RamMove;
+
+//Drives the route recorded in driver control with 8-LEFT
+static void autoRoute(bool colour) {
+	driverControlInit();
+	if (routePlay(true)) {
+		while (routePlaying()) {
+			driverControl();
+			delay(5);
+		}
+	}
+	stopEmergency();
+}
 
-/*
-* Runs the user autonomous code. This function will be started in its own task with the default
-* priority and stack size whenever the robot is enabled via the Field Management System or the
-* VEX Competition Switch in the autonomous mode. If the robot is disabled or communications is
-* lost, the autonomous task will be stopped by the kernel. Re-enabling the robot will restart
-* the task, not re-start it from where it left off.
-*
-* Code running in the autonomous task cannot access information from the VEX Joystick. However,
-* the autonomous function can be invoked from another task if a VEX Competition Switch is not
-* available, and it can access joystick information if called in this way.
-*
-* The autonomous task may exit, unlike operatorControl() which should never exit. If it does
-* so, the robot will await a switch to another mode or disable/enable cycle.
-*/
+//Prints things to screen in absence of auton
+static void autoTelemetry(bool colour) {
+	telemetryRun(ultraFront, 100);
+}
 
 /*
 ************AUTONOMOUS ROUTINE:*******************
@@ -118,40 +92,22 @@ void driveStop(void);
 *6. Align with goal, confirm positioning and score 3 balls
 *7. Turn around, and swing intake about, hopefully hitting large balls over bridge
 */
-void autonomous() {
-	bool colour = digitalRead(COLOUR_JUMPER); //COLOUR_JUMPER 9
-	//BLUE IS 0, RED IS 1. code as for BLUE;;0 == jumperIN, 1 == jumperOUT
+static void autoScore(bool colour, bool ram, RamMove move) {
+	//BLUE IS 0, RED IS 1. code as for BLUE
+	static EventQueue goalEvents;
+	Waypoint ramPath[RAM_PATH_POINTS];
+	PursuitPath ramPursuit = { ramPath, RAM_PATH_POINTS, -127, 10, 24, 0.5f, 10, 2 };
+	unsigned char i;
 	long currentTime;
 	long startTime;
-
-	clearEncoders();
-
-
-	if (digitalRead(5)==LOW){//prints things to screen in absence of auton
-
-		while(1) {
-			int armPos, count, countL, countR, lineL, lineR, ultraDist;
-			lineL = analogRead(LINESENSE_L);
-			lineR = analogRead(LINESENSE_R);
-			imeGet(0, &count);
-			imeGet(IME_LEFT, &countL);
-			imeGet(IME_RIGHT, &countR);
-			armPos = analogRead(ARM_POT);
-			ultraDist = ultrasonicGet(ultraFront);
-
-			printf(/*"Arm:%d, IME_L:%d, IME_R:%d, */"UltraDist:%d, LineL:%d, LineR:%d\r\n",
-					/*armPos, countL, countR,*/ ultraDist, lineL, lineR);
-			delay(100);
-		}
-	}
-
+	bool inRange;
 
 	armTo(ARM_POS_LOW, 127);
 	armTo(ARM_POS_BOT, 60);
 
 
 	//RAMMING AUTON, NO PICK UP 2 ON BACK WALL
-	if (!digitalRead(12)) { //RAM JUMPER 12 IN
+	if (ram) {
 		//Raise arm to release intake rollers
 
 
@@ -175,17 +131,29 @@ void autonomous() {
 		delay(1000);
 		driveStraight(-50,20);
 
-		if (colour) { //Turn to ram
-			driveDeadReckon(20, -60, 700);
+		if (move == RAM_TABLE) { //The same planned curve, played from flash
+			trajectoryFollow(&ramCurve, &ramGains, colour);
+		} else if (move == RAM_PURSUIT) { //One curve to the middle, not a turn then a ram
+			for (i = 0; i < RAM_PATH_POINTS; i++) {
+				ramPath[i].x = ramPathBlue[i].x;
+				ramPath[i].y = colour ? -ramPathBlue[i].y : ramPathBlue[i].y;
+			}
+			//Balls in the way can stall it short; that ends the ram as the timed one did
+			odomReset(0, 0, 0);
+			pursuitFollow(&ramPursuit, 2500);
 		} else {
-			driveDeadReckon(-60, 20, 700);
-		}
-		delay(500);
-		//driveTurn(10,60,colour);
+			if (colour) { //Turn to ram
+				driveDeadReckon(20, -60, 700);
+			} else {
+				driveDeadReckon(-60, 20, 700);
+			}
+			delay(500);
+			//driveTurn(10,60,colour);
 
 
-		//RAMMING SPEED! Dead reckon to middle, come back and turn slightly into bump
-		driveDeadReckon(-127,-127,1700);
+			//RAMMING SPEED! Dead reckon to middle, come back and turn slightly into bump
+			driveDeadReckon(-127,-127,1700);
+		}
 
 		driveBrake();
 		delay(500); //extra delay?
@@ -316,15 +284,12 @@ void autonomous() {
 
 	//Drive up to goal, make sure goal is there with timeout and score
 	armTo(1000,127); //All the way up
-	int ultraDistance = ultrasonicGet(ultraFront);
-	currentTime = millis();
-	startTime = millis();
-	while ((!((ultraDistance < 16) && (ultraDistance > 10))) && ((currentTime - startTime) < 4000)) {
-		driveDeadReckon(30,30,1);
-		currentTime = millis();
-		ultraDistance = ultrasonicGet(ultraFront);
-	}
-	if ((currentTime - startTime) < 4000) {
+	//The sampler task watches the ultrasonic, so this sleeps until the goal is in range
+	eventSubscribe(&goalEvents, EVENT_MASK(EVENT_GOAL_IN_RANGE));
+	driveDeadReckon(30, 30, 0);
+	inRange = eventWait(&goalEvents, NULL, 4000);
+	eventUnsubscribe(&goalEvents);
+	if (inRange) {
 		driveStop();
 		motorSet(IN_L, 127);
 		motorSet(IN_R, -127);
@@ -347,31 +312,65 @@ void autonomous() {
 
 	stopEmergency(); //END
 
-} //End of autonomous()
+} //End of autoScore()
 
+static void autoMain(bool colour) {
+	autoScore(colour, false, RAM_TIMED);
+}
 
+static void autoRam(bool colour) {
+	autoScore(colour, true, RAM_TIMED);
+}
 
-/////functions///////////////////////////////////////////////////////////////////////////////////////
-void motorsLeft(int speed){
-	motorSet(DRIVE_FL, speed);
-	motorSet(DRIVE_ML, speed);
-	return;
+static void autoCurve(bool colour) {
+	autoScore(colour, false, RAM_PURSUIT);
 }
-void motorsRight(int speed){
-	motorSet(DRIVE_FR, -speed);
-	motorSet(DRIVE_MR, -speed);
-	return;
+
+static void autoTable(bool colour) {
+	autoScore(colour, false, RAM_TABLE);
 }
 
-//positive is up
-void motorsArm(int speed){
-	motorSet(ARM_TL, -speed);
-	motorSet(ARM_TR, -speed);
-	motorSet(ARM_BL, -speed);
-	motorSet(ARM_BR, speed);
-	return;
+//Choices on the LCD at power up; the first is used until another is saved
+static const SelectorRoutine routines[] = {
+	{ "Score", autoMain },
+	{ "Ram", autoRam },
+	{ "Curve", autoCurve },
+	{ "Table", autoTable },
+	{ "Route", autoRoute },
+	{ "Telemetry", autoTelemetry },
+};
+
+/*
+* Shows the autonomous selector on the LCD. Called from initialize().
+*/
+void autonomousInit() {
+	selectorInit(uart1, routines, sizeof(routines) / sizeof(routines[0]), SELECT_TIME);
 }
 
+/*
+* Runs the user autonomous code. This function will be started in its own task with the default
+* priority and stack size whenever the robot is enabled via the Field Management System or the
+* VEX Competition Switch in the autonomous mode. If the robot is disabled or communications is
+* lost, the autonomous task will be stopped by the kernel. Re-enabling the robot will restart
+* the task, not re-start it from where it left off.
+*
+* Code running in the autonomous task cannot access information from the VEX Joystick. However,
+* the autonomous function can be invoked from another task if a VEX Competition Switch is not
+* available, and it can access joystick information if called in this way.
+*
+* The autonomous task may exit, unlike operatorControl() which should never exit. If it does
+* so, the robot will await a switch to another mode or disable/enable cycle.
+*/
+
+void autonomous() {
+	clearEncoders();
+	//Chosen on the LCD in initialize()
+	selectorRun();
+} //End of autonomous()
+
+
+
+/////functions///////////////////////////////////////////////////////////////////////////////////////
 void intake(void){
 	motorSet(IN_L, -127);
 	motorSet(IN_R, 127);
@@ -384,26 +383,6 @@ void outtake(void){
 	return;
 }
 
-void stopDrive(void){
-	motorStop(DRIVE_FL);
-	motorStop(DRIVE_ML);
-	motorStop(DRIVE_FR);
-	motorStop(DRIVE_MR);
-	return;
-}
-
-void driveStop(void){
-	stopDrive();
-	return;
-}
-
-void stopArm(void){
-	motorSet(ARM_TL, -ARM_IDLE_SPEED);
-	motorSet(ARM_TR, -ARM_IDLE_SPEED);
-	motorSet(ARM_BL, -ARM_IDLE_SPEED);
-	motorSet(ARM_BR, ARM_IDLE_SPEED);
-	return;
-}
 void stopIntake(void){
 	motorStop(IN_L);
 	motorStop(IN_R);
@@ -417,131 +396,6 @@ void stopEmergency(void){
 	delay(100000);
 }
 
-void clearEncoders (void){
-	imeReset(0);
-	imeReset(1);
-	return;
-}
-
-
-//Drives a set distance with straightness correction
-//dist: distance to travel, 620 = 1 revolution, positive is forwards, negative back
-//speed: valid range 0 to 127, but dont use small values or it wont move
-void driveStraight(int dist, int speed) {
-	int countL;
-	int countR;
-	int speedAdj;
-
-	if (dist < 0) {
-		speed = -speed;
-	}
-	clearEncoders();
-	do {
-		imeGet(IME_LEFT, &countL);
-		countL = -countL; //left encoder is reversed
-		imeGet(IME_RIGHT, &countR);
-		speedAdj = (countL - countR) * 1; //Speed adjustment factor
-
-		motorsLeft(speed - speedAdj);
-		motorsRight(speed + speedAdj);
-
-	} while ( (dist < 0 && (countL+countR)/2 > dist) || (dist > 0 && (countL+countR)/2 < dist));
-
-	stopDrive();
-	return;
-}
-
-//Drives until a front corner line sensor hits a line. Then turns so that both are on the line
-//forwards: True drives robot forwards to line, false drives back
-void driveToLine(bool forwards) {
-	int senseR, senseL;
-
-	int speedBack = -15;
-	int speed = 25;
-
-	if (!forwards) {
-		speed = -speed;
-		speedBack = -speedBack;
-	}
-
-	senseR = analogRead(LINESENSE_R);
-	senseL = analogRead(LINESENSE_L);
-	while ( (senseR > LINE_THRESH) && (senseL > LINE_THRESH) ) {
-		senseR = analogRead(LINESENSE_R);
-		senseL = analogRead(LINESENSE_L);
-		motorsRight(speed);
-		motorsLeft(speed);
-	}
-
-	if ( senseR <= LINE_THRESH && senseL > LINE_THRESH ) { //TODO Add feedback loop here, not recursive correction below
-		while ( senseL > LINE_THRESH && senseR <= LINE_THRESH ) { //Should correct overshoot
-			senseR = analogRead(LINESENSE_R);			//Also, needs to bias towards direction it came from to not get lost
-			senseL = analogRead(LINESENSE_L);
-			motorsRight(speedBack); //TODO Add timeout for feedback loop
-			motorsLeft(speed);
-		}
-	}
-	else if ( senseR > LINE_THRESH && senseL <= LINE_THRESH ){
-		while (senseR > LINE_THRESH && senseL <= LINE_THRESH ) {
-			senseR = analogRead(LINESENSE_R);
-			senseL = analogRead(LINESENSE_L);
-			motorsLeft(speedBack);
-			motorsRight(speed);
-		}
-	}
-	driveBrake();
-
-	/*senseR = analogRead(LINESENSE_R);
-	senseL = analogRead(LINESENSE_L);
-	if(senseL < LINE_THRESH && senseR < LINE_THRESH)
-		return;
-	else if(forwards==1){ //RECURSIVE CORRECTION (kind of)
-		driveToLine(0); //drive backwards to correct overshoot
-		return;}
-	else if(forwards==0){
-		driveToLine(1); //drive fowards to correct overshoot
-		return;}*/
-	return;
-}
-
-
-
-//Turns approximately the correct angle in a given direction on the spot. Not precise, no angle correction
-//Angle: positive is left (CCW), negative is right (CW), Approximately in degrees
-//Speed: from 0-127
-//Colour: Assume Blue when coding for colour=LOW. Red is HIGH
-void driveTurn(int angle, int speed, bool colour){
-	int dist;
-	double degToEncoder = 2.5;
-
-	if ( colour == HIGH ){
-		dist = -angle*degToEncoder;
-	}
-	else{
-		dist = angle*degToEncoder; //left wheel drives back, negative encoder count
-	}
-
-
-	int count; //uses one encoder only
-	clearEncoders();
-	if (dist > 0) {
-		do{
-			imeGet(IME_RIGHT, &count);
-			motorsRight(speed);
-			motorsLeft(-speed);
-		}while (count < dist);
-	}
-	else {
-		do{
-			imeGet(IME_LEFT, &count);
-			motorsRight(-speed);
-			motorsLeft(speed);
-		}while (count > dist);
-	}
-	return;
-}
-
-
 //DOESN'T REALLY WORK
 //Precise 90 degree turning function
 //dir: 0 is CCW (left), 1 is CW (right)
@@ -567,8 +421,7 @@ void driveTurn90(bool dir, bool colour){
 	clearEncoders();
 	if ( dir == 0 ){ //CCW left
 		do{
-			imeGet(IME_LEFT, &countL);
-			countL = -countL;
+			driveGetCounts(&countL, &countR);
 			motorsLeft(-speed);
 			motorsRight(speed);
 			printf("dist%d", countL);
@@ -577,7 +430,7 @@ void driveTurn90(bool dir, bool colour){
 	}
 	else{ //CW Right
 		do{
-			imeGet(IME_RIGHT, &countR);
+			driveGetCounts(&countL, &countR);
 			motorsLeft(speed);
 			motorsRight(-speed);
 			printf("dist%d", countR);
@@ -587,64 +440,3 @@ void driveTurn90(bool dir, bool colour){
 	//TODO: Implement left-right distance correction (one turning too fast) after fixing dual IMEs
 	return;
 }
-
-
-//Gets the last velocity of the wheels and applies braking speeds for a short time, then stops
-void driveBrake(void){
-	int velL;
-	int velR;
-	double brakeConst = .24;
-	bool encoderL = imeGetVelocity(IME_LEFT, &velL);
-	bool encoderR = imeGetVelocity(IME_RIGHT, &velR);
-
-	if (encoderL) { //Included a thing to make sure that it gets the IME velocity, or else just stops dumbly
-		motorsLeft(-velL*brakeConst);
-	} else { motorsLeft(0);}
-
-	if (encoderR) {
-		motorsLeft(-velR*brakeConst);
-	} else { motorsRight(0);}
-
-	delay(150);
-	stopDrive();
-
-	return;
-}
-
-//LOLOLOL GO FAST
-//Time dependent driving. For imprecise maneuvers
-void driveDeadReckon(int speedL, int speedR, int time) {
-	motorsLeft(speedL);
-	motorsRight(speedR);
-	delay(time);
-}
-
-//Moves arm to given position, at speed, up to limit switches
-//Valid ranges for speed: ~10-127, don't put small numbers or it won't move
-//TOPpos: 2300-2315
-//MIDpos: 3110-3133
-//BOTpos: 3990-4020
-
-void armTo(int pos, int speed) {
-	int currentPos = analogRead(ARM_POT);
-	int posThresh = 10; //Within posThresh of actual value
-
-	if (currentPos < pos) {
-		while (((currentPos + posThresh) < pos/* && digitalRead(LIMIT_BOT)==1*/)) {
-			currentPos = analogRead(ARM_POT); //TODO Test bottom limit switch integrity
-			motorsArm(-speed);
-		}
-	}
-	else if(currentPos > pos) {
-		while (((currentPos - posThresh) > pos) && digitalRead(LIMIT_TOP)==1) {
-			currentPos = analogRead(ARM_POT);
-			motorsArm(speed);
-		}
-	}
-
-	stopArm();
-return;
-}
-
-
-
@@ -33,16 +33,92 @@
 */
 
 #include "main.h"
-#include "api.h"
 
 #define led_r 6
 #define led_g 8
-#define limit_top 3
-#define limit_bot 2
-#define arm_pot 1
 
 Ultrasonic ultraFront;
 
+//Defaults until measured on the robot: 8-UP in driver control captures them on the LCD,
+//8-DOWN takes them from the programming cable
+Calibration calibration = {
+	.armBot = 4000,
+	.armLow = 3550,
+	.armMid = 3100,
+	.armTop = 2000,
+	.presetHigh = 2202,
+	.presetLow = 4040,
+	.lineThresh = 300,
+	.goalNear = 10,
+	.goalFar = 16,
+};
+
+static int ultraFrontGet() {
+	return ultrasonicGet(ultraFront);
+}
+
+static const CalibEntry calibEntries[] = {
+	{ "armBot", &calibration.armBot, armGetPos },
+	{ "armLow", &calibration.armLow, armGetPos },
+	{ "armMid", &calibration.armMid, armGetPos },
+	{ "armTop", &calibration.armTop, armGetPos },
+	{ "presetHigh", &calibration.presetHigh, armGetPos },
+	{ "presetLow", &calibration.presetLow, armGetPos },
+	{ "lineThresh", &calibration.lineThresh, NULL },
+	{ "goalNear", &calibration.goalNear, ultraFrontGet },
+	{ "goalFar", &calibration.goalFar, ultraFrontGet },
+};
+
+//Their windows come from the calibration in initialize()
+static EventWatch eventWatches[] = {
+	{ EVENT_LINE_LEFT, lineReadLeft, 0, 0 },
+	{ EVENT_LINE_RIGHT, lineReadRight, 0, 0 },
+	{ EVENT_GOAL_IN_RANGE, ultraFrontGet, 0, 0 },
+};
+
+static const DriveConfig driveConfig = {
+	.left = { 2, { DRIVE_FL, DRIVE_ML }, { 1, 1 } },
+	.right = { 2, { DRIVE_FR, DRIVE_MR }, { -1, -1 } },
+	.imeLeft = IME_LEFT,
+	.imeRight = IME_RIGHT,
+	.imeLeftReversed = true, //left encoder is reversed
+	.imeRightReversed = false,
+	.encLeftTop = ENC_LEFT_TOP,
+	.encLeftBottom = ENC_LEFT_BOT,
+	.encRightTop = ENC_RIGHT_TOP,
+	.encRightBottom = ENC_RIGHT_BOT,
+};
+
+//The gravity table's ends and the line threshold come from the calibration in initialize()
+static ArmConfig armConfig = {
+	.motors = { 4, { ARM_TL, ARM_TR, ARM_BL, ARM_BR }, { -1, -1, -1, 1 } },
+	.pot = ARM_POT,
+	.limitTop = LIMIT_TOP,
+	.limitBot = LIMIT_BOT,
+	.idleSpeed = ARM_IDLE_SPEED,
+	.holdP = 600,
+	.holdI = 10,
+	.holdD = 5000,
+	//Power that holds the arm still from the top to the bottom, heaviest where it reaches out
+	.gravity = { 6, 9, 12, 14, 14, 12, 9, 6 },
+	//The oversampled pot is steady enough to stop moves within a pot count and a half
+	.oversample = true,
+	.moveThresh = 6,
+};
+
+static const unsigned char oversampleChannels[] = { ARM_POT };
+
+//Counts are IME counts whichever encoders are fitted; no gyro, so heading comes from the sides
+static const OdomConfig odomConfig = {
+	.countsPerInch = DRIVE_COUNTS_PER_REV / (DRIVE_WHEEL_DIAMETER * 3.14159265f),
+	.trackWidth = DRIVE_TRACK_WIDTH,
+};
+
+static LineConfig lineConfig = {
+	.left = LINESENSE_L,
+	.right = LINESENSE_R,
+};
+
 /*
 * Runs pre-initialization code. This function will be started in kernel mode one time while the
 * VEX Cortex is starting up. As the scheduler is still paused, most API functions will fail.
@@ -54,12 +130,52 @@ Ultrasonic ultraFront;
 void initializeIO() {
 	pinMode(led_g, OUTPUT);
 	pinMode(led_r, OUTPUT);
-	pinMode(limit_top, INPUT);
-	pinMode(limit_bot, INPUT);
-	pinMode(arm_pot, INPUT_ANALOG);
+	pinMode(LIMIT_TOP, INPUT);
+	pinMode(LIMIT_BOT, INPUT);
+	pinMode(ARM_POT, INPUT_ANALOG);
 
 }
 
+static void bootCalibration() {
+	calibInit(calibEntries, sizeof(calibEntries) / sizeof(calibEntries[0]));
+	armConfig.gravityTop = ARM_POS_TOP;
+	armConfig.gravityBot = ARM_POS_BOT;
+	lineConfig.thresh = LINE_THRESH;
+	eventWatches[0].high = LINE_THRESH;
+	eventWatches[1].high = LINE_THRESH;
+	eventWatches[2].low = GOAL_NEAR + 1;
+	eventWatches[2].high = GOAL_FAR - 1;
+}
+
+static void bootSubsystems() {
+	eventInit(eventWatches, sizeof(eventWatches) / sizeof(eventWatches[0]));
+	driveInit(&driveConfig);
+	routeInit();
+	odomInit(&odomConfig);
+	oversampleInit(oversampleChannels, sizeof(oversampleChannels));
+	armInit(&armConfig);
+	lineInit(&lineConfig);
+	digitalWrite(6, HIGH);
+	digitalWrite(8, HIGH);
+}
+
+static void bootImes() {
+	printf("initialized %d ime's.\n\n", imeInitializeAll());
+}
+
+static void bootUltrasonic() {
+	ultraFront = ultrasonicInit(11, 10);
+}
+
+//The subsystems need the calibration; the IMEs, ultrasonic and LCD menu start alongside them
+static const BootStage bootStages[] = {
+	{ "calibration", bootCalibration, false },
+	{ "subsystems", bootSubsystems, true },
+	{ "imes", bootImes, false },
+	{ "ultrasonic", bootUltrasonic, false },
+	{ "selector", autonomousInit, false },
+};
+
 /*
 * Runs user initialization code. This function will be started in its own task with the default
 * priority and stack size once when the robot is starting up. It is possible that the VEXnet
@@ -75,10 +191,6 @@ void initializeIO() {
 */
 
 void initialize() {
-	ultraFront = ultrasonicInit(11, 10);
-	imeInitializeAll();
-	digitalWrite(6, HIGH);
-	digitalWrite(8, HIGH);
-	printf("initialized %d ime's.\n\n", imeInitializeAll());
+	bootRun(bootStages, sizeof(bootStages) / sizeof(bootStages[0]));
 }
 
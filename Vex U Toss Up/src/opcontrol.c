@@ -37,27 +37,104 @@
 */
 
 #include "main.h"
-#include "api.h"
 
-#define DRIVE_FL 6 //Left drive 127 is forward
-#define DRIVE_ML 7
-#define DRIVE_MR 8 //right drive -127 is forward
-#define DRIVE_FR 9
+#define led_r 6
+#define led_g 8
+//Longest driver route, the length of the autonomous period
+#define route_time 15000
+//Drive stick shaping: no creep near the centre, finer control at low speed
+#define drive_curve(x) CURVE_EXPO(CURVE_DEADBAND(x, 10), 40)
 
-#define ARM_TL 2 //-127 is up? lolsure
-#define ARM_TR 3 //-127 is up
-#define ARM_BL 4 //-127 is up
-#define ARM_BR 5 //127 is up
-#define arm_idle_speed 8
+static CURVE_TABLE(driveCurve, drive_curve);
 
-#define IN_L 1 //127 should be intake
-#define IN_R 10
+// Pot reading the arm holds when no arm button is pressed
+static int current_pot_val;
+// Presets start on the press, not for as long as the button is held
+static bool preset_up_held, preset_down_held;
+
+/*
+* Sets the arm to hold where it is. Call before the first pass of driverControl().
+*/
+void driverControlInit() {
+	current_pot_val=armGetPos();
+	preset_up_held=false;
+	preset_down_held=false;
+}
+
+/*
+* Runs one pass of the driver controls: drive, arm, intake, arm presets and limit lights. Never
+* waits, so the drive updates on every pass while a preset moves the arm; the arm buttons take
+* over from a preset at once. Reads the joysticks through routeJoystickAnalog() and
+* routeJoystickDigital() so autonomous() can drive a recorded route with it.
+*/
+void driverControl() {
+	int left, right;
+	bool preset;
+
+	//Drive motors, tank config
+	left = curveApply(driveCurve, routeJoystickAnalog(1, 3));
+	right = curveApply(driveCurve, routeJoystickAnalog(1, 2));
+	routeCorrect(&left, &right);
+	driveTank(left, right);
+
+
+	//Arm motors, right trigger buttons
+	if((routeJoystickDigital(1,6,JOY_UP) == 1) && (digitalRead(LIMIT_TOP) == 1)) {
+		armRelease();
+		current_pot_val=armGetPos();
+		//Full speed up to the switch: its interrupt stops the arm
+		motorsArm(127);
+	}
+	else if((routeJoystickDigital(1,6,JOY_DOWN) == 1) && (digitalRead(LIMIT_BOT) == 1))  {
+		armRelease();
+		current_pot_val=armGetPos();
+		motorsArm(-127);
+	}
+	else if(!armMoving()) {//keep arm up; a preset move holds by itself when it arrives
+		armHold(current_pot_val);
+	}
+
+	//Intake motors, left trigger buttons
+	if(routeJoystickDigital(1,5,JOY_UP) == 1) {
+		motorSet(IN_L, 127);
+		motorSet(IN_R, -127);
+	}
+	else if(routeJoystickDigital(1,5,JOY_DOWN) == 1) {
+		motorSet(IN_L, -127);
+		motorSet(IN_R, 127);
+	}
+	else {
+		motorStop(IN_L);
+		motorStop(IN_R);
+	}
+
+
+	//preset arm heights, moved to in the background so the drive and intake keep working
+	preset=routeJoystickDigital(1, 7, JOY_UP);
+	if(preset && !preset_up_held) {
+		current_pot_val=ARM_PRESET_HIGH;
+		armMoveTo(ARM_PRESET_HIGH, 127);
+	}
+	preset_up_held=preset;
+	preset=routeJoystickDigital(1, 7, JOY_DOWN);
+	if(preset && !preset_down_held) {
+		current_pot_val=ARM_PRESET_LOW;
+		armMoveTo(ARM_PRESET_LOW, 127);
+	}
+	preset_down_held=preset;
+
+	//LIGHTS
+	if(digitalRead(LIMIT_TOP)==0)
+		digitalWrite(led_r, LOW);
+	else
+		digitalWrite(led_r, HIGH);
+
+	if(digitalRead(LIMIT_BOT)==0)
+		digitalWrite(led_g, LOW);
+	else
+		digitalWrite(led_g, HIGH);
+}
 
-#define led_r 6
-#define led_g 8
-#define limit_top 3
-#define limit_bot 4
-#define arm_pot 1
 /*
 * Runs the user operator control code. This function will be started in its own task with the
 * default priority and stack size whenever the robot is enabled via the Field Management System
@@ -75,141 +152,48 @@
 *
 * This task should never exit; it should end with some kind of infinite loop, even if empty.
 */
-
-
 void operatorControl() {
-	int current_pot_val=analogRead(arm_pot);
+	//Keep only initialize() and autonomous() in the record log (make RECORD=1)
+	recordStop();
+	driverControlInit();
 
-	if (digitalRead(2)==LOW){ //JUMPER IN DIG2=GO AUTONOMOUs
+	if (lcdReadButtons(uart1) & LCD_BTN_CENTER){ //LCD CENTRE HELD AT START=GO AUTONOMOUS
 		autonomous();
-		digitalWrite(limit_bot, HIGH);
-		digitalWrite(limit_top, HIGH);
+		//Limit lights off
+		digitalWrite(led_g, HIGH);
+		digitalWrite(led_r, HIGH);
 	}
 
 	while (1) {
-		//Drive motors, tank config
-		motorSet(DRIVE_FL, joystickGetAnalog(1,3));
-		motorSet(DRIVE_ML, joystickGetAnalog(1,3));
-		motorSet(DRIVE_FR, -joystickGetAnalog(1,2));
-		motorSet(DRIVE_MR, -joystickGetAnalog(1,2));
-
-
-		//Arm motors, right trigger buttons
-		if((joystickGetDigital(1,6,JOY_UP) == 1) && (digitalRead(limit_top) == 1)) {
-			current_pot_val=analogRead(arm_pot);
-			motorSet(ARM_TL, -127);
-			motorSet(ARM_BL, -127);
-			motorSet(ARM_TR, -127);
-			motorSet(ARM_BR, 127);
-			if(digitalRead(limit_top)==0) {
-				motorStop(ARM_TL);
-				motorStop(ARM_BL);
-				motorStop(ARM_TR);
-				motorStop(ARM_BR);
-			}
-		}
-		else if((joystickGetDigital(1,6,JOY_DOWN) == 1) && (digitalRead(limit_bot) == 1))  {
-			current_pot_val=analogRead(arm_pot);
-			motorSet(ARM_TL, 127);
-			motorSet(ARM_BL, 127);
-			motorSet(ARM_TR, 127);
-			motorSet(ARM_BR, -127);
-			if(digitalRead(limit_bot)==0) {
-				motorStop(ARM_TL);
-				motorStop(ARM_BL);
-				motorStop(ARM_TR);
-				motorStop(ARM_BR);
-			}
-		}
-		else {//keep arm up
-			if(analogRead(arm_pot)<=current_pot_val){
-			//higher than idle
-				motorSet(ARM_TL, arm_idle_speed);
-				motorSet(ARM_BL, arm_idle_speed);
-				motorSet(ARM_TR, arm_idle_speed);
-				motorSet(ARM_BR, -(arm_idle_speed));
-				if((analogRead(arm_pot)==current_pot_val)||(digitalRead(limit_bot)==0)){
-					motorStop(ARM_TL);
-					motorStop(ARM_BL);
-					motorStop(ARM_TR);
-					motorStop(ARM_BR);
-				}
-			}
-			if(analogRead(arm_pot)>=current_pot_val){
-				//lower than idle
-				motorSet(ARM_TL, -(arm_idle_speed));
-				motorSet(ARM_BL, -(arm_idle_speed));
-				motorSet(ARM_TR, -(arm_idle_speed));
-				motorSet(ARM_BR, (arm_idle_speed));
-				if((analogRead(arm_pot)==current_pot_val)||(digitalRead(limit_top)==0)){
-					motorStop(ARM_TL);
-					motorStop(ARM_BL);
-					motorStop(ARM_TR);
-					motorStop(ARM_BR);
-				}
-			}
-		}
+		driverControl();
 
-		//Intake motors, left trigger buttons
-		if(joystickGetDigital(1,5,JOY_UP) == 1) {
-			motorSet(IN_L, 127);
-			motorSet(IN_R, -127);
-		}
-		else if(joystickGetDigital(1,5,JOY_DOWN) == 1) {
-			motorSet(IN_L, -127);
-			motorSet(IN_R, 127);
+		//Print the record log for make replay
+		if(joystickGetDigital(1, 8, JOY_RIGHT) == 1) {
+			recordDump();
+			while(joystickGetDigital(1, 8, JOY_RIGHT) == 1)
+				delay(20);
 		}
-		else {
-			motorStop(IN_L);
-			motorStop(IN_R);
-		}
-
 
-		//preset arm heights
-		if(joystickGetDigital(1, 7,JOY_UP) == 1) {
-			while((analogRead(arm_pot)>2202) && (digitalRead(limit_top) == 1)){
-				current_pot_val=2202;
-				motorSet(ARM_TL, -127);
-				motorSet(ARM_BL, -127);
-				motorSet(ARM_TR, -127);
-				motorSet(ARM_BR, 127);
-				if(digitalRead(limit_top)==0) {
-					motorStop(ARM_TL);
-					motorStop(ARM_BL);
-					motorStop(ARM_TR);
-					motorStop(ARM_BR);
-				}
-			}
-		}
-		if(joystickGetDigital(1, 7,JOY_DOWN) == 1) {
-			while((analogRead(arm_pot)<4040) && (digitalRead(limit_bot) == 1)){
-				current_pot_val=4040;
-				motorSet(ARM_TL, 127);
-				motorSet(ARM_BL, 127);
-				motorSet(ARM_TR, 127);
-				motorSet(ARM_BR, -127);
-				if(digitalRead(limit_bot)==0) {
-					motorStop(ARM_TL);
-					motorStop(ARM_BL);
-					motorStop(ARM_TR);
-					motorStop(ARM_BR);
-				}
-			}
+		//Measure the calibration values: LCD captures from the sensors, or the programming cable
+		if(joystickGetDigital(1, 8, JOY_UP) == 1 || joystickGetDigital(1, 8, JOY_DOWN) == 1) {
+			motorStopAll();
+			if(joystickGetDigital(1, 8, JOY_UP) == 1)
+				calibLcd(uart1, 10000);
+			else
+				calibSerial();
+			while(joystickGetDigital(1, 8, JOY_UP) == 1 || joystickGetDigital(1, 8, JOY_DOWN) == 1)
+				delay(20);
+			driverControlInit();
 		}
-		//LIGHTS
-		if(digitalRead(limit_top)==0)
-			digitalWrite(led_r, LOW);
-		else
-			digitalWrite(led_r, HIGH);
 
-		if(digitalRead(limit_bot)==0)
-			digitalWrite(led_g, LOW);
-		else
-			digitalWrite(led_g, HIGH);
-
-	}
-
-
-		printf("%d\r\n", current_pot_val);
+		//Record a driver route for autonomous, or stop and save it
+		if(joystickGetDigital(1, 8, JOY_LEFT) == 1) {
+			while(joystickGetDigital(1, 8, JOY_LEFT) == 1)
+				delay(20);
+			if(routeRecording())
+				routeRecordStop();
+			else
+				routeRecordStart(route_time);
+		}
 	}
-
+}
@@ -0,0 +1,473 @@
+/** @file ramCurve.c
+ * @brief Trajectory ramCurve, written by tools/trajgen from paths/ramCurve.path; do not edit
+ *
+ * 69.4 inches backwards in 4.60 s, 461 entries every 10 ms (5532 bytes of flash)
+ */
+
+#include "main.h"
+
+static const TrajectoryPoint ramCurvePoints[461] = {
+	{ 0, 0, 0, 0 },
+	{ 0, 0, -24, -24 },
+	{ 0, 0, -47, -47 },
+	{ -1, -1, -71, -71 },
+	{ -2, -2, -95, -95 },
+	{ -3, -3, -118, -118 },
+	{ -4, -4, -142, -142 },
+	{ -6, -6, -166, -166 },
+	{ -8, -8, -189, -189 },
+	{ -10, -10, -213, -213 },
+	{ -12, -12, -237, -237 },
+	{ -14, -14, -261, -261 },
+	{ -17, -17, -284, -284 },
+	{ -20, -20, -308, -308 },
+	{ -23, -23, -332, -332 },
+	{ -27, -27, -355, -355 },
+	{ -30, -30, -379, -379 },
+	{ -34, -34, -403, -403 },
+	{ -38, -38, -426, -426 },
+	{ -43, -43, -450, -450 },
+	{ -47, -47, -474, -474 },
+	{ -52, -52, -497, -497 },
+	{ -57, -57, -521, -521 },
+	{ -63, -63, -545, -545 },
+	{ -68, -68, -568, -568 },
+	{ -74, -74, -592, -592 },
+	{ -80, -80, -616, -616 },
+	{ -86, -86, -639, -639 },
+	{ -93, -93, -663, -663 },
+	{ -100, -100, -687, -687 },
+	{ -107, -107, -710, -710 },
+	{ -114, -114, -734, -734 },
+	{ -121, -121, -758, -758 },
+	{ -129, -129, -782, -782 },
+	{ -137, -137, -805, -805 },
+	{ -145, -145, -829, -829 },
+	{ -153, -153, -853, -853 },
+	{ -162, -162, -876, -876 },
+	{ -171, -171, -888, -888 },
+	{ -180, -180, -888, -888 },
+	{ -189, -189, -888, -888 },
+	{ -198, -198, -888, -888 },
+	{ -206, -206, -888, -888 },
+	{ -215, -215, -888, -888 },
+	{ -224, -224, -888, -888 },
+	{ -233, -233, -888, -888 },
+	{ -242, -242, -888, -888 },
+	{ -251, -251, -888, -888 },
+	{ -260, -260, -888, -888 },
+	{ -269, -269, -888, -888 },
+	{ -278, -278, -888, -888 },
+	{ -286, -286, -888, -888 },
+	{ -295, -295, -888, -888 },
+	{ -304, -304, -888, -888 },
+	{ -313, -313, -888, -888 },
+	{ -322, -322, -888, -888 },
+	{ -331, -331, -888, -888 },
+	{ -340, -340, -888, -888 },
+	{ -349, -349, -888, -888 },
+	{ -357, -357, -888, -888 },
+	{ -366, -366, -888, -888 },
+	{ -375, -375, -881, -881 },
+	{ -384, -384, -858, -858 },
+	{ -392, -392, -834, -834 },
+	{ -401, -401, -810, -810 },
+	{ -409, -409, -787, -787 },
+	{ -416, -416, -763, -763 },
+	{ -424, -424, -739, -739 },
+	{ -431, -431, -715, -715 },
+	{ -438, -438, -692, -692 },
+	{ -445, -445, -668, -668 },
+	{ -452, -452, -644, -644 },
+	{ -458, -458, -621, -621 },
+	{ -464, -464, -597, -597 },
+	{ -470, -470, -573, -573 },
+	{ -475, -475, -550, -550 },
+	{ -481, -481, -526, -526 },
+	{ -486, -486, -502, -502 },
+	{ -491, -491, -479, -479 },
+	{ -494, -497, -40, -888 },
+	{ -494, -506, -50, -888 },
+	{ -495, -515, -59, -888 },
+	{ -495, -524, -69, -888 },
+	{ -496, -533, -79, -888 },
+	{ -497, -542, -89, -888 },
+	{ -498, -551, -99, -888 },
+	{ -499, -560, -109, -888 },
+	{ -500, -568, -120, -888 },
+	{ -501, -577, -130, -888 },
+	{ -503, -586, -141, -888 },
+	{ -504, -595, -151, -888 },
+	{ -506, -604, -162, -888 },
+	{ -507, -613, -173, -888 },
+	{ -509, -622, -183, -888 },
+	{ -511, -631, -194, -888 },
+	{ -513, -639, -205, -888 },
+	{ -515, -648, -216, -888 },
+	{ -517, -657, -227, -888 },
+	{ -520, -666, -238, -888 },
+	{ -522, -675, -248, -888 },
+	{ -525, -684, -259, -888 },
+	{ -527, -693, -270, -888 },
+	{ -530, -702, -281, -888 },
+	{ -533, -710, -291, -888 },
+	{ -536, -719, -302, -888 },
+	{ -539, -728, -313, -888 },
+	{ -542, -737, -323, -888 },
+	{ -545, -746, -333, -888 },
+	{ -549, -755, -344, -888 },
+	{ -552, -764, -354, -888 },
+	{ -556, -773, -364, -888 },
+	{ -560, -781, -374, -888 },
+	{ -563, -790, -384, -888 },
+	{ -567, -799, -394, -888 },
+	{ -571, -808, -404, -888 },
+	{ -575, -817, -414, -888 },
+	{ -580, -826, -423, -888 },
+	{ -584, -835, -433, -888 },
+	{ -588, -844, -442, -888 },
+	{ -593, -852, -451, -888 },
+	{ -597, -861, -460, -888 },
+	{ -602, -870, -469, -888 },
+	{ -607, -879, -478, -888 },
+	{ -611, -888, -486, -888 },
+	{ -616, -897, -495, -888 },
+	{ -621, -906, -503, -888 },
+	{ -626, -915, -512, -888 },
+	{ -632, -923, -520, -888 },
+	{ -637, -932, -528, -888 },
+	{ -642, -941, -536, -888 },
+	{ -648, -950, -543, -888 },
+	{ -653, -959, -551, -888 },
+	{ -659, -968, -558, -888 },
+	{ -664, -977, -566, -888 },
+	{ -670, -986, -573, -888 },
+	{ -676, -995, -580, -888 },
+	{ -681, -1003, -587, -888 },
+	{ -687, -1012, -594, -888 },
+	{ -693, -1021, -600, -888 },
+	{ -699, -1030, -607, -888 },
+	{ -706, -1039, -614, -888 },
+	{ -712, -1048, -620, -888 },
+	{ -718, -1057, -626, -888 },
+	{ -724, -1066, -632, -888 },
+	{ -731, -1074, -638, -888 },
+	{ -737, -1083, -644, -888 },
+	{ -743, -1092, -650, -888 },
+	{ -750, -1101, -656, -888 },
+	{ -757, -1110, -662, -888 },
+	{ -763, -1119, -667, -888 },
+	{ -770, -1128, -672, -888 },
+	{ -777, -1137, -678, -888 },
+	{ -783, -1145, -683, -888 },
+	{ -790, -1154, -688, -888 },
+	{ -797, -1163, -693, -888 },
+	{ -804, -1172, -698, -888 },
+	{ -811, -1181, -703, -888 },
+	{ -818, -1190, -708, -888 },
+	{ -825, -1199, -713, -888 },
+	{ -833, -1208, -717, -888 },
+	{ -840, -1217, -722, -888 },
+	{ -847, -1225, -727, -888 },
+	{ -854, -1234, -731, -888 },
+	{ -862, -1243, -735, -888 },
+	{ -869, -1252, -740, -888 },
+	{ -876, -1261, -744, -888 },
+	{ -884, -1270, -748, -888 },
+	{ -891, -1279, -752, -888 },
+	{ -899, -1288, -756, -888 },
+	{ -906, -1296, -760, -888 },
+	{ -914, -1305, -764, -888 },
+	{ -922, -1314, -768, -888 },
+	{ -929, -1323, -772, -888 },
+	{ -937, -1332, -776, -888 },
+	{ -945, -1341, -780, -888 },
+	{ -953, -1350, -784, -888 },
+	{ -961, -1359, -787, -888 },
+	{ -969, -1367, -791, -888 },
+	{ -976, -1376, -795, -888 },
+	{ -984, -1385, -798, -888 },
+	{ -992, -1394, -802, -888 },
+	{ -1000, -1403, -805, -888 },
+	{ -1009, -1412, -809, -888 },
+	{ -1017, -1421, -812, -888 },
+	{ -1025, -1430, -816, -888 },
+	{ -1033, -1439, -819, -888 },
+	{ -1041, -1447, -822, -888 },
+	{ -1049, -1456, -826, -888 },
+	{ -1058, -1465, -829, -888 },
+	{ -1066, -1474, -832, -888 },
+	{ -1074, -1483, -836, -888 },
+	{ -1083, -1492, -839, -888 },
+	{ -1091, -1501, -842, -888 },
+	{ -1100, -1510, -846, -888 },
+	{ -1108, -1518, -849, -888 },
+	{ -1117, -1527, -852, -888 },
+	{ -1125, -1536, -855, -888 },
+	{ -1134, -1545, -859, -888 },
+	{ -1142, -1554, -862, -888 },
+	{ -1151, -1563, -865, -888 },
+	{ -1160, -1572, -868, -888 },
+	{ -1168, -1581, -871, -888 },
+	{ -1177, -1589, -875, -888 },
+	{ -1186, -1598, -878, -888 },
+	{ -1195, -1607, -881, -888 },
+	{ -1203, -1616, -884, -888 },
+	{ -1212, -1625, -888, -888 },
+	{ -1221, -1634, -888, -885 },
+	{ -1230, -1643, -888, -882 },
+	{ -1239, -1651, -888, -879 },
+	{ -1248, -1660, -888, -876 },
+	{ -1257, -1669, -888, -872 },
+	{ -1266, -1678, -888, -869 },
+	{ -1274, -1686, -888, -866 },
+	{ -1283, -1695, -888, -863 },
+	{ -1292, -1704, -888, -860 },
+	{ -1301, -1712, -888, -857 },
+	{ -1310, -1721, -888, -853 },
+	{ -1319, -1729, -888, -850 },
+	{ -1328, -1738, -888, -847 },
+	{ -1337, -1746, -888, -844 },
+	{ -1345, -1755, -888, -841 },
+	{ -1354, -1763, -888, -838 },
+	{ -1363, -1771, -888, -834 },
+	{ -1372, -1780, -888, -831 },
+	{ -1381, -1788, -888, -828 },
+	{ -1390, -1796, -888, -825 },
+	{ -1399, -1805, -888, -822 },
+	{ -1408, -1813, -888, -818 },
+	{ -1417, -1821, -888, -815 },
+	{ -1425, -1829, -888, -812 },
+	{ -1434, -1837, -888, -809 },
+	{ -1443, -1845, -888, -805 },
+	{ -1452, -1853, -888, -802 },
+	{ -1461, -1861, -888, -799 },
+	{ -1470, -1869, -888, -795 },
+	{ -1479, -1877, -888, -792 },
+	{ -1488, -1885, -888, -788 },
+	{ -1496, -1893, -888, -785 },
+	{ -1505, -1901, -888, -781 },
+	{ -1514, -1909, -888, -778 },
+	{ -1523, -1916, -888, -774 },
+	{ -1532, -1924, -888, -771 },
+	{ -1541, -1932, -888, -767 },
+	{ -1550, -1939, -888, -763 },
+	{ -1559, -1947, -888, -760 },
+	{ -1568, -1955, -888, -756 },
+	{ -1576, -1962, -888, -752 },
+	{ -1585, -1970, -888, -748 },
+	{ -1594, -1977, -888, -744 },
+	{ -1603, -1984, -888, -740 },
+	{ -1612, -1992, -888, -736 },
+	{ -1621, -1999, -888, -732 },
+	{ -1630, -2006, -888, -728 },
+	{ -1639, -2014, -888, -724 },
+	{ -1647, -2021, -888, -720 },
+	{ -1656, -2028, -888, -715 },
+	{ -1665, -2035, -888, -711 },
+	{ -1674, -2042, -888, -707 },
+	{ -1683, -2049, -888, -702 },
+	{ -1692, -2056, -888, -698 },
+	{ -1701, -2063, -888, -693 },
+	{ -1710, -2070, -888, -688 },
+	{ -1719, -2077, -888, -683 },
+	{ -1727, -2084, -888, -679 },
+	{ -1736, -2091, -888, -674 },
+	{ -1745, -2097, -888, -669 },
+	{ -1754, -2104, -888, -664 },
+	{ -1763, -2111, -888, -658 },
+	{ -1772, -2117, -888, -653 },
+	{ -1781, -2124, -888, -648 },
+	{ -1790, -2130, -888, -642 },
+	{ -1798, -2137, -888, -637 },
+	{ -1807, -2143, -888, -631 },
+	{ -1816, -2149, -888, -626 },
+	{ -1825, -2155, -888, -620 },
+	{ -1834, -2162, -888, -614 },
+	{ -1843, -2168, -888, -608 },
+	{ -1852, -2174, -888, -602 },
+	{ -1861, -2180, -888, -596 },
+	{ -1870, -2186, -888, -590 },
+	{ -1878, -2192, -888, -583 },
+	{ -1887, -2197, -888, -577 },
+	{ -1896, -2203, -888, -570 },
+	{ -1904, -2210, -780, -724 },
+	{ -1912, -2218, -804, -747 },
+	{ -1920, -2225, -829, -770 },
+	{ -1928, -2233, -853, -793 },
+	{ -1937, -2241, -877, -816 },
+	{ -1946, -2249, -888, -827 },
+	{ -1955, -2257, -888, -827 },
+	{ -1964, -2266, -888, -827 },
+	{ -1973, -2274, -888, -827 },
+	{ -1981, -2282, -888, -828 },
+	{ -1990, -2291, -888, -828 },
+	{ -1999, -2299, -888, -828 },
+	{ -2008, -2307, -888, -829 },
+	{ -2017, -2315, -888, -829 },
+	{ -2026, -2324, -888, -829 },
+	{ -2035, -2332, -888, -829 },
+	{ -2044, -2340, -888, -830 },
+	{ -2052, -2349, -888, -830 },
+	{ -2061, -2357, -888, -830 },
+	{ -2070, -2365, -888, -831 },
+	{ -2079, -2374, -888, -831 },
+	{ -2088, -2382, -888, -831 },
+	{ -2097, -2390, -888, -832 },
+	{ -2106, -2398, -888, -832 },
+	{ -2115, -2407, -888, -832 },
+	{ -2124, -2415, -888, -833 },
+	{ -2132, -2423, -888, -833 },
+	{ -2141, -2432, -888, -833 },
+	{ -2150, -2440, -888, -834 },
+	{ -2159, -2448, -888, -834 },
+	{ -2168, -2457, -888, -834 },
+	{ -2177, -2465, -888, -835 },
+	{ -2186, -2473, -888, -835 },
+	{ -2195, -2482, -888, -835 },
+	{ -2203, -2490, -888, -836 },
+	{ -2212, -2499, -888, -836 },
+	{ -2221, -2507, -888, -836 },
+	{ -2230, -2515, -888, -837 },
+	{ -2239, -2524, -888, -837 },
+	{ -2248, -2532, -888, -837 },
+	{ -2257, -2540, -888, -838 },
+	{ -2266, -2549, -888, -838 },
+	{ -2274, -2557, -888, -838 },
+	{ -2283, -2566, -888, -839 },
+	{ -2292, -2574, -888, -839 },
+	{ -2301, -2582, -888, -839 },
+	{ -2310, -2591, -888, -840 },
+	{ -2319, -2599, -888, -840 },
+	{ -2328, -2608, -888, -841 },
+	{ -2337, -2616, -888, -841 },
+	{ -2346, -2624, -888, -841 },
+	{ -2354, -2633, -888, -842 },
+	{ -2363, -2641, -888, -842 },
+	{ -2372, -2650, -888, -842 },
+	{ -2381, -2658, -888, -843 },
+	{ -2390, -2666, -888, -843 },
+	{ -2399, -2675, -888, -843 },
+	{ -2408, -2683, -888, -844 },
+	{ -2417, -2692, -888, -844 },
+	{ -2425, -2700, -888, -845 },
+	{ -2434, -2709, -888, -845 },
+	{ -2443, -2717, -888, -845 },
+	{ -2452, -2726, -888, -846 },
+	{ -2461, -2734, -888, -846 },
+	{ -2470, -2742, -888, -847 },
+	{ -2479, -2751, -888, -847 },
+	{ -2488, -2759, -888, -847 },
+	{ -2497, -2768, -888, -848 },
+	{ -2505, -2776, -888, -848 },
+	{ -2514, -2785, -888, -849 },
+	{ -2523, -2793, -888, -849 },
+	{ -2532, -2802, -888, -849 },
+	{ -2541, -2810, -888, -850 },
+	{ -2550, -2819, -888, -850 },
+	{ -2559, -2827, -888, -851 },
+	{ -2568, -2836, -888, -851 },
+	{ -2576, -2844, -888, -851 },
+	{ -2585, -2853, -888, -852 },
+	{ -2594, -2861, -888, -852 },
+	{ -2603, -2870, -888, -853 },
+	{ -2612, -2878, -888, -853 },
+	{ -2621, -2887, -888, -853 },
+	{ -2630, -2895, -888, -854 },
+	{ -2639, -2904, -888, -854 },
+	{ -2648, -2913, -888, -855 },
+	{ -2656, -2921, -888, -855 },
+	{ -2665, -2930, -888, -855 },
+	{ -2674, -2938, -888, -856 },
+	{ -2683, -2947, -888, -856 },
+	{ -2692, -2955, -888, -857 },
+	{ -2701, -2964, -888, -857 },
+	{ -2710, -2973, -888, -858 },
+	{ -2719, -2981, -888, -858 },
+	{ -2727, -2990, -888, -858 },
+	{ -2736, -2998, -888, -859 },
+	{ -2745, -3007, -888, -859 },
+	{ -2754, -3015, -888, -860 },
+	{ -2763, -3024, -888, -860 },
+	{ -2772, -3033, -888, -861 },
+	{ -2781, -3041, -888, -861 },
+	{ -2790, -3050, -888, -861 },
+	{ -2798, -3058, -888, -862 },
+	{ -2807, -3067, -888, -862 },
+	{ -2816, -3076, -888, -863 },
+	{ -2825, -3084, -888, -863 },
+	{ -2834, -3093, -888, -864 },
+	{ -2843, -3102, -888, -864 },
+	{ -2852, -3110, -888, -865 },
+	{ -2861, -3119, -888, -865 },
+	{ -2870, -3128, -888, -865 },
+	{ -2878, -3136, -888, -866 },
+	{ -2887, -3145, -888, -866 },
+	{ -2896, -3154, -888, -867 },
+	{ -2905, -3162, -888, -867 },
+	{ -2914, -3171, -888, -868 },
+	{ -2923, -3180, -888, -868 },
+	{ -2932, -3188, -888, -869 },
+	{ -2941, -3197, -888, -869 },
+	{ -2949, -3206, -888, -870 },
+	{ -2958, -3214, -888, -870 },
+	{ -2967, -3223, -888, -870 },
+	{ -2976, -3232, -888, -871 },
+	{ -2985, -3240, -888, -871 },
+	{ -2994, -3249, -888, -872 },
+	{ -3003, -3258, -888, -872 },
+	{ -3012, -3267, -888, -873 },
+	{ -3021, -3275, -888, -873 },
+	{ -3029, -3284, -888, -874 },
+	{ -3038, -3293, -888, -874 },
+	{ -3047, -3302, -888, -875 },
+	{ -3056, -3310, -888, -875 },
+	{ -3065, -3319, -888, -876 },
+	{ -3074, -3328, -888, -876 },
+	{ -3083, -3337, -888, -877 },
+	{ -3092, -3345, -888, -877 },
+	{ -3100, -3354, -888, -877 },
+	{ -3109, -3363, -888, -878 },
+	{ -3118, -3372, -888, -878 },
+	{ -3127, -3380, -888, -879 },
+	{ -3136, -3389, -880, -872 },
+	{ -3145, -3398, -856, -848 },
+	{ -3153, -3406, -832, -825 },
+	{ -3161, -3414, -808, -801 },
+	{ -3169, -3422, -784, -778 },
+	{ -3177, -3430, -760, -755 },
+	{ -3184, -3437, -736, -731 },
+	{ -3192, -3445, -712, -708 },
+	{ -3199, -3452, -688, -684 },
+	{ -3205, -3458, -665, -661 },
+	{ -3212, -3465, -641, -637 },
+	{ -3218, -3471, -617, -614 },
+	{ -3224, -3477, -593, -590 },
+	{ -3230, -3483, -569, -567 },
+	{ -3236, -3488, -545, -543 },
+	{ -3241, -3494, -522, -520 },
+	{ -3246, -3499, -498, -496 },
+	{ -3251, -3504, -474, -473 },
+	{ -3256, -3508, -450, -449 },
+	{ -3260, -3513, -426, -425 },
+	{ -3264, -3517, -403, -402 },
+	{ -3268, -3521, -379, -378 },
+	{ -3272, -3524, -355, -355 },
+	{ -3275, -3528, -331, -331 },
+	{ -3278, -3531, -308, -307 },
+	{ -3281, -3534, -284, -284 },
+	{ -3284, -3537, -260, -260 },
+	{ -3287, -3539, -237, -236 },
+	{ -3289, -3541, -213, -213 },
+	{ -3291, -3543, -189, -189 },
+	{ -3293, -3545, -165, -165 },
+	{ -3294, -3547, -142, -142 },
+	{ -3295, -3548, -118, -118 },
+	{ -3296, -3549, -94, -94 },
+	{ -3297, -3550, -71, -71 },
+	{ -3298, -3550, -47, -47 },
+	{ -3298, -3551, -23, -23 },
+	{ -3298, -3551, 0, 0 },
+};
+
+const Trajectory ramCurve = { ramCurvePoints, 461, 10 };
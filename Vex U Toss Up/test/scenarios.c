@@ -0,0 +1,1007 @@
+/** @file scenarios.c
+ * @brief Simulated scenarios for the Toss Up drive and arm routines
+ *
+ * The model: each drive side counts 1000 IME ticks per second at full power, and its encoder
+ * the same distance in encoder ticks, whichever drive.c reads; the arm pot
+ * moves 1500 per second at full power (lower is higher) and trips the top limit switch
+ * above ARM_LIMIT_POS.
+ */
+
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+// Pot reading above which the arm presses the top limit switch
+#define ARM_LIMIT_POS 2100
+// Distance from the start to the near edge of the line, in IME counts
+#define LINE_AT 500
+// Width of the line in IME counts (2 in of tape on a 4 in wheel)
+#define LINE_WIDTH 100
+
+// Extra distance the right sensor has to go before it reaches the line
+static int lineSkew;
+
+static void armLimits(void) {
+	simSetDigital(LIMIT_TOP, simGetAnalog(ARM_POT) >= ARM_LIMIT_POS);
+}
+
+// Gravity on the arm, a little stronger than init.c expects, heaviest half way up
+static void armGravityLoad(void) {
+	int pos = simGetAnalog(ARM_POT);
+
+	armLimits();
+	simSetAnalogLoad(ARM_POT, -(10 + 12 * (1000 - abs(pos - 3000)) / 1000));
+}
+
+// Links the IMEs and encoders to the drive, rate IME counts per second at full power
+static void driveSensors(int rate) {
+	int encRate = rate * DRIVE_ENCODER_COUNTS_PER_REV / DRIVE_COUNTS_PER_REV;
+
+	//Left side counts down going forwards; right motors are wired reversed
+	simLinkIme(IME_LEFT, DRIVE_FL, rate);
+	simLinkIme(IME_RIGHT, DRIVE_FR, rate);
+	simLinkEncoder(ENC_LEFT_TOP, DRIVE_FL, encRate);
+	simLinkEncoder(ENC_RIGHT_TOP, DRIVE_FR, encRate);
+}
+
+// Sets up the Toss Up with the arm at the bottom, as at the start of a match
+static void tossUp(void) {
+	driveSensors(-1000);
+	simLinkAnalog(ARM_POT, ARM_BR, -1500, 1000, 4095);
+	simSetAnalog(ARM_POT, ARM_POS_BOT);
+	simSetAnalog(LINESENSE_L, 3000);
+	simSetAnalog(LINESENSE_R, 3000);
+	simSetStep(armLimits);
+	initialize();
+}
+
+static bool driveStopped(void) {
+	return simGetMotor(DRIVE_FL) == 0 && simGetMotor(DRIVE_ML) == 0 &&
+		simGetMotor(DRIVE_FR) == 0 && simGetMotor(DRIVE_MR) == 0;
+}
+
+static void driveStraightForwards(void) {
+	int countL, countR;
+
+	tossUp();
+	driveStraight(DRIVE_COUNTS_PER_REV, 60);
+	driveGetCounts(&countL, &countR);
+	SIM_CHECK((countL + countR) / 2 >= DRIVE_COUNTS_PER_REV);
+	SIM_CHECK((countL + countR) / 2 < DRIVE_COUNTS_PER_REV + 40);
+	SIM_CHECK(abs(countL - countR) < 20);
+	SIM_CHECK(driveStopped());
+}
+
+static void driveStraightBackwards(void) {
+	int countL, countR;
+
+	tossUp();
+	driveStraight(-300, 60);
+	driveGetCounts(&countL, &countR);
+	SIM_CHECK((countL + countR) / 2 <= -300);
+	SIM_CHECK(driveStopped());
+}
+
+static void driveTurnLeft(void) {
+	int countL, countR;
+
+	tossUp();
+	driveTurn(90, 60, LOW);
+	driveGetCounts(&countL, &countR);
+	SIM_CHECK(countR >= 225);
+	SIM_CHECK(countL < 0);
+}
+
+// Reading of a line sensor that has travelled dist from the start towards a line at lineAt
+static int lineReading(int dist, int lineAt) {
+	return (dist >= lineAt && dist < lineAt + LINE_WIDTH) ? 200 : 3000;
+}
+
+// Whether each line sensor has passed over its line
+static bool lineReachedL, lineReachedR;
+
+static void lines(void) {
+	armLimits();
+	simSetAnalog(LINESENSE_L, lineReading(-simGetIme(IME_LEFT), LINE_AT));
+	simSetAnalog(LINESENSE_R, lineReading(simGetIme(IME_RIGHT), LINE_AT + lineSkew));
+	lineReachedL |= lineSeen(simGetAnalog(LINESENSE_L));
+	lineReachedR |= lineSeen(simGetAnalog(LINESENSE_R));
+}
+
+static void driveToLineSquare(void) {
+	tossUp();
+	lineSkew = 0;
+	lineReachedL = lineReachedR = false;
+	simSetStep(lines);
+	driveToLine(true);
+	SIM_CHECK(lineReachedL && lineReachedR);
+	//driveBrake() may back off the tape a little, but not far
+	SIM_CHECK(abs(-simGetIme(IME_LEFT) - LINE_AT) < 80);
+	SIM_CHECK(abs(simGetIme(IME_RIGHT) - LINE_AT) < 80);
+	SIM_CHECK(driveStopped());
+}
+
+static void driveToLineSkewed(void) {
+	tossUp();
+	//Much more skew and the leading sensor coasts off the tape before the lagging one
+	//arrives; driveToLine() has no recovery for that yet
+	lineSkew = 30;
+	lineReachedL = lineReachedR = false;
+	simSetStep(lines);
+	driveToLine(true);
+	//The lagging side is pulled up to the line
+	SIM_CHECK(lineReachedL && lineReachedR);
+	SIM_CHECK(abs(simGetIme(IME_RIGHT) - (LINE_AT + lineSkew)) < 80);
+	SIM_CHECK(driveStopped());
+}
+
+static void armToMid(void) {
+	tossUp();
+	armTo(ARM_POS_MID, 127);
+	SIM_CHECK(abs(armGetPos() - ARM_POS_MID) < 60);
+	//The hold pulls the overshoot back
+	delay(1000);
+	SIM_CHECK(abs(armGetPos() - ARM_POS_MID) < 15);
+}
+
+static void armHoldsAgainstGravity(void) {
+	int pos, low = 4095, high = 0;
+
+	tossUp();
+	simSetStep(armGravityLoad);
+	armTo(ARM_POS_MID, 127);
+	delay(1500);
+	//Settled: stays put from here on
+	while (simMicros() < 4500000ULL) {
+		pos = simGetAnalog(ARM_POT);
+		low = pos < low ? pos : low;
+		high = pos > high ? pos : high;
+		delay(10);
+	}
+	SIM_CHECK(abs(low - ARM_POS_MID) < 10 && abs(high - ARM_POS_MID) < 10);
+}
+
+static void armIdleSags(void) {
+	tossUp();
+	simSetStep(armGravityLoad);
+	armTo(ARM_POS_MID, 127);
+	//What the hold replaced: idle speed alone lets the arm fall
+	stopArm();
+	delay(2000);
+	SIM_CHECK(armGetPos() > ARM_POS_MID + 100);
+}
+
+static void armToTopStopsAtLimit(void) {
+	tossUp();
+	armTo(ARM_POS_TOP, 127);
+	SIM_CHECK(armAtTop());
+	SIM_CHECK(armGetPos() > ARM_POS_TOP);
+}
+
+static void armLimitStopsBlindDrive(void) {
+	tossUp();
+	SIM_CHECK(armFault() == 0);
+	//Full power up, then busy elsewhere without looking at the switch
+	motorsArm(127);
+	delay(1500);
+	SIM_CHECK(armFault() == ARM_FAULT_TOP);
+	SIM_CHECK(simGetMotor(ARM_BR) == 0);
+	//It coasts on a little after the stop, rather than driving on to the end of its travel
+	SIM_CHECK(armGetPos() > ARM_LIMIT_POS - 150);
+	//Latched: up is refused until the switch opens
+	motorsArm(127);
+	SIM_CHECK(simGetMotor(ARM_BR) <= 14);
+	armClearFault();
+	SIM_CHECK(armFault() == ARM_FAULT_TOP);
+	motorsArm(-60);
+	delay(500);
+	SIM_CHECK(armFault() == 0);
+	motorsArm(127);
+	SIM_CHECK(simGetMotor(ARM_BR) == 127);
+	stopArm();
+}
+
+static void armToBottom(void) {
+	tossUp();
+	simSetAnalog(ARM_POT, ARM_POS_MID);
+	armTo(ARM_POS_BOT, 60);
+	SIM_CHECK(armGetPos() >= ARM_POS_BOT - 20);
+}
+
+static void driveSticksShaped(void) {
+	tossUp();
+	driverControlInit();
+	//Inside the deadband
+	simSetJoystickAnalog(1, 3, 8);
+	simSetJoystickAnalog(1, 2, -8);
+	driverControl();
+	SIM_CHECK(driveStopped());
+	//Full stick is still full speed; half stick is slower than linear
+	simSetJoystickAnalog(1, 3, 127);
+	simSetJoystickAnalog(1, 2, 64);
+	driverControl();
+	SIM_CHECK(simGetMotor(DRIVE_FL) == 127);
+	SIM_CHECK(simGetMotor(DRIVE_FR) < 0 && simGetMotor(DRIVE_FR) > -64);
+}
+
+static void driverTask(void *ignore) {
+	driverControlInit();
+	while (1) {
+		driverControl();
+		delay(5);
+	}
+}
+
+// Drives forwards, curves right and stops with the left stick, then waits for the robot to settle
+static void driveByJoystick(void) {
+	simSetJoystickAnalog(1, 3, 80);
+	simSetJoystickAnalog(1, 2, 80);
+	delay(1000);
+	simSetJoystickAnalog(1, 2, 20);
+	delay(500);
+	simSetJoystickAnalog(1, 3, 0);
+	simSetJoystickAnalog(1, 2, 0);
+	delay(500);
+}
+
+// Records driveByJoystick() as a route and gets how far each side went
+static void recordRoute(int *travelL, int *travelR) {
+	TaskHandle driver;
+	int startL, startR;
+
+	driver = taskCreate(driverTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	SIM_CHECK(routeRecordStart(0));
+	//Nothing is recorded before the first movement
+	delay(200);
+	driveGetCounts(&startL, &startR);
+	driveByJoystick();
+	routeRecordStop();
+	taskDelete(driver);
+	driveGetCounts(travelL, travelR);
+	*travelL -= startL;
+	*travelR -= startR;
+}
+
+// Plays the saved route the way autonomous() does and gets how far each side went
+static void playRoute(bool correct, int *travelL, int *travelR) {
+	int startL, startR;
+
+	driveGetCounts(&startL, &startR);
+	driverControlInit();
+	SIM_CHECK(routePlay(correct));
+	while (routePlaying()) {
+		driverControl();
+		delay(5);
+	}
+	driveStop();
+	delay(500);
+	driveGetCounts(travelL, travelR);
+	*travelL -= startL;
+	*travelR -= startR;
+}
+
+static void armPresetKeepsDriving(void) {
+	TaskHandle driver;
+	int countL, countR;
+
+	tossUp();
+	driver = taskCreate(driverTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	simSetJoystickDigital(1, 7, JOY_UP);
+	simSetJoystickAnalog(1, 3, 127);
+	simSetJoystickAnalog(1, 2, 127);
+	delay(100);
+	simSetJoystickDigital(1, 7, 0);
+	SIM_CHECK(armMoving());
+	//The drive follows the sticks while the arm is still on its way up
+	delay(400);
+	simSetJoystickAnalog(1, 3, 0);
+	simSetJoystickAnalog(1, 2, 0);
+	delay(100);
+	SIM_CHECK(armMoving());
+	SIM_CHECK(driveStopped());
+	driveGetCounts(&countL, &countR);
+	SIM_CHECK(countL > 300 && countR > 300);
+	delay(1500);
+	taskDelete(driver);
+	SIM_CHECK(!armMoving());
+	SIM_CHECK(abs(armGetPos() - 2202) < 20);
+}
+
+static void armButtonCancelsPreset(void) {
+	TaskHandle driver;
+	int pos;
+
+	tossUp();
+	driver = taskCreate(driverTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	simSetJoystickDigital(1, 7, JOY_UP);
+	delay(100);
+	simSetJoystickDigital(1, 7, 0);
+	delay(300);
+	//Arm down takes over from the preset at once
+	simSetJoystickDigital(1, 6, JOY_DOWN);
+	delay(20);
+	SIM_CHECK(!armMoving());
+	pos = armGetPos();
+	delay(200);
+	SIM_CHECK(armGetPos() > pos);
+	simSetJoystickDigital(1, 6, 0);
+	delay(500);
+	taskDelete(driver);
+	SIM_CHECK(armGetPos() > 2202 + 200);
+}
+
+static void routeReplaysDriving(void) {
+	int recordL, recordR, playL, playR;
+
+	tossUp();
+	recordRoute(&recordL, &recordR);
+	//Recording starts at the first movement
+	SIM_CHECK(routeLength() >= 1500 && routeLength() <= 2000);
+	SIM_CHECK(recordL > recordR + 150);
+	playRoute(false, &playL, &playR);
+	SIM_CHECK(abs(playL - recordL) < 30);
+	SIM_CHECK(abs(playR - recordR) < 30);
+}
+
+static void routeCorrectsWeakDrive(void) {
+	int recordL, recordR, playL, playR, correctL, correctR;
+
+	tossUp();
+	recordRoute(&recordL, &recordR);
+	//Flat battery: the drive only makes 70% of the speed it had
+	driveSensors(-700);
+	playRoute(false, &playL, &playR);
+	playRoute(true, &correctL, &correctR);
+	SIM_CHECK(abs(correctL - recordL) < abs(playL - recordL) / 2);
+	SIM_CHECK(abs(correctR - recordR) < abs(playR - recordR) / 2);
+}
+
+static void driveFeedbackAgrees(void) {
+	int countL, countR, velL, velR;
+
+	tossUp();
+	driveTank(127, 64);
+	delay(1000);
+	driveGetVelocity(&velL, &velR);
+	driveGetCounts(&countL, &countR);
+	//Encoders count in coarser steps than the IMEs
+	SIM_CHECK(abs(countL + simGetIme(IME_LEFT)) < 5);
+	SIM_CHECK(abs(countR - simGetIme(IME_RIGHT)) < 5);
+	SIM_CHECK(velL > 940 && velL < 1060);
+	SIM_CHECK(velR > 440 && velR < 560);
+	driveStop();
+}
+
+static void driveBenchReads(void) {
+	DriveBenchResult ime, encoder;
+
+	tossUp();
+	//The oversampling task's reads would land inside the timed ones
+	oversampleInit(NULL, 0);
+	driveBench(127, 200, &ime, &encoder);
+	SIM_CHECK(ime.failed == 0 && encoder.failed == 0);
+	SIM_CHECK(ime.readUs == SIM_CALL_US && encoder.readUs == SIM_CALL_US);
+	//At 1000 counts per second the IME moves on every 10th read, the encoder every 17th or so
+	SIM_CHECK(ime.updateUs > 900 && ime.updateUs < 1100);
+	SIM_CHECK(encoder.updateUs > 1600 && encoder.updateUs < 1850);
+	SIM_CHECK(driveStopped());
+}
+
+static void pidStopsWindingUp(void) {
+	static const PidGains gains = { 500, 100, 0, 100, 127, 0 };
+	static const PidGains reversed = { -500, -100, 0, 100, 127, 0 };
+	Pid pid;
+	int i, output = 0;
+
+	pidInit(&pid, &gains);
+	//Held far off target: saturated, so the integral must not keep growing
+	for (i = 0; i < 200; i++)
+		SIM_CHECK(pidUpdate(&pid, 1000) == 127);
+	SIM_CHECK(pid.integral < 1000);
+	//Just past the target it turns around at once instead of unwinding for 200 updates
+	output = pidUpdate(&pid, -10);
+	SIM_CHECK(output < 0);
+	//Off target without saturating, the integral term stops at iMax
+	pidReset(&pid);
+	for (i = 0; i < 200; i++)
+		output = pidUpdate(&pid, 20);
+	SIM_CHECK(output == 20 * 500 / 1000 + 100);
+	//Reverse acting, the integral still stops at iMax on the side of the error
+	pidInit(&pid, &reversed);
+	for (i = 0; i < 200; i++)
+		output = pidUpdate(&pid, -20);
+	SIM_CHECK(output == 20 * 500 / 1000 + 100);
+}
+
+static void pidFiltersDerivative(void) {
+	static const PidGains raw = { 0, 0, 1000, 0, 0, 0 };
+	static const PidGains smooth = { 0, 0, 1000, 0, 0, 2 };
+	static const PidFloatGains smoothFloat = { 0, 0, 1, 0, 0, 0.25f };
+	Pid pidRaw, pidSmooth;
+	PidFloat pidFloat;
+	int i, outRaw = 0, outSmooth = 0;
+	float outFloat = 0;
+
+	pidInit(&pidRaw, &raw);
+	pidInit(&pidSmooth, &smooth);
+	pidFloatInit(&pidFloat, &smoothFloat);
+	SIM_CHECK(pidUpdate(&pidRaw, 0) == 0);
+	pidUpdate(&pidSmooth, 0);
+	pidFloatUpdate(&pidFloat, 0);
+	//A step of 100 kicks the raw derivative fully, the filtered ones a quarter
+	SIM_CHECK(pidUpdate(&pidRaw, 100) == 100);
+	SIM_CHECK(pidUpdate(&pidSmooth, 100) == 25);
+	SIM_CHECK(pidFloatUpdate(&pidFloat, 100) == 25.0f);
+	//A steady ramp of 8 per update is followed exactly once the filter settles
+	for (i = 0; i < 40; i++) {
+		outRaw = pidUpdate(&pidRaw, 100 + 8 * i);
+		outSmooth = pidUpdate(&pidSmooth, 100 + 8 * i);
+		outFloat = pidFloatUpdate(&pidFloat, 100 + 8 * i);
+	}
+	SIM_CHECK(outRaw == 8 && outSmooth == 8);
+	SIM_CHECK(outFloat > 7.9f && outFloat < 8.1f);
+}
+
+static void feedforwardAndSettle(void) {
+	static const Feedforward ff = { 10, 100, 50 };
+	static const FeedforwardFloat ffFloat = { 10, 0.1f, 0.05f };
+	Settle settle;
+
+	SIM_CHECK(feedforward(&ff, 500, 0) == 60);
+	SIM_CHECK(feedforward(&ff, -500, -200) == -70);
+	SIM_CHECK(feedforward(&ff, 0, 200) == 10);
+	SIM_CHECK(feedforwardFloat(&ffFloat, -500, -200) == -70.0f);
+	settleInit(&settle, 5, 100);
+	SIM_CHECK(!settleUpdate(&settle, 3));
+	delay(60);
+	SIM_CHECK(!settleUpdate(&settle, -5));
+	//Leaving the tolerance starts the wait again
+	SIM_CHECK(!settleUpdate(&settle, 6));
+	SIM_CHECK(!settleUpdate(&settle, 0));
+	delay(60);
+	SIM_CHECK(!settleUpdate(&settle, 0));
+	delay(50);
+	SIM_CHECK(settleUpdate(&settle, 2));
+}
+
+// Steps of a pot reading through a filter: FILTER_STEP_AT samples at 1000, then 2000
+#define FILTER_STEP_AT 100
+#define FILTER_SAMPLES 400
+
+// A pot reading that steps up, with +-60 of noise and a spike of 600 every 50 samples
+static int filterReading(unsigned int i, unsigned long *seed) {
+	*seed = *seed * 1103515245UL + 12345;
+	return (i < FILTER_STEP_AT ? 1000 : 2000) + (int)((*seed >> 16) % 121) - 60 +
+		(i % 50 == 25 ? 600 : 0);
+}
+
+// Lag and noise of one filter on the step: samples from the step until the output is 90% of
+// the way, mean error once settled and the worst error then
+typedef struct {
+	int lag;
+	int noise;
+	int worst;
+} FilterResult;
+
+// Runs the step through a filter; update is one of the filters' update functions
+static FilterResult filterStep(const char *name, void *filter, int (*update)(void *, int)) {
+	FilterResult result = { -1, 0, 0 };
+	unsigned long seed = 1;
+	unsigned int i;
+	int out, error;
+
+	for (i = 0; i < FILTER_SAMPLES; i++) {
+		out = update(filter, filterReading(i, &seed));
+		if (i >= FILTER_STEP_AT && result.lag < 0 && out >= 1900)
+			result.lag = i - FILTER_STEP_AT;
+		if (i >= FILTER_STEP_AT + 100) {
+			error = abs(out - 2000);
+			result.noise += error;
+			if (error > result.worst)
+				result.worst = error;
+		}
+	}
+	result.noise /= FILTER_SAMPLES - FILTER_STEP_AT - 100;
+	printf("filter: %-8s lag %3d noise %3d worst %3d\r\n", name, result.lag, result.noise,
+		result.worst);
+	return result;
+}
+
+static int filterNone(void *filter, int sample) {
+	return sample;
+}
+
+static int filterAverage(void *filter, int sample) {
+	return averageUpdate(filter, sample);
+}
+
+static int filterMedian(void *filter, int sample) {
+	return medianUpdate(filter, sample);
+}
+
+static int filterEma(void *filter, int sample) {
+	return emaUpdate(filter, sample);
+}
+
+static int filterBiquad(void *filter, int sample) {
+	return biquadUpdate(filter, sample);
+}
+
+static int filterKalman(void *filter, int sample) {
+	return kalmanUpdate(filter, sample);
+}
+
+static void filtersTradeNoiseForLag(void) {
+	FilterResult raw, filtered[5], median, smoother;
+	AverageFilter averageFilter;
+	MedianFilter medianFilter;
+	EmaFilter emaFilter;
+	BiquadFilter biquadFilter;
+	KalmanFilter kalmanFilter;
+	unsigned int i;
+
+	averageInit(&averageFilter, 8);
+	medianInit(&medianFilter, 5);
+	emaInit(&emaFilter, 3);
+	biquadLowPass(&biquadFilter, 5, 100);
+	kalmanInit(&kalmanFilter, 30, 1200);
+	raw = filterStep("none", NULL, filterNone);
+	median = filterStep("median", &medianFilter, filterMedian);
+	filtered[0] = median;
+	filtered[1] = filterStep("average", &averageFilter, filterAverage);
+	filtered[2] = filterStep("ema", &emaFilter, filterEma);
+	filtered[3] = filterStep("biquad", &biquadFilter, filterBiquad);
+	filtered[4] = filterStep("kalman", &kalmanFilter, filterKalman);
+	for (i = 0; i < 5; i++) {
+		SIM_CHECK(filtered[i].noise < raw.noise * 2 / 3);
+		SIM_CHECK(filtered[i].lag >= 0 && filtered[i].lag <= 20);
+		//Only the median throws the spikes out rather than spreading them
+		SIM_CHECK(i == 0 ? filtered[i].worst < 60 : filtered[i].worst > 80);
+	}
+	//A smoother EMA is quieter but slower
+	emaInit(&emaFilter, 5);
+	smoother = filterStep("ema 5", &emaFilter, filterEma);
+	SIM_CHECK(smoother.noise < filtered[2].noise && smoother.lag > filtered[2].lag * 3);
+}
+
+// The pot held at 1000.25 by dithering: +-8 of noise, and 1 more a quarter of the time
+static unsigned long oversampleSeed;
+
+static void oversampleDither(void) {
+	oversampleSeed = oversampleSeed * 1103515245UL + 12345;
+	simSetAnalog(ARM_POT, 1000 + (int)((oversampleSeed >> 16) % 17) - 8 +
+		((oversampleSeed >> 8) % 4 == 0 ? 1 : 0));
+}
+
+static void oversampleGainsBits(void) {
+	long rawNoise = 0, overNoise = 0, overSum = 0;
+	int raw, over;
+	unsigned int i;
+
+	tossUp();
+	oversampleSeed = 1;
+	simSetStep(oversampleDither);
+	delay(50);
+	for (i = 0; i < 500; i++) {
+		raw = analogRead(ARM_POT) << OVERSAMPLE_BITS;
+		over = oversampleGet(ARM_POT);
+		rawNoise += abs(raw - 4001);
+		overNoise += abs(over - 4001);
+		overSum += over;
+		delay(4);
+	}
+	printf("oversample: mean %ld.%03ld raw noise %ld oversampled noise %ld\r\n", overSum / 500,
+		overSum % 500 * 2, rawNoise / 500, overNoise / 500);
+	//The quarter count a single reading cannot show comes through, with a quarter of the noise
+	SIM_CHECK(overSum / 500 >= 4000 && overSum / 500 <= 4002);
+	SIM_CHECK(overNoise * 3 < rawNoise);
+	SIM_CHECK(armGetPos() >= 999 && armGetPos() <= 1001);
+	//Channels that are not oversampled are read directly at the same scale
+	simSetAnalog(LINESENSE_L, 1234);
+	SIM_CHECK(oversampleGet(LINESENSE_L) == 1234 << OVERSAMPLE_BITS);
+	SIM_CHECK(oversampleRead(LINESENSE_L) == 1234);
+}
+
+static void oversampleRestartsSameTask(void) {
+	static const unsigned char pot[] = { ARM_POT };
+	unsigned int tasks;
+
+	tossUp();
+	tasks = taskGetCount();
+	//Stopped and started again, one task still reads the pot, so its sums hold one reading each
+	oversampleInit(NULL, 0);
+	oversampleInit(pot, 1);
+	oversampleInit(pot, 1);
+	SIM_CHECK(taskGetCount() == tasks);
+	simSetAnalog(ARM_POT, 1000);
+	delay(50);
+	SIM_CHECK(oversampleGet(ARM_POT) == 1000 << OVERSAMPLE_BITS);
+}
+
+// Puts the left line sensor over tape 300 ms in, from another task
+static unsigned long lineAt;
+
+static void lineLater(void *ignore) {
+	delay(300);
+	lineAt = millis();
+	simSetAnalog(LINESENSE_L, 200);
+	taskDelete(NULL);
+}
+
+static void eventsWakeWaiters(void) {
+	static EventQueue lineEvents, armEvents;
+	Event event;
+
+	tossUp();
+	eventSubscribe(&lineEvents, EVENT_MASK(EVENT_LINE_LEFT) | EVENT_MASK(EVENT_LINE_RIGHT));
+	taskCreate(lineLater, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	SIM_CHECK(eventWait(&lineEvents, &event, 1000));
+	SIM_CHECK(event.type == EVENT_LINE_LEFT && event.value == 200 && event.count == 1);
+	//Seen within a sample of the crossing, and woken within a millisecond of that
+	SIM_CHECK(event.time - lineAt <= EVENT_SAMPLE_MS + 1);
+	SIM_CHECK(millis() - event.time <= 1);
+	//Staying on the line is not a new event
+	SIM_CHECK(!eventWait(&lineEvents, &event, 100));
+	eventUnsubscribe(&lineEvents);
+
+	//Driving into the top switch: the interrupt's event, then the move's
+	eventSubscribe(&armEvents, EVENT_MASK(EVENT_LIMIT) | EVENT_MASK(EVENT_ARM_SETTLED));
+	armMoveTo(ARM_POS_TOP, 127);
+	SIM_CHECK(eventWait(&armEvents, &event, 3000));
+	SIM_CHECK(event.type == EVENT_LIMIT && event.value == ARM_FAULT_TOP);
+	SIM_CHECK(eventWait(&armEvents, &event, 100));
+	//The oversampled pot trails the switch by a few counts
+	SIM_CHECK(event.type == EVENT_ARM_SETTLED && abs(event.value - ARM_LIMIT_POS) < 30);
+	SIM_CHECK(!armMoving());
+	eventUnsubscribe(&armEvents);
+}
+
+// Behaviors for the coroutine scenario: the drive forwards for half a second, the arm to the
+// middle, a sequence running those two side by side and a counter of its turns
+static Coro driveCoro, armCoro;
+static unsigned long behaviorsDone;
+
+static CoroStatus driveBehavior(Coro *coro) {
+	CORO_BEGIN(coro);
+	driveDeadReckon(60, 60, 0);
+	CORO_DELAY(coro, 500);
+	driveStop();
+	CORO_END(coro);
+}
+
+static CoroStatus armBehavior(Coro *coro) {
+	CORO_BEGIN(coro);
+	armMoveTo(ARM_POS_MID, 127);
+	CORO_WAIT_UNTIL(coro, !armMoving());
+	CORO_END(coro);
+}
+
+static CoroStatus sequenceBehavior(Coro *coro) {
+	CORO_BEGIN(coro);
+	coroSpawn(&driveCoro, driveBehavior, NULL);
+	coroSpawn(&armCoro, armBehavior, NULL);
+	CORO_WAIT_UNTIL(coro, !coroRunning(&driveCoro) && !coroRunning(&armCoro));
+	behaviorsDone = millis();
+	CORO_END(coro);
+}
+
+static CoroStatus countBehavior(Coro *coro) {
+	CORO_BEGIN(coro);
+	while (1) {
+		(*(unsigned int *)coro->arg)++;
+		CORO_YIELD(coro);
+	}
+	CORO_END(coro);
+}
+
+static void coroutinesShareATask(void) {
+	static Coro sequence, counter;
+	unsigned int turns = 0, tasks, counted;
+	unsigned long start;
+
+	tossUp();
+	coroInit();
+	tasks = taskGetCount();
+	start = millis();
+	behaviorsDone = 0;
+	SIM_CHECK(coroSpawn(&sequence, sequenceBehavior, NULL));
+	SIM_CHECK(coroSpawn(&counter, countBehavior, &turns));
+	//The drive is done on time while the arm is still on its way
+	delay(600);
+	SIM_CHECK(!coroRunning(&driveCoro) && coroRunning(&armCoro));
+	SIM_CHECK(driveStopped());
+	while (coroRunning(&sequence) && millis() - start < 4000)
+		delay(10);
+	SIM_CHECK(behaviorsDone > 0 && abs(armGetPos() - ARM_POS_MID) < 30);
+	//No task was made for any of them, and every one had a turn each tick
+	SIM_CHECK(taskGetCount() == tasks);
+	SIM_CHECK(abs((int)turns - (int)((behaviorsDone - start) / CORO_TICK_MS)) <= 2);
+	coroStop(&counter);
+	counted = turns;
+	delay(100);
+	SIM_CHECK(turns == counted && !coroRunning(&counter));
+	coroBench(20);
+}
+
+// A controller as a project might make one while running
+typedef struct {
+	Pid pid;
+	PidGains gains;
+	unsigned char port;
+} PooledController;
+
+POOL_STORAGE(controllerBlocks, PooledController, 3);
+
+static void poolCountsBlocks(void) {
+	static Pool controllers;
+	PooledController *taken[4], other;
+	unsigned char i;
+
+	poolInit(&controllers, "controllers", controllerBlocks, sizeof(controllerBlocks[0]), 3);
+	for (i = 0; i < 4; i++)
+		taken[i] = poolAlloc(&controllers);
+	//Three blocks, all different and all from the storage, then a refusal
+	SIM_CHECK(taken[0] && taken[1] && taken[2] && !taken[3]);
+	SIM_CHECK(taken[0] != taken[1] && taken[1] != taken[2] && taken[0] != taken[2]);
+	SIM_CHECK((void *)taken[0] == (void *)&controllerBlocks[0]);
+	SIM_CHECK(controllers.used == 3 && controllers.peak == 3 && controllers.failed == 1);
+	//A freed block is the next one handed out; strangers, NULL and a second free are ignored
+	poolFree(&controllers, taken[1]);
+	poolFree(&controllers, taken[1]);
+	poolFree(&controllers, &other);
+	poolFree(&controllers, (unsigned char *)taken[2] + 1);
+	poolFree(&controllers, NULL);
+	SIM_CHECK(controllers.used == 2);
+	SIM_CHECK(poolAlloc(&controllers) == taken[1]);
+	SIM_CHECK(poolAlloc(&controllers) == NULL);
+	for (i = 0; i < 3; i++)
+		poolFree(&controllers, taken[i]);
+	SIM_CHECK(controllers.used == 0 && controllers.peak == 3);
+	poolReport();
+	//Setting it up again starts the counts over
+	poolInit(&controllers, "controllers", controllerBlocks, sizeof(controllerBlocks[0]), 3);
+	SIM_CHECK(controllers.peak == 0 && controllers.failed == 0);
+}
+
+// Forwards round a corner, then backwards on a curve like the Curve routine's ram
+static const Waypoint cornerPoints[] = { { 0, 0 }, { 24, 0 }, { 48, 24 } };
+static const PursuitPath cornerPath = { cornerPoints, 3, 100, 8, 20, 0.5f, 12, 2 };
+static const Waypoint reversePoints[] = { { 0, 0 }, { -14, 4 }, { -38, 16 }, { -50, 20 } };
+static const PursuitPath reversePath = { reversePoints, 4, -100, 10, 24, 0.5f, 10, 2 };
+
+static void pursuitFollowsPaths(void) {
+	Pose pose;
+	unsigned long start;
+
+	tossUp();
+	odomReset(0, 0, 0);
+	start = millis();
+	SIM_CHECK(pursuitFollow(&cornerPath, 8000));
+	odomGet(&pose);
+	//Within the tolerance and the little it coasts after, facing along the last segment
+	SIM_CHECK(abs((int)pose.x - 48) < 4 && abs((int)pose.y - 24) < 4);
+	SIM_CHECK(pose.heading > 0.4f && pose.heading < 1.2f);
+	SIM_CHECK(millis() - start < 6000);
+	delay(300);
+	odomReset(0, 0, 0);
+	SIM_CHECK(pursuitFollow(&reversePath, 8000));
+	odomUpdate();
+	odomGet(&pose);
+	SIM_CHECK(abs((int)pose.x + 50) < 4 && abs((int)pose.y - 20) < 4);
+	//Backing to the left turns the front to the right
+	SIM_CHECK(pose.heading < -0.1f && pose.heading > -0.8f);
+}
+
+static void trajectoryFollowsTable(void) {
+	static const TrajectoryGains gains = { { 0, 127, 10 }, 300 };
+	const TrajectoryPoint *end = &ramCurve.points[ramCurve.count - 1];
+	unsigned long start;
+	int left, right;
+	unsigned short i;
+
+	//The path starts 10 in straight back: the sides stay level, not swinging off it first
+	for (i = 0; i < ramCurve.count && ramCurve.points[i].left > -490; i++)
+		SIM_CHECK(abs(ramCurve.points[i].left - ramCurve.points[i].right) <= 2);
+	tossUp();
+	clearEncoders();
+	start = millis();
+	SIM_CHECK(trajectoryFollow(&ramCurve, &gains, false));
+	SIM_CHECK(millis() - start >= trajectoryTime(&ramCurve));
+	SIM_CHECK(millis() - start < trajectoryTime(&ramCurve) + 50);
+	driveGetCounts(&left, &right);
+	SIM_CHECK(abs(left - end->left) < TRAJECTORY_TOLERANCE);
+	SIM_CHECK(abs(right - end->right) < TRAJECTORY_TOLERANCE);
+	//Mirrored, each side ends where the other did
+	delay(300);
+	clearEncoders();
+	SIM_CHECK(trajectoryFollow(&ramCurve, &gains, true));
+	driveGetCounts(&left, &right);
+	SIM_CHECK(abs(left - end->right) < TRAJECTORY_TOLERANCE);
+	SIM_CHECK(abs(right - end->left) < TRAJECTORY_TOLERANCE);
+}
+
+// Lowers the arm for 200 ms by its pot, the same way whether the model or a log answers
+static void recordedRun(void) {
+	unsigned long start = millis();
+
+	while (millis() - start < 200) {
+		motorSet(ARM_BR, (analogRead(ARM_POT) - 1000) / 16);
+		delay(10);
+	}
+	motorStop(ARM_BR);
+}
+
+static void recordReplaysRun(void) {
+	simLinkAnalog(ARM_POT, ARM_BR, -1500, 1000, 4095);
+	simSetAnalog(ARM_POT, 3000);
+	recordStart();
+	simRecord(true);
+	recordedRun();
+	simRecord(false);
+	recordStop();
+	SIM_CHECK(recordCount() > 20);
+	SIM_CHECK(simLogTo("bin/host/record.log"));
+	recordDump();
+	SIM_CHECK(simLogTo(NULL));
+	//Played back, the run reads what it read before and must command the same
+	SIM_CHECK(simReplayFile("bin/host/record.log"));
+	recordedRun();
+	SIM_CHECK(simReplayMismatches() == 0);
+	SIM_CHECK(simReplayLeft() == 0);
+}
+
+// Presses LCD buttons for the selector: alliance over, routine on twice
+static void selectorPresses(void *ignore) {
+	static const unsigned int presses[] = { LCD_BTN_RIGHT, LCD_BTN_CENTER, LCD_BTN_RIGHT,
+		LCD_BTN_LEFT, LCD_BTN_RIGHT, LCD_BTN_RIGHT, LCD_BTN_CENTER };
+	unsigned int i;
+
+	for (i = 0; i < sizeof(presses) / sizeof(presses[0]); i++) {
+		delay(100);
+		simSetLcdButtons(presses[i]);
+		delay(100);
+		simSetLcdButtons(0);
+	}
+}
+
+static void selectorChoosesOnLcd(void) {
+	unsigned char routine;
+	bool red;
+
+	tossUp();
+	routine = selectorRoutine();
+	red = selectorRed();
+	//Disabled before the match: the menu waits for the buttons
+	simSetEnabled(false);
+	taskCreate(selectorPresses, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	autonomousInit();
+	SIM_CHECK(simMicros() < 2000000ULL);
+	SIM_CHECK(selectorRed() == !red);
+	SIM_CHECK(selectorRoutine() == (routine + 2) % selectorCount());
+	SIM_CHECK(strcmp(simGetLcdText(1), red ? "Blue alliance" : "Red alliance") == 0);
+	//Power cycle: the choice comes back from flash without a button
+	simSetEnabled(true);
+	initialize();
+	SIM_CHECK(selectorRed() == !red);
+	SIM_CHECK(selectorRoutine() == (routine + 2) % selectorCount());
+}
+
+// Steps the calibration LCD to armTop and captures it
+static void calibPresses(void *ignore) {
+	static const unsigned int presses[] = { LCD_BTN_RIGHT, LCD_BTN_RIGHT, LCD_BTN_LEFT,
+		LCD_BTN_RIGHT, LCD_BTN_RIGHT, LCD_BTN_CENTER };
+	unsigned int i;
+
+	for (i = 0; i < sizeof(presses) / sizeof(presses[0]); i++) {
+		delay(100);
+		simSetLcdButtons(presses[i]);
+		delay(100);
+		simSetLcdButtons(0);
+	}
+}
+
+static void calibrationKept(void) {
+	Calibration defaults;
+	int i;
+
+	tossUp();
+	defaults = calibration;
+	//Pot re-mounted: mid now reads 3180
+	simSetAnalog(ARM_POT, 3180);
+	simSetSerialInput("armMid\r\nlineThresh 350\nbogus 1\nlineThresh x\n\n");
+	calibSerial();
+	SIM_CHECK(ARM_POS_MID == 3180);
+	SIM_CHECK(LINE_THRESH == 350);
+	simSetAnalog(ARM_POT, 2250);
+	taskCreate(calibPresses, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	calibLcd(uart1, 1000);
+	SIM_CHECK(ARM_POS_TOP == 2250);
+	//Power cycle: RAM starts from the defaults again and the saved values are loaded
+	calibration = defaults;
+	initialize();
+	SIM_CHECK(ARM_POS_MID == 3180 && LINE_THRESH == 350 && ARM_POS_TOP == 2250);
+	//Enough changes to fill the page and start it again
+	for (i = 0; i < 600; i++)
+		SIM_CHECK(calibSet(6, 300 + i % 7));
+	calibration = defaults;
+	initialize();
+	SIM_CHECK(ARM_POS_MID == 3180 && LINE_THRESH == 300 + 599 % 7 && ARM_POS_TOP == 2250);
+	//Leave the defaults for the other scenarios
+	calibSet(2, defaults.armMid);
+	calibSet(3, defaults.armTop);
+	calibSet(6, defaults.lineThresh);
+}
+
+static unsigned long bootFinalAt;
+
+static void bootGyro(void) {
+	gyroInit(4, 0);
+}
+
+static void bootCalibrateLeft(void) {
+	analogCalibrate(LINESENSE_L);
+}
+
+static void bootCalibrateRight(void) {
+	analogCalibrate(LINESENSE_R);
+}
+
+static void bootFinal(void) {
+	bootFinalAt = millis();
+}
+
+static void bootOverlapsWaits(void) {
+	static const BootStage stages[] = {
+		{ "gyro", bootGyro, false },
+		{ "line left", bootCalibrateLeft, false },
+		{ "line right", bootCalibrateRight, false },
+		{ "final", bootFinal, true },
+	};
+	unsigned long start, total;
+
+	tossUp();
+	start = millis();
+	total = bootRun(stages, 4);
+	//One after the other would take 2 s; side by side only as long as the gyro
+	SIM_CHECK(total >= 1000 && total < 1050);
+	SIM_CHECK(millis() - start == total);
+	SIM_CHECK(bootFinalAt - start >= 1000);
+}
+
+const SimScenario simScenarios[] = {
+	{ "driveStraight forwards", driveStraightForwards, 5000 },
+	{ "driveStraight backwards", driveStraightBackwards, 5000 },
+	{ "driveTurn left", driveTurnLeft, 5000 },
+	{ "driveToLine square", driveToLineSquare, 5000 },
+	{ "driveToLine skewed", driveToLineSkewed, 5000 },
+	{ "armTo mid", armToMid, 5000 },
+	{ "arm holds against gravity", armHoldsAgainstGravity, 6000 },
+	{ "arm idle speed sags", armIdleSags, 5000 },
+	{ "armTo top stops at limit", armToTopStopsAtLimit, 5000 },
+	{ "armTo bottom", armToBottom, 5000 },
+	{ "arm limit stops a blind drive", armLimitStopsBlindDrive, 5000 },
+	{ "drive sticks shaped", driveSticksShaped, 5000 },
+	{ "arm preset keeps driving", armPresetKeepsDriving, 5000 },
+	{ "arm button cancels preset", armButtonCancelsPreset, 5000 },
+	{ "drive feedback agrees", driveFeedbackAgrees, 5000 },
+	{ "drive bench reads", driveBenchReads, 5000 },
+	{ "pid stops winding up", pidStopsWindingUp, 5000 },
+	{ "pid filters the derivative", pidFiltersDerivative, 5000 },
+	{ "feedforward and settle", feedforwardAndSettle, 5000 },
+	{ "filters trade noise for lag", filtersTradeNoiseForLag, 5000 },
+	{ "oversampling gains bits", oversampleGainsBits, 5000 },
+	{ "oversampling restarts the same task", oversampleRestartsSameTask, 5000 },
+	{ "events wake waiters", eventsWakeWaiters, 5000 },
+	{ "coroutines share a task", coroutinesShareATask, 5000 },
+	{ "pool counts blocks", poolCountsBlocks, 5000 },
+	{ "pursuit follows paths", pursuitFollowsPaths, 20000 },
+	{ "trajectory follows a table", trajectoryFollowsTable, 15000 },
+	{ "record replays a run", recordReplaysRun, 2000 },
+	{ "selector chooses on the LCD", selectorChoosesOnLcd, 5000 },
+	{ "calibration kept", calibrationKept, 5000 },
+	{ "boot overlaps waits", bootOverlapsWaits, 5000 },
+	{ "route replays driving", routeReplaysDriving, 10000 },
+	{ "route corrects a weak drive", routeCorrectsWeakDrive, 15000 },
+	{ NULL, NULL, 0 }
+};
@@ -0,0 +1,330 @@
+/** @file harness.c
+ * @brief Runs a project's simulated scenarios and reports them as JSON
+ *
+ * Usage: sim [--bench] [--runs N] [--replay RECORD] [--log FILE]
+ *
+ * Without --bench every scenario runs once and the exit status is nonzero if any failed.
+ * With --bench every scenario runs N times (default 100) and the host time per run is added.
+ * With --replay the last complete recordDump() log in RECORD is fed back through
+ * initializeIO(), initialize() and autonomous() instead, and the report lists how far the code
+ * followed the log and which motor commands differed.
+ * Output printed by the code under test goes to FILE (default /dev/null) so stdout holds
+ * only the JSON report.
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// From sim.h, which cannot be included alongside stdio.h
+typedef struct {
+	const char *name;
+	void (*run)(void);
+	unsigned long timeout;
+} SimScenario;
+
+typedef struct {
+	char kind;
+	unsigned char port;
+	unsigned long count;
+	const int *values;
+	const bool *failed;
+} SimReplayPort;
+
+extern const SimScenario simScenarios[];
+void simCheck(bool ok, const char *file, int line, const char *expr);
+bool simRun(const SimScenario *scenario);
+const char *simFailures();
+unsigned long long simMicros();
+unsigned long simReads();
+void simReplay(const SimReplayPort *ports, unsigned int count);
+unsigned long simReplayCalls();
+unsigned long simReplayLeft();
+unsigned int simReplayMismatches();
+
+// From main.h of the project under test
+void initializeIO();
+void initialize();
+void autonomous();
+
+// Most ports a log can have; the recorder has fewer
+#define REPLAY_PORTS 128
+
+// A port being decoded from a log, with its prediction state
+typedef struct {
+	SimReplayPort port;
+	int *values;
+	bool *failed;
+	unsigned long size;
+	int last;
+	int step;
+	bool failing;
+} ReplayDecoder;
+
+// The console log, where output goes outside simLogTo()
+static int logFd = -1;
+
+static ReplayDecoder replayDecoders[REPLAY_PORTS];
+static SimReplayPort replayPorts[REPLAY_PORTS];
+static unsigned int replayCount;
+
+// Used when the project has no test/ directory
+__attribute__((weak)) const SimScenario simScenarios[] = { { NULL, NULL, 0 } };
+
+static double hostMicros() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Prints a string as a JSON string literal
+static void jsonString(FILE *out, const char *s) {
+	fputc('"', out);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			fprintf(out, "\\%c", *s);
+		else if (*s == '\n')
+			fputs("\\n", out);
+		else if ((unsigned char)*s < 0x20)
+			fprintf(out, "\\u%04x", *s);
+		else
+			fputc(*s, out);
+	}
+	fputc('"', out);
+}
+
+// Finds or adds the decoder of a port, or returns NULL if there are too many
+static ReplayDecoder *replayDecoder(char kind, unsigned char port) {
+	unsigned int i;
+
+	for (i = 0; i < replayCount; i++)
+		if (replayDecoders[i].port.kind == kind && replayDecoders[i].port.port == port)
+			return &replayDecoders[i];
+	if (replayCount == REPLAY_PORTS)
+		return NULL;
+	replayDecoders[replayCount].port.kind = kind;
+	replayDecoders[replayCount].port.port = port;
+	return &replayDecoders[replayCount++];
+}
+
+// Appends one call to a port
+static void replayAppend(ReplayDecoder *d, int value) {
+	if (d->port.count == d->size) {
+		d->size = d->size ? d->size * 2 : 256;
+		d->values = realloc(d->values, d->size * sizeof(int));
+		d->failed = realloc(d->failed, d->size * sizeof(bool));
+	}
+	d->values[d->port.count] = value;
+	d->failed[d->port.count] = d->failing;
+	d->port.count++;
+	d->last = value;
+}
+
+// Appends calls that followed the prediction
+static void replayPredicted(ReplayDecoder *d, unsigned long calls) {
+	while (calls-- > 0)
+		replayAppend(d, d->last + d->step);
+}
+
+static void replayClear() {
+	unsigned int i;
+
+	for (i = 0; i < replayCount; i++) {
+		free(replayDecoders[i].values);
+		free(replayDecoders[i].failed);
+	}
+	memset(replayDecoders, 0, sizeof(replayDecoders));
+	replayCount = 0;
+}
+
+// Decodes the last complete log in a saved terminal capture, skipping any other output
+static bool replayLoad(const char *path) {
+	FILE *in = fopen(path, "r");
+	char line[128], kind, sign;
+	unsigned char port;
+	unsigned int bytes, dropped, i;
+	unsigned long gap, calls;
+	int value, step;
+	bool inLog = false, loaded = false;
+	ReplayDecoder *d;
+
+	if (in == NULL)
+		return false;
+	while (fgets(line, sizeof(line), in)) {
+		if (sscanf(line, "record %u %u", &bytes, &dropped) == 2) {
+			replayClear();
+			inLog = true;
+			loaded = false;
+			if (dropped > 0)
+				fprintf(stderr, "%s: the log filled up and dropped %u calls\n", path, dropped);
+		}
+		else if (!inLog)
+			continue;
+		else if (strncmp(line, "end", 3) == 0) {
+			inLog = false;
+			loaded = true;
+		}
+		else if (sscanf(line, "calls %c %hhu %lu", &kind, &port, &calls) == 3) {
+			//The calls after the last entry followed the prediction
+			d = replayDecoder(kind, port);
+			if (d && calls > d->port.count)
+				replayPredicted(d, calls - d->port.count);
+		}
+		else if (sscanf(line, "%c %hhu %lu %c%d %d", &kind, &port, &gap, &sign, &value,
+				&step) == 6 && (d = replayDecoder(kind | 0x20, port))) {
+			replayPredicted(d, gap);
+			if (sign == '=') {
+				d->failing = kind != (kind | 0x20);
+				replayAppend(d, value);
+			}
+			else
+				replayAppend(d, d->last + d->step + (sign == '-' ? -value : value));
+			d->step = step;
+		}
+	}
+	fclose(in);
+
+	for (i = 0; i < replayCount; i++) {
+		replayPorts[i] = replayDecoders[i].port;
+		replayPorts[i].values = replayDecoders[i].values;
+		replayPorts[i].failed = replayDecoders[i].failed;
+	}
+	return loaded;
+}
+
+bool simReplayFile(const char *path) {
+	if (!replayLoad(path))
+		return false;
+	simReplay(replayPorts, replayCount);
+	return true;
+}
+
+bool simLogTo(const char *path) {
+	int fd = path ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : logFd;
+
+	if (fd < 0)
+		return false;
+	fflush(stdout);
+	dup2(fd, STDOUT_FILENO);
+	if (path)
+		close(fd);
+	return true;
+}
+
+static void replayRun(void) {
+	simReplay(replayPorts, replayCount);
+	initializeIO();
+	initialize();
+	autonomous();
+	simCheck(simReplayLeft() == 0, "replay", simReplayCalls(),
+		"autonomous() returned before the log ended");
+}
+
+// Replays a log as a single scenario and prints its report
+static int replayMain(FILE *out, const char *project, const char *path) {
+	SimScenario scenario = { "replay", replayRun, 0 };
+	bool ok;
+
+	if (!replayLoad(path)) {
+		fprintf(stderr, "%s: no complete record log found\n", path);
+		return 2;
+	}
+	ok = simRun(&scenario);
+	fflush(stdout);
+
+	fprintf(out, "{\"project\": ");
+	jsonString(out, project ? project : "");
+	fprintf(out, ", \"mode\": \"replay\", \"log\": ");
+	jsonString(out, path);
+	fprintf(out, ", \"ports\": %u, \"calls\": %lu, \"left\": %lu, \"mismatches\": %u, "
+		"\"pass\": %s, \"sim_ms\": %.1f, \"failures\": ", replayCount, simReplayCalls(),
+		simReplayLeft(), simReplayMismatches(), ok ? "true" : "false", simMicros() / 1000.0);
+	jsonString(out, simFailures());
+	fprintf(out, "}\n");
+	fclose(out);
+
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+	const char *project = getenv("SIM_PROJECT");
+	const char *log = "/dev/null";
+	const char *replay = NULL;
+	bool bench = false;
+	int runs = 100;
+	int passed = 0, failed = 0;
+	int i, fd;
+	const SimScenario *scenario;
+	FILE *out;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--bench") == 0)
+			bench = true;
+		else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+			runs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			replay = argv[++i];
+		else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc)
+			log = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--bench] [--runs N] [--replay RECORD] [--log FILE]\n",
+				argv[0]);
+			return 2;
+		}
+	}
+	if (!bench || runs < 1)
+		runs = 1;
+
+	//Keep the report on the real stdout and send the robot's printf output to the log
+	fflush(stdout);
+	out = fdopen(dup(STDOUT_FILENO), "w");
+	fd = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (out == NULL || fd < 0) {
+		perror(log);
+		return 2;
+	}
+	dup2(fd, STDOUT_FILENO);
+	logFd = fd;
+
+	if (replay)
+		return replayMain(out, project, replay);
+
+	fprintf(out, "{\"project\": ");
+	jsonString(out, project ? project : "");
+	fprintf(out, ", \"mode\": \"%s\", \"runs\": %d, \"scenarios\": [", bench ? "bench" : "test",
+		runs);
+	for (scenario = simScenarios; scenario->name; scenario++) {
+		bool ok = true;
+		double start = hostMicros(), hostUs;
+		int run;
+
+		for (run = 0; run < runs; run++)
+			ok = simRun(scenario) && ok;
+		hostUs = (hostMicros() - start) / runs;
+		fflush(stdout);
+
+		if (ok)
+			passed++;
+		else
+			failed++;
+		fprintf(out, "%s\n  {\"name\": ", scenario == simScenarios ? "" : ",");
+		jsonString(out, scenario->name);
+		fprintf(out, ", \"pass\": %s, \"sim_ms\": %.1f, \"iterations\": %lu",
+			ok ? "true" : "false", simMicros() / 1000.0, simReads());
+		if (bench)
+			fprintf(out, ", \"host_us\": %.1f", hostUs);
+		fprintf(out, ", \"failures\": ");
+		jsonString(out, simFailures());
+		fprintf(out, "}");
+	}
+	fprintf(out, "%s], \"passed\": %d, \"failed\": %d}\n", passed + failed ? "\n" : "", passed,
+		failed);
+	fclose(out);
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,1047 @@
+/** @file sim.c
+ * @brief Host simulation of the PROS API for scripted scenarios
+ */
+
+#include <setjmp.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "sim.h"
+#include <drive.h>
+#include <flash.h>
+#include <record.h>
+
+// From the library's internal.h: logs a call as recordwrap.c does under make RECORD=1
+void recordAdd(char kind, unsigned char port, int value);
+// From the library's internal.h: forgets the oversampling task that the last scenario started
+void oversampleForget();
+
+int vsnprintf(char *buffer, size_t limit, const char *formatString, va_list args);
+
+// Simulated task stack size in bytes; host frames are much larger than Cortex ones
+#define SIM_STACK_SIZE (256 * 1024)
+// Kernel time slice; a task that has not delayed for this long is preempted
+#define SIM_SLICE_US 1000
+#define SIM_FAILURES_MAX 2048
+// Time constant of a motor's speed following its command, so mechanisms coast and brake
+#define SIM_MOTOR_TAU_US 80000.0
+// Motor differences listed in the failures of a replay; the rest are only counted
+#define SIM_REPLAY_DIFFS 20
+
+#define SIM_MOTORS 11
+#define SIM_ANALOG (BOARD_NR_ADC_PINS + 1)
+#define SIM_DIGITAL (BOARD_NR_GPIO_PINS + 1)
+#define SIM_IMES (IME_ADDR_MAX + 1)
+
+typedef enum {
+	TASK_FREE = 0,
+	TASK_READY,
+	TASK_SUSPENDED,
+} TaskState;
+
+typedef struct {
+	TaskState state;
+	ucontext_t context;
+	char *stack;
+	TaskCode code;
+	void *parameters;
+	unsigned int priority;
+	unsigned long long wake;
+} SimTask;
+
+typedef struct {
+	unsigned char motor;
+	int rate;
+	int min;
+	int max;
+	int load;
+	double value;
+	double speed;
+} AnalogLink;
+
+typedef struct {
+	unsigned char motor;
+	int rate;
+	double count;
+	double speed;
+	int velocity;
+} ImeLink;
+
+typedef struct {
+	unsigned char motor;
+	int rate;
+	double count;
+	double speed;
+	bool reverse;
+	bool enabled;
+} EncoderLink;
+
+typedef struct {
+	int count;
+	bool mutex;
+} SimSync;
+
+static unsigned long long now;
+static unsigned long long deadline;
+static unsigned long long sliceStart;
+static unsigned long reads;
+static bool aborted;
+static jmp_buf abortJump;
+
+static char failures[SIM_FAILURES_MAX];
+static bool failed;
+
+static SimTask tasks[TASK_MAX];
+static unsigned int current;
+
+static int motors[SIM_MOTORS];
+static int analog[SIM_ANALOG];
+static AnalogLink analogLinks[SIM_ANALOG];
+static bool digital[SIM_DIGITAL];
+static unsigned char interruptEdges[SIM_DIGITAL];
+static InterruptHandler interruptHandlers[SIM_DIGITAL];
+static ImeLink imes[SIM_IMES];
+// Quadrature encoders by top port
+static EncoderLink encoders[SIM_DIGITAL];
+static int ultrasonic;
+static int joyAnalog[3][8];
+static unsigned char joyDigital[3][9];
+static bool enabled;
+// Text still to be read from the programming cable
+static const char *serialInput;
+static unsigned int lcdButtons;
+// Text on lines 1 and 2 of the LCD
+static char lcdText[3][17];
+static void (*stepFunction)(void);
+
+// Recorded calls and calls answered so far on each port, by lower case kind and port
+typedef struct {
+	const SimReplayPort *log;
+	unsigned long calls;
+} ReplayPort;
+
+// Set while simRecord() logs calls to the library's record log
+static bool recording;
+static bool replaying;
+static ReplayPort replayPorts[26][SIM_DIGITAL];
+static unsigned long replayCalls;
+static unsigned int replayMismatches;
+
+// -------------------- Simulated time and physics --------------------
+
+// Moves a mechanism's speed towards its motor command over dt microseconds
+static void simSpin(double *speed, int command, unsigned long long dt) {
+	double k = dt / SIM_MOTOR_TAU_US;
+
+	*speed += (command - *speed) * (k > 1 ? 1 : k);
+}
+
+// Moves every linked sensor by dt microseconds of motor output
+static void simPhysics(unsigned long long dt) {
+	unsigned int i;
+	double seconds = dt / 1000000.0;
+
+	for (i = 0; i < SIM_ANALOG; i++) {
+		AnalogLink *link = &analogLinks[i];
+		if (link->motor) {
+			simSpin(&link->speed, motors[link->motor] + link->load, dt);
+			link->value += link->rate * seconds * link->speed / 127.0;
+			if (link->value < link->min)
+				link->value = link->min;
+			if (link->value > link->max)
+				link->value = link->max;
+			analog[i] = (int)link->value;
+		}
+	}
+	for (i = 0; i < SIM_IMES; i++) {
+		ImeLink *link = &imes[i];
+		if (link->motor) {
+			simSpin(&link->speed, motors[link->motor], dt);
+			link->count += link->rate * seconds * link->speed / 127.0;
+			//Like the real IME, velocity is RPM of its internal motor and has no direction
+			link->velocity = abs((int)(link->rate * link->speed / 127.0 * 60 *
+				DRIVE_IME_GEAR_TENTHS / (DRIVE_COUNTS_PER_REV * 10)));
+		}
+	}
+	for (i = 0; i < SIM_DIGITAL; i++) {
+		EncoderLink *link = &encoders[i];
+		if (link->motor) {
+			simSpin(&link->speed, motors[link->motor], dt);
+			link->count += link->rate * seconds * link->speed / 127.0;
+		}
+	}
+	if (stepFunction)
+		stepFunction();
+}
+
+static void simYield();
+
+// Ends a scenario that ran past its deadline; a replay that outlives its log is simply over
+static void simTimeout() {
+	aborted = true;
+	if (!replaying)
+		simCheck(false, "sim", 0, "timeout");
+}
+
+// Advances time for the running task, preempting it at the end of its time slice
+static void simAdvance(unsigned long long us) {
+	now += us;
+	simPhysics(us);
+	if (now > deadline && !aborted)
+		simTimeout();
+	if (aborted || now - sliceStart >= SIM_SLICE_US)
+		simYield();
+}
+
+// Counts and charges one sensor read
+static void simRead() {
+	reads++;
+	simAdvance(SIM_CALL_US);
+}
+
+// -------------------- Cooperative scheduler --------------------
+
+static void simTaskStart(unsigned int index) {
+	tasks[index].code(tasks[index].parameters);
+	tasks[index].state = TASK_FREE;
+	simYield();
+}
+
+// Switches to the highest priority task that is due, idling time forward if none is
+static void simYield() {
+	unsigned int i, next, prev = current;
+	unsigned long long wake;
+
+	if (aborted) {
+		//Unwind every task back to the scenario's own stack
+		if (current != 0) {
+			current = 0;
+			swapcontext(&tasks[prev].context, &tasks[0].context);
+			return;
+		}
+		longjmp(abortJump, 1);
+	}
+
+	while (1) {
+		next = TASK_MAX;
+		wake = (unsigned long long)-1;
+		for (i = 1; i <= TASK_MAX; i++) {
+			//Round robin, starting after the current task
+			unsigned int t = (prev + i) % TASK_MAX;
+			if (tasks[t].state != TASK_READY)
+				continue;
+			if (tasks[t].wake <= now &&
+					(next == TASK_MAX || tasks[t].priority > tasks[next].priority))
+				next = t;
+			if (tasks[t].wake < wake)
+				wake = tasks[t].wake;
+		}
+		if (next != TASK_MAX)
+			break;
+		//Nothing is due; idle until the next wake time
+		if (wake > deadline)
+			wake = deadline + 1;
+		simPhysics(wake - now);
+		now = wake;
+		if (now > deadline) {
+			simTimeout();
+			simYield();
+			return;
+		}
+	}
+
+	sliceStart = now;
+	if (next != prev) {
+		current = next;
+		swapcontext(&tasks[prev].context, &tasks[next].context);
+		if (aborted && current == 0 && prev == 0)
+			longjmp(abortJump, 1);
+	}
+}
+
+// Blocks the running task until the given time
+static void simSleepUntil(unsigned long long wake) {
+	tasks[current].wake = wake;
+	simYield();
+}
+
+// Ends the scenario from any task without failing it; does not return
+static void simFinish() {
+	aborted = true;
+	simYield();
+}
+
+// -------------------- Replay --------------------
+
+// Ends a replay whose code used a port the log never recorded
+static void simReplayDiverged(char kind, unsigned char port) {
+	char message[80];
+
+	snprintf(message, sizeof(message), "diverged: code used '%c' port %d, which the log never "
+		"recorded", kind, port);
+	simCheck(false, "replay", 0, message);
+	simFinish();
+}
+
+// Answers the next call on a port from the replay log, ending the scenario once the log for
+// that port runs out
+static int simReplayNext(char kind, unsigned char port, bool *failedCall) {
+	ReplayPort *p;
+	unsigned long call;
+
+	if (port >= SIM_DIGITAL || !replayPorts[kind - 'a'][port].log)
+		simReplayDiverged(kind, port);
+	p = &replayPorts[kind - 'a'][port];
+	if (p->calls >= p->log->count)
+		simFinish();
+	call = p->calls++;
+	replayCalls++;
+	if (failedCall)
+		*failedCall = p->log->failed[call];
+	return p->log->values[call];
+}
+
+// Compares a motor command with the log
+static void simReplayMotor(unsigned char channel, int speed) {
+	unsigned long call = replayPorts[RECORD_MOTOR - 'a'][channel].calls;
+	int logged = simReplayNext(RECORD_MOTOR, channel, NULL);
+	char message[64];
+
+	if (logged != speed) {
+		replayMismatches++;
+		if (replayMismatches <= SIM_REPLAY_DIFFS) {
+			snprintf(message, sizeof(message), "motorSet(%d, %d), log has %d", channel, speed,
+				logged);
+			simCheck(false, "replay", call, message);
+		}
+		else
+			failed = true;
+	}
+}
+
+static void simReset() {
+	unsigned int i;
+
+	for (i = 1; i < TASK_MAX; i++)
+		free(tasks[i].stack);
+	memset(tasks, 0, sizeof(tasks));
+	tasks[0].state = TASK_READY;
+	tasks[0].priority = TASK_PRIORITY_DEFAULT;
+	current = 0;
+
+	now = 0;
+	sliceStart = 0;
+	reads = 0;
+	aborted = false;
+	failed = false;
+	failures[0] = '\0';
+
+	memset(motors, 0, sizeof(motors));
+	memset(analog, 0, sizeof(analog));
+	memset(analogLinks, 0, sizeof(analogLinks));
+	//Unconnected digital inputs are pulled up
+	for (i = 0; i < SIM_DIGITAL; i++)
+		digital[i] = HIGH;
+	memset(interruptEdges, 0, sizeof(interruptEdges));
+	memset(interruptHandlers, 0, sizeof(interruptHandlers));
+	memset(imes, 0, sizeof(imes));
+	memset(encoders, 0, sizeof(encoders));
+	ultrasonic = 0;
+	memset(joyAnalog, 0, sizeof(joyAnalog));
+	memset(joyDigital, 0, sizeof(joyDigital));
+	enabled = true;
+	serialInput = NULL;
+	lcdButtons = 0;
+	memset(lcdText, 0, sizeof(lcdText));
+	stepFunction = NULL;
+	recording = false;
+	replaying = false;
+	oversampleForget();
+}
+
+bool simRun(const SimScenario *scenario) {
+	simReset();
+	deadline = (scenario->timeout ? scenario->timeout : SIM_TIMEOUT_DEFAULT) * 1000ULL;
+	if (setjmp(abortJump) == 0)
+		scenario->run();
+	return !failed;
+}
+
+// -------------------- Scenario interface --------------------
+
+void simCheck(bool ok, const char *file, int line, const char *expr) {
+	size_t used = strlen(failures);
+
+	if (ok)
+		return;
+	failed = true;
+	snprintf(failures + used, SIM_FAILURES_MAX - used, "%s:%d: %s at %llu ms\n", file, line,
+		expr, now / 1000);
+}
+
+const char *simFailures() {
+	return failures;
+}
+
+void simReplay(const SimReplayPort *ports, unsigned int count) {
+	unsigned int i;
+
+	replaying = true;
+	memset(replayPorts, 0, sizeof(replayPorts));
+	for (i = 0; i < count; i++)
+		if (ports[i].port < SIM_DIGITAL)
+			replayPorts[ports[i].kind - 'a'][ports[i].port].log = &ports[i];
+	replayCalls = 0;
+	replayMismatches = 0;
+}
+
+unsigned long simReplayCalls() {
+	return replayCalls;
+}
+
+unsigned long simReplayLeft() {
+	unsigned long left = 0;
+	unsigned int i, j;
+
+	for (i = 0; i < 26; i++)
+		for (j = 0; j < SIM_DIGITAL; j++)
+			if (replayPorts[i][j].log)
+				left += replayPorts[i][j].log->count - replayPorts[i][j].calls;
+	return left;
+}
+
+unsigned int simReplayMismatches() {
+	return replayMismatches;
+}
+
+void simRecord(bool on) {
+	recording = on;
+}
+
+// Logs a call the model answered, while simRecord() is on
+static int simRecordCall(char kind, unsigned char port, int value) {
+	if (recording)
+		recordAdd(kind, port, value);
+	return value;
+}
+
+void simSetAnalog(unsigned char channel, int value) {
+	analog[channel] = value;
+	analogLinks[channel].value = value;
+}
+
+int simGetAnalog(unsigned char channel) {
+	return analog[channel];
+}
+
+void simSetDigital(unsigned char pin, bool value) {
+	bool old = digital[pin];
+
+	digital[pin] = value;
+	if (interruptHandlers[pin] && old != value) {
+		if ((value && (interruptEdges[pin] & INTERRUPT_EDGE_RISING)) ||
+				(!value && (interruptEdges[pin] & INTERRUPT_EDGE_FALLING)))
+			interruptHandlers[pin](pin);
+	}
+}
+
+bool simGetDigital(unsigned char pin) {
+	return digital[pin];
+}
+
+int simGetMotor(unsigned char channel) {
+	return motors[channel];
+}
+
+void simLinkAnalog(unsigned char channel, unsigned char motor, int rate, int min, int max) {
+	AnalogLink *link = &analogLinks[channel];
+
+	link->motor = motor;
+	link->rate = rate;
+	link->min = min;
+	link->max = max;
+	link->value = analog[channel];
+}
+
+void simSetAnalogLoad(unsigned char channel, int load) {
+	analogLinks[channel].load = load;
+}
+
+void simLinkIme(unsigned char address, unsigned char motor, int rate) {
+	imes[address].motor = motor;
+	imes[address].rate = rate;
+}
+
+int simGetIme(unsigned char address) {
+	return (int)imes[address].count;
+}
+
+void simLinkEncoder(unsigned char portTop, unsigned char motor, int rate) {
+	encoders[portTop].motor = motor;
+	encoders[portTop].rate = rate;
+}
+
+int simGetEncoder(unsigned char portTop) {
+	return (int)encoders[portTop].count;
+}
+
+void simSetUltrasonic(int value) {
+	ultrasonic = value;
+}
+
+void simSetJoystickAnalog(unsigned char joystick, unsigned char axis, int value) {
+	joyAnalog[joystick][axis] = value;
+}
+
+void simSetJoystickDigital(unsigned char joystick, unsigned char group, unsigned char buttons) {
+	joyDigital[joystick][group] = buttons;
+}
+
+void simSetEnabled(bool value) {
+	enabled = value;
+}
+
+void simSetSerialInput(const char *text) {
+	serialInput = text;
+}
+
+void simSetLcdButtons(unsigned int buttons) {
+	lcdButtons = buttons;
+}
+
+const char *simGetLcdText(unsigned char line) {
+	return line >= 1 && line <= 2 ? lcdText[line] : "";
+}
+
+void simSetStep(void (*step)(void)) {
+	stepFunction = step;
+}
+
+unsigned long long simMicros() {
+	return now;
+}
+
+unsigned long simReads() {
+	return reads;
+}
+
+// -------------------- VEX competition functions --------------------
+
+bool isAutonomous() {
+	return false;
+}
+
+bool isEnabled() {
+	return enabled;
+}
+
+bool isJoystickConnected(unsigned char joystick) {
+	return joystick == 1;
+}
+
+bool isOnline() {
+	return false;
+}
+
+int joystickGetAnalog(unsigned char joystick, unsigned char axis) {
+	simRead();
+	return (joystick >= 1 && joystick <= 2 && axis < 8) ? joyAnalog[joystick][axis] : 0;
+}
+
+bool joystickGetDigital(unsigned char joystick, unsigned char buttonGroup,
+		unsigned char button) {
+	simRead();
+	if (joystick < 1 || joystick > 2 || buttonGroup > 8)
+		return false;
+	return (joyDigital[joystick][buttonGroup] & button) != 0;
+}
+
+unsigned int powerLevelBackup() {
+	return 9000;
+}
+
+unsigned int powerLevelMain() {
+	return 7800;
+}
+
+void setTeamName(const char *name) {
+}
+
+// -------------------- Analog and digital I/O --------------------
+
+int analogCalibrate(unsigned char channel) {
+	delay(500);
+	return analog[channel];
+}
+
+int analogRead(unsigned char channel) {
+	simRead();
+	if (replaying)
+		return simReplayNext(RECORD_ANALOG, channel, NULL);
+	return simRecordCall(RECORD_ANALOG, channel, channel < SIM_ANALOG ? analog[channel] : 0);
+}
+
+// What --wrap links the oversampler to under make RECORD=1: the model, never logged or replayed
+int __real_analogRead(unsigned char channel) {
+	simRead();
+	return channel < SIM_ANALOG ? analog[channel] : 0;
+}
+
+int analogReadCalibrated(unsigned char channel) {
+	return analogRead(channel);
+}
+
+int analogReadCalibratedHR(unsigned char channel) {
+	return analogRead(channel) * 16;
+}
+
+bool digitalRead(unsigned char pin) {
+	simRead();
+	if (replaying)
+		return simReplayNext(RECORD_DIGITAL, pin, NULL);
+	return simRecordCall(RECORD_DIGITAL, pin, pin < SIM_DIGITAL ? digital[pin] : LOW);
+}
+
+void digitalWrite(unsigned char pin, bool value) {
+	if (pin < SIM_DIGITAL)
+		digital[pin] = value;
+}
+
+void pinMode(unsigned char pin, unsigned char mode) {
+}
+
+void ioClearInterrupt(unsigned char pin) {
+	interruptHandlers[pin] = NULL;
+}
+
+void ioSetInterrupt(unsigned char pin, unsigned char edges, InterruptHandler handler) {
+	interruptEdges[pin] = edges;
+	interruptHandlers[pin] = handler;
+}
+
+// -------------------- Motors --------------------
+
+int motorGet(unsigned char channel) {
+	return channel < SIM_MOTORS ? motors[channel] : 0;
+}
+
+// Sets a motor without comparing it with a replay log
+static void simMotorSet(unsigned char channel, int speed) {
+	if (speed > 127)
+		speed = 127;
+	if (speed < -127)
+		speed = -127;
+	if (channel < SIM_MOTORS)
+		motors[channel] = speed;
+}
+
+void motorSet(unsigned char channel, int speed) {
+	if (replaying)
+		simReplayMotor(channel, speed);
+	else
+		simRecordCall(RECORD_MOTOR, channel, speed);
+	simMotorSet(channel, speed);
+}
+
+void motorStop(unsigned char channel) {
+	if (replaying)
+		simReplayMotor(channel, 0);
+	else
+		simRecordCall(RECORD_MOTOR, channel, 0);
+	simMotorSet(channel, 0);
+}
+
+void motorStopAll() {
+	memset(motors, 0, sizeof(motors));
+}
+
+// -------------------- Sensors --------------------
+
+unsigned int imeInitializeAll() {
+	unsigned int i, count = 0;
+
+	for (i = 0; i < SIM_IMES; i++)
+		if (imes[i].motor)
+			count++;
+	return count;
+}
+
+bool imeGet(unsigned char address, int *value) {
+	simRead();
+	if (replaying) {
+		bool failedCall;
+		*value = simReplayNext(RECORD_IME, address, &failedCall);
+		return !failedCall;
+	}
+	if (address >= SIM_IMES || !imes[address].motor) {
+		simRecordCall(RECORD_IME_FAILED, address, 0);
+		return false;
+	}
+	*value = simRecordCall(RECORD_IME, address, (int)imes[address].count);
+	return true;
+}
+
+bool imeGetVelocity(unsigned char address, int *value) {
+	simRead();
+	if (replaying) {
+		bool failedCall;
+		*value = simReplayNext(RECORD_IME_VELOCITY, address, &failedCall);
+		return !failedCall;
+	}
+	if (address >= SIM_IMES || !imes[address].motor) {
+		simRecordCall(RECORD_IME_VELOCITY_FAILED, address, 0);
+		return false;
+	}
+	*value = simRecordCall(RECORD_IME_VELOCITY, address, imes[address].velocity);
+	return true;
+}
+
+bool imeReset(unsigned char address) {
+	if (address >= SIM_IMES || !imes[address].motor)
+		return false;
+	imes[address].count = 0;
+	return true;
+}
+
+void imeShutdown() {
+}
+
+int gyroGet(Gyro gyro) {
+	simRead();
+	return 0;
+}
+
+Gyro gyroInit(unsigned char port, unsigned short multiplier) {
+	delay(1000);
+	return (Gyro)(size_t)port;
+}
+
+void gyroReset(Gyro gyro) {
+}
+
+void gyroShutdown(Gyro gyro) {
+}
+
+int encoderGet(Encoder enc) {
+	EncoderLink *link = &encoders[(size_t)enc];
+
+	simRead();
+	if (replaying)
+		return simReplayNext(RECORD_ENCODER, 0, NULL);
+	return simRecordCall(RECORD_ENCODER, 0, link->reverse ? -(int)link->count : (int)link->count);
+}
+
+Encoder encoderInit(unsigned char portTop, unsigned char portBottom, bool reverse) {
+	EncoderLink *link;
+
+	if (portTop < 1 || portTop > 12 || portBottom < 1 || portBottom > 12 || portTop == 10 ||
+			portBottom == 10 || encoders[portTop].enabled)
+		return NULL;
+	link = &encoders[portTop];
+	link->count = 0;
+	link->reverse = reverse;
+	link->enabled = true;
+	return (Encoder)(size_t)portTop;
+}
+
+void encoderReset(Encoder enc) {
+	encoders[(size_t)enc].count = 0;
+}
+
+void encoderShutdown(Encoder enc) {
+	encoders[(size_t)enc].enabled = false;
+}
+
+int ultrasonicGet(Ultrasonic ult) {
+	simRead();
+	if (replaying)
+		return simReplayNext(RECORD_ULTRASONIC, 0, NULL);
+	return simRecordCall(RECORD_ULTRASONIC, 0, ultrasonic);
+}
+
+Ultrasonic ultrasonicInit(unsigned char portEcho, unsigned char portPing) {
+	return (Ultrasonic)(size_t)portEcho;
+}
+
+void ultrasonicShutdown(Ultrasonic ult) {
+}
+
+// -------------------- Serial and LCD --------------------
+// printf() and friends come from the host C library and write to the console log
+
+void usartInit(FILE *usart, unsigned int baud, unsigned int flags) {
+}
+
+void usartShutdown(FILE *usart) {
+}
+
+int fcount(FILE *stream) {
+	return 0;
+}
+
+void fprint(const char *string, FILE *stream) {
+	printf("%s", string);
+}
+
+void print(const char *string) {
+	printf("%s", string);
+}
+
+int getchar() {
+	simRead();
+	if (!serialInput || *serialInput == '\0')
+		return -1;
+	return (unsigned char)*serialInput++;
+}
+
+void lcdClear(FILE *lcdPort) {
+	memset(lcdText, 0, sizeof(lcdText));
+}
+
+void lcdInit(FILE *lcdPort) {
+}
+
+void lcdPrint(FILE *lcdPort, unsigned char line, const char *formatString, ...) {
+	va_list args;
+
+	if (line < 1 || line > 2)
+		return;
+	va_start(args, formatString);
+	vsnprintf(lcdText[line], sizeof(lcdText[line]), formatString, args);
+	va_end(args);
+}
+
+unsigned int lcdReadButtons(FILE *lcdPort) {
+	simRead();
+	return lcdButtons;
+}
+
+void lcdSetBacklight(FILE *lcdPort, bool backlight) {
+}
+
+void lcdSetText(FILE *lcdPort, unsigned char line, const char *buffer) {
+	if (line >= 1 && line <= 2)
+		snprintf(lcdText[line], sizeof(lcdText[line]), "%s", buffer);
+}
+
+void lcdShutdown(FILE *lcdPort) {
+}
+
+// -------------------- Kept flash --------------------
+// FLASH_USER variables are ordinary host memory that keeps its contents across scenarios, like
+// flash across power cycles; writes can only clear bits, as on the Cortex
+
+bool flashErase(void *page) {
+	//As on the Cortex, the whole page the address is in; FLASH_USER aligns host memory too
+	page = (void *)((unsigned long)page & ~(FLASH_PAGE_BYTES - 1UL));
+	memset(page, 0xFF, FLASH_PAGE_BYTES);
+	return true;
+}
+
+bool flashWrite(void *dest, const void *data, unsigned int bytes) {
+	unsigned char *to = dest;
+	const unsigned char *from = data;
+	bool ok = true;
+
+	for (; bytes > 0; bytes--) {
+		*to &= *from;
+		ok = ok && *to == *from;
+		to++;
+		from++;
+	}
+	return ok;
+}
+
+// -------------------- Tasks --------------------
+
+TaskHandle taskCreate(TaskCode taskCode, const unsigned int stackDepth, void *parameters,
+		const unsigned int priority) {
+	unsigned int i;
+
+	for (i = 1; i < TASK_MAX; i++) {
+		if (tasks[i].state == TASK_FREE) {
+			SimTask *task = &tasks[i];
+			free(task->stack);
+			task->stack = malloc(SIM_STACK_SIZE);
+			task->code = taskCode;
+			task->parameters = parameters;
+			task->priority = priority;
+			task->wake = now;
+			getcontext(&task->context);
+			task->context.uc_stack.ss_sp = task->stack;
+			task->context.uc_stack.ss_size = SIM_STACK_SIZE;
+			task->context.uc_link = NULL;
+			makecontext(&task->context, (void (*)(void))simTaskStart, 1, i);
+			task->state = TASK_READY;
+			return task;
+		}
+	}
+	return NULL;
+}
+
+void taskDelay(const unsigned long msToDelay) {
+	simSleepUntil(now + msToDelay * 1000ULL);
+}
+
+void taskDelayUntil(unsigned long *previousWakeTime, const unsigned long cycleTime) {
+	*previousWakeTime += cycleTime;
+	simSleepUntil(*previousWakeTime * 1000ULL);
+}
+
+void taskDelete(TaskHandle taskToDelete) {
+	SimTask *task = taskToDelete ? (SimTask *)taskToDelete : &tasks[current];
+
+	task->state = TASK_FREE;
+	if (task == &tasks[current])
+		simYield();
+}
+
+unsigned int taskGetCount() {
+	unsigned int i, count = 0;
+
+	for (i = 0; i < TASK_MAX; i++)
+		if (tasks[i].state != TASK_FREE)
+			count++;
+	return count;
+}
+
+unsigned int taskPriorityGet(const TaskHandle task) {
+	return task ? ((SimTask *)task)->priority : tasks[current].priority;
+}
+
+void taskPrioritySet(TaskHandle task, const unsigned int newPriority) {
+	(task ? (SimTask *)task : &tasks[current])->priority = newPriority;
+}
+
+void taskResume(TaskHandle taskToResume) {
+	((SimTask *)taskToResume)->state = TASK_READY;
+}
+
+typedef struct {
+	void (*fn)(void);
+	unsigned long increment;
+} SimLoop;
+
+static void simLoopTask(void *parameters) {
+	SimLoop loop = *(SimLoop *)parameters;
+	unsigned long wake = (unsigned long)(now / 1000);
+
+	free(parameters);
+	while (1) {
+		loop.fn();
+		taskDelayUntil(&wake, loop.increment);
+	}
+}
+
+TaskHandle taskRunLoop(void (*fn)(void), const unsigned long increment) {
+	SimLoop *loop = malloc(sizeof(SimLoop));
+
+	loop->fn = fn;
+	loop->increment = increment;
+	return taskCreate(simLoopTask, TASK_DEFAULT_STACK_SIZE, loop, TASK_PRIORITY_DEFAULT);
+}
+
+void taskSuspend(TaskHandle taskToSuspend) {
+	SimTask *task = taskToSuspend ? (SimTask *)taskToSuspend : &tasks[current];
+
+	task->state = TASK_SUSPENDED;
+	if (task == &tasks[current])
+		simYield();
+}
+
+// -------------------- Semaphores and mutexes --------------------
+// Blocking waits poll once per simulated millisecond; they leak across scenarios by design
+
+static bool simSyncTake(SimSync *sync, unsigned long blockTime) {
+	unsigned long long giveUp = (unsigned long long)-1;
+
+	//Very long block times (such as a MAX_DELAY of all ones) never give up
+	if (blockTime < (giveUp - now) / 1000)
+		giveUp = now + blockTime * 1000ULL;
+	while (sync->count == 0) {
+		if (now >= giveUp)
+			return false;
+		simSleepUntil(now + 1000);
+	}
+	sync->count--;
+	return true;
+}
+
+Semaphore semaphoreCreate() {
+	SimSync *sync = calloc(1, sizeof(SimSync));
+	return sync;
+}
+
+bool semaphoreGive(Semaphore semaphore) {
+	SimSync *sync = semaphore;
+
+	if (sync->count > 0)
+		return false;
+	sync->count = 1;
+	return true;
+}
+
+bool semaphoreTake(Semaphore semaphore, const unsigned long blockTime) {
+	return simSyncTake(semaphore, blockTime);
+}
+
+void semaphoreDelete(Semaphore semaphore) {
+	free(semaphore);
+}
+
+Mutex mutexCreate() {
+	SimSync *sync = calloc(1, sizeof(SimSync));
+	sync->count = 1;
+	sync->mutex = true;
+	return sync;
+}
+
+bool mutexGive(Mutex mutex) {
+	SimSync *sync = mutex;
+
+	if (sync->count > 0)
+		return false;
+	sync->count = 1;
+	return true;
+}
+
+bool mutexTake(Mutex mutex, const unsigned long blockTime) {
+	return simSyncTake(mutex, blockTime);
+}
+
+void mutexDelete(Mutex mutex) {
+	free(mutex);
+}
+
+// -------------------- Timing --------------------
+
+void delay(const unsigned long time) {
+	taskDelay(time);
+}
+
+void delayMicroseconds(const unsigned long us) {
+	simAdvance(us);
+}
+
+unsigned long micros() {
+	return (unsigned long)now;
+}
+
+unsigned long millis() {
+	if (replaying) {
+		unsigned long time = simReplayNext(RECORD_MILLIS, 0, NULL);
+		//Keep the clock level with the log so delays measured against millis() behave
+		if (time * 1000ULL > now)
+			simAdvance(time * 1000ULL - now);
+		return time;
+	}
+	return (unsigned long)simRecordCall(RECORD_MILLIS, 0, (int)(now / 1000));
+}
+
+void wait(const unsigned long time) {
+	taskDelay(time);
+}
+
+void waitUntil(unsigned long *previousWakeTime, const unsigned long time) {
+	taskDelayUntil(previousWakeTime, time);
+}
@@ -0,0 +1,214 @@
+/** @file sim.h
+ * @brief Host simulation of the PROS API for scripted scenarios
+ *
+ * sim.c implements every function in API.h on the host so a project's sources (and robotlib)
+ * can be compiled with gcc and exercised without a Cortex. Time is simulated: each sensor
+ * read costs SIM_CALL_US, delay() jumps ahead, and motors move the sensors they are linked to
+ * as time passes, speeding up and coasting down over about 80 ms. Tasks run cooperatively,
+ * with a task that does not delay being preempted once per simulated millisecond like the
+ * kernel's time slice.
+ *
+ * A project's test/ directory defines simScenarios[], a list of scenarios ending with a
+ * zeroed entry. harness.c runs each one from a fresh simulation and reports pass/fail,
+ * simulated time and sensor reads as JSON. With --replay it instead feeds a log saved from
+ * recordDump() (see record.h) back through initialize() and autonomous().
+ *
+ * This header must not include stdio.h; API.h defines its own FILE.
+ */
+
+#ifndef SIM_H_
+
+#define SIM_H_
+
+#include <API.h>
+
+/**
+ * Simulated time consumed by one sensor API call, in microseconds. Stands in for the cost of
+ * one pass of a tight polling loop.
+ */
+#define SIM_CALL_US 100
+/**
+ * Simulated time a scenario may take before it is failed as hung, in milliseconds.
+ */
+#define SIM_TIMEOUT_DEFAULT 60000
+
+/**
+ * One scripted scenario. timeout is in simulated milliseconds; 0 uses SIM_TIMEOUT_DEFAULT.
+ */
+typedef struct {
+	const char *name;
+	void (*run)(void);
+	unsigned long timeout;
+} SimScenario;
+
+/**
+ * Scenarios of the project under test, ending with an entry whose name is NULL. Projects
+ * without a test/ directory get an empty list from harness.c.
+ */
+extern const SimScenario simScenarios[];
+
+/**
+ * Records a failed check unless ok is true. Use SIM_CHECK().
+ */
+void simCheck(bool ok, const char *file, int line, const char *expr);
+#define SIM_CHECK(expr) simCheck((expr), __FILE__, __LINE__, #expr)
+
+/**
+ * Sets the value an analog channel reads until something changes it.
+ */
+void simSetAnalog(unsigned char channel, int value);
+/**
+ * Gets the current value of an analog channel.
+ */
+int simGetAnalog(unsigned char channel);
+/**
+ * Drives a digital input, firing any interrupt handler registered for the edge.
+ */
+void simSetDigital(unsigned char pin, bool value);
+/**
+ * Gets the level of a digital pin, including outputs written by the code under test.
+ */
+bool simGetDigital(unsigned char pin);
+/**
+ * Gets the last speed commanded on a motor port.
+ */
+int simGetMotor(unsigned char channel);
+/**
+ * Makes an analog channel follow a motor: at full speed it changes by rate per second,
+ * clamped to min..max. A negative rate makes positive motor speed lower the reading.
+ */
+void simLinkAnalog(unsigned char channel, unsigned char motor, int rate, int min, int max);
+/**
+ * Adds a steady motor speed to the one moving a linked analog channel, such as gravity pulling
+ * an arm down. A step function can change it with the reading.
+ */
+void simSetAnalogLoad(unsigned char channel, int load);
+/**
+ * Makes an IME count follow a motor: at full speed it counts rate per second. Its velocity
+ * reads in RPM of the internal motor, as on a high-torque IME with DRIVE_COUNTS_PER_REV counts
+ * a turn.
+ */
+void simLinkIme(unsigned char address, unsigned char motor, int rate);
+/**
+ * Gets the current count of an IME.
+ */
+int simGetIme(unsigned char address);
+/**
+ * Makes a quadrature encoder, by its top port, follow a motor: at full speed it counts rate per
+ * second. encoderInit() adds its reverse setting on top.
+ */
+void simLinkEncoder(unsigned char portTop, unsigned char motor, int rate);
+/**
+ * Gets the current count of a quadrature encoder by its top port, before any reversal.
+ */
+int simGetEncoder(unsigned char portTop);
+/**
+ * Sets the distance the ultrasonic sensors report.
+ */
+void simSetUltrasonic(int value);
+/**
+ * Sets a joystick axis (1-4, or ACCEL_X/ACCEL_Y) of joystick 1 or 2.
+ */
+void simSetJoystickAnalog(unsigned char joystick, unsigned char axis, int value);
+/**
+ * Sets the pressed buttons (JOY_* mask) of one button group of joystick 1 or 2.
+ */
+void simSetJoystickDigital(unsigned char joystick, unsigned char group, unsigned char buttons);
+/**
+ * Sets what isEnabled() returns; scenarios start enabled.
+ */
+void simSetEnabled(bool value);
+/**
+ * Sets the text getchar() reads from the programming cable, kept by reference. It returns -1
+ * once the text runs out.
+ */
+void simSetSerialInput(const char *text);
+/**
+ * Sets the pressed LCD buttons (LCD_BTN_* mask).
+ */
+void simSetLcdButtons(unsigned int buttons);
+/**
+ * Gets the text last set on line 1 or 2 of the LCD.
+ */
+const char *simGetLcdText(unsigned char line);
+/**
+ * Installs a function called every time simulated time advances, after motors have moved
+ * the linked sensors, so a scenario can model its environment (lines, switches, targets).
+ * It must only use the sim*() functions, not the API.
+ */
+void simSetStep(void (*step)(void));
+/**
+ * Gets the simulated time in microseconds.
+ */
+unsigned long long simMicros();
+/**
+ * Gets the number of sensor API calls made in the current scenario.
+ */
+unsigned long simReads();
+
+/**
+ * The recorded calls on one port of a recordDump() log, in order. failed is set for calls
+ * logged with an upper case kind.
+ */
+typedef struct {
+	char kind;
+	unsigned char port;
+	unsigned long count;
+	const int *values;
+	const bool *failed;
+} SimReplayPort;
+
+/**
+ * Answers every recorded kind of call the code under test makes from now on from the log
+ * instead of the model, the n-th call on each port with the n-th recorded result, and fails a
+ * check for each motor command that differs from the log. Using a port the log never recorded
+ * fails and ends the scenario. Running out of log on any port, or running for longer than the
+ * scenario timeout, ends the scenario without failing it.
+ */
+void simReplay(const SimReplayPort *ports, unsigned int count);
+/**
+ * Gets the number of calls answered from the log.
+ */
+unsigned long simReplayCalls();
+/**
+ * Gets the number of recorded calls the code under test has not made yet.
+ */
+unsigned long simReplayLeft();
+/**
+ * Gets the number of motor commands that differed from the log.
+ */
+unsigned int simReplayMismatches();
+
+/**
+ * Logs every call the model answers to the library's record log, as the recorders of a
+ * make RECORD=1 build do on the robot. Scenarios start with it off.
+ */
+void simRecord(bool on);
+/**
+ * Sends what the code under test prints to a file instead of the console log, e.g. to save a
+ * recordDump() for simReplayFile(). Provided by harness.c.
+ *
+ * @param path the file to write, or NULL to go back to the console log
+ * @return true if the file could be opened
+ */
+bool simLogTo(const char *path);
+/**
+ * Loads the last complete recordDump() log in a file and replays it from now on, as
+ * simReplay() does. Provided by harness.c.
+ *
+ * @return true if the file held a complete log
+ */
+bool simReplayFile(const char *path);
+
+/**
+ * Resets the simulation and runs one scenario to completion or timeout. Used by harness.c.
+ *
+ * @return true if the scenario finished without failed checks
+ */
+bool simRun(const SimScenario *scenario);
+/**
+ * Gets the failed checks of the last scenario, one per line. Used by harness.c.
+ */
+const char *simFailures();
+
+#endif
@@ -0,0 +1,60 @@
+# This file is included in the Makefile rules for each directory of the shared robot library
+# Compiler settings must match the common.mk of the projects that link the library
+
+DEVICE=VexCortex
+# Prefix for ARM tools (must be on the path)
+MCUPREFIX=arm-none-eabi-
+# Flags applied to the assembler and compiler command lines
+MCUAFLAGS=-mthumb -mcpu=cortex-m3 -mlittle-endian
+MCUCFLAGS=-mthumb -mcpu=cortex-m3 -mlittle-endian
+
+# Advanced options to select file names and targets
+ASMEXT=s
+CEXT=c
+CPPEXT=cpp
+HEXT=h
+INCLUDE=-I$(ROOT)/include -I$(ROOT)/src
+OUTNAME=librobot.a
+# Comparison of hal.h against hand-written C, and the sources it compiles
+HALCHECK=$(ROOT)/../tools/halcheck.sh
+HALCHECKSRC=$(ROOT)/../tools/halcheck
+
+# Set LTO=1 to build with link-time optimization
+LTO?=
+ifneq ($(LTO),)
+LTOFLAGS=-flto
+endif
+
+# Set ENCODERS=1 to take drive feedback from quadrature encoders instead of IMEs (see drive.h)
+ENCODERS?=
+ifneq ($(ENCODERS),)
+DRIVEFLAGS=-DDRIVE_ENCODERS
+endif
+
+# Set RECORD=1 to compile in the log for make replay (see record.h); a project's make passes it
+# on
+RECORD?=
+ifneq ($(RECORD),)
+RECORDDEFS=-DRECORD
+endif
+
+# Each combination of the options above builds in its own directory under bin, so switching
+# them never archives objects compiled for another; must match VARIANT in the projects' common.mk
+VARIANT:=arm$(if $(LTO),-lto)$(if $(ENCODERS),-encoders)$(if $(RECORD),-record)
+
+# Advanced flags for the compiler specifying optimization, warning, and error options
+AFLAGS:=$(MCUAFLAGS)
+ARFLAGS:=$(MCUCFLAGS)
+CCFLAGS:=-c -Wall $(MCUCFLAGS) -Os -ffunction-sections -fsigned-char -fomit-frame-pointer -fsingle-precision-constant -MMD -MP $(LTOFLAGS) $(DRIVEFLAGS) $(RECORDDEFS)
+CFLAGS:=$(CCFLAGS) -std=gnu99 -Werror=implicit-function-declaration
+CPPFLAGS:=$(CCFLAGS) -std=gnu++11 -fno-exceptions -fno-rtti -felide-constructors
+
+# Compiler cache to wrap the compilers with, e.g. make CCACHE=ccache (empty disables)
+CCACHE?=
+
+# Aliases to the tools used
+AR:=$(MCUPREFIX)$(if $(LTO),gcc-ar,ar)
+AS:=$(MCUPREFIX)as
+CC:=$(CCACHE) $(MCUPREFIX)gcc
+CPPCC:=$(CCACHE) $(MCUPREFIX)g++
+OBJDUMP:=$(MCUPREFIX)objdump
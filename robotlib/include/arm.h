@@ -0,0 +1,174 @@
+/** @file arm.h
+ * @brief Potentiometer-positioned arm with limit switches
+ *
+ * The arm pot reads high at the bottom of travel and low at the top. Call armInit() from
+ * initialize() with the robot's ports before using any other function in this file.
+ */
+
+#ifndef ARM_H_
+
+#define ARM_H_
+
+#include <API.h>
+#include <motor.h>
+#include <ramfunc.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Points in the gravity table of an ArmConfig.
+ */
+#define ARM_GRAVITY_POINTS 8
+/**
+ * Time between corrections of the arm hold controller in milliseconds.
+ */
+#define ARM_HOLD_MS 10
+/**
+ * armFault() bit set when the top limit switch closes.
+ */
+#define ARM_FAULT_TOP 0x01
+/**
+ * armFault() bit set when the bottom limit switch closes.
+ */
+#define ARM_FAULT_BOTTOM 0x02
+
+/**
+ * Ports and hold tuning of a pot-positioned arm. Motor group signs are set so positive is up.
+ * Limit switch pins read LOW while pressed; a pin of 0 means that switch is not fitted.
+ * idleSpeed is the small upwards power that stopArm() applies to hold the arm against gravity.
+ *
+ * armHold() adds a PID correction on the pot to the power that holds the arm still where it
+ * is. That power is read from gravity, ARM_GRAVITY_POINTS values spaced evenly from pot reading
+ * gravityTop to gravityBot and interpolated between; without a table it is idleSpeed. The
+ * gains are in thousandths of motor power per pot count (holdI per count every ARM_HOLD_MS,
+ * holdD per count of change in ARM_HOLD_MS).
+ *
+ * With oversample set the pot is read with oversampleGet(), so it must be one of the channels
+ * given to oversampleInit(). Targets stay in pot counts, but the hold and moves then work in
+ * its OVERSAMPLE_BITS finer units, and moveThresh, the distance from its target at which
+ * armMoveTo() counts as there, is in them too: 4 is one pot count. A moveThresh of 0 is 10 pot
+ * counts.
+ */
+typedef struct {
+	MotorGroup motors;
+	unsigned char pot;
+	unsigned char limitTop;
+	unsigned char limitBot;
+	int idleSpeed;
+	int holdP;
+	int holdI;
+	int holdD;
+	int gravityTop;
+	int gravityBot;
+	signed char gravity[ARM_GRAVITY_POINTS];
+	bool oversample;
+	int moveThresh;
+} ArmConfig;
+
+/**
+ * Sets the arm ports used by every other arm function. The limit switch pins must be
+ * interrupt capable (1-9 or 11-12): a switch closing stops the arm motors from its interrupt
+ * if they are driving into it, even while no code is watching the switch, and posts
+ * EVENT_LIMIT. Call after eventInit(), which would clear the arm's subscription.
+ *
+ * @param config the arm configuration, copied
+ */
+void armInit(const ArmConfig *config);
+/**
+ * Sets the arm motors. Positive is up. While a limit switch fault is latched the arm does not
+ * drive into that switch: down is refused at the bottom, and up at the top is limited to the
+ * largest power in the gravity table or idleSpeed, enough to rest on the switch.
+ *
+ * @param speed the new speed from -127 to 127
+ */
+void motorsArm(int speed);
+/**
+ * Gets the limit switch faults latched since they were last cleared. The arm hold task clears
+ * a fault on its own once its switch opens again.
+ *
+ * @return ARM_FAULT_TOP and ARM_FAULT_BOTTOM bits, 0 if neither is latched
+ */
+unsigned char armFault();
+/**
+ * Clears the latched faults of limit switches that are open again. A switch still pressed
+ * stays latched.
+ */
+void armClearFault();
+/**
+ * Holds the arm at idle speed against gravity, ending any armHold() or armMoveTo().
+ */
+void stopArm();
+/**
+ * Holds the arm at a pot position from a background task, reading the pot once every
+ * ARM_HOLD_MS. While the top limit switch is pressed the hold pushes up no harder than gravity
+ * needs, and while the bottom one is pressed it does not push down. Calling it again only
+ * moves the target.
+ *
+ * @param pos the pot reading to hold
+ */
+void armHold(int pos);
+/**
+ * Starts moving the arm to a pot position from the same background task as armHold() and
+ * returns at once. The arm runs at speed until it reaches the target, or a limit switch in
+ * the direction it is going, then holds there. armHold(), armRelease(), stopArm() and another
+ * armMoveTo() end the move early.
+ *
+ * @param pos the target pot reading
+ * @param speed valid range about 10 to 127; small values may not move the arm
+ */
+void armMoveTo(int pos, int speed);
+/**
+ * Checks whether an armMoveTo() is still under way.
+ *
+ * @return true until the arm reaches the target or the move is ended
+ */
+bool armMoving();
+/**
+ * Ends armHold() or armMoveTo() without touching the motors, so other code can drive the arm.
+ */
+void armRelease();
+/**
+ * Gets the power that holds the arm still at a pot position, from the gravity table. It runs
+ * from RAM.
+ *
+ * @param pos the pot reading
+ * @return the upwards power, -127 to 127
+ */
+RAMFUNC int armGravity(int pos);
+/**
+ * Gets the arm potentiometer reading, oversampled if the ArmConfig says so and rounded to
+ * whole pot counts. Lower is higher.
+ *
+ * @return the analog reading, 0 to 4095
+ */
+int armGetPos();
+/**
+ * Checks whether the arm is at the top of its travel.
+ *
+ * @return true if the top limit switch is pressed
+ */
+bool armAtTop();
+/**
+ * Checks whether the arm is at the bottom of its travel.
+ *
+ * @return true if the bottom limit switch is pressed
+ */
+bool armAtBottom();
+/**
+ * Moves the arm to the given pot position with armMoveTo() and sleeps until it gets there, woken
+ * by EVENT_ARM_SETTLED.
+ *
+ * @param pos the target pot reading
+ * @param speed valid range about 10 to 127; small values may not move the arm
+ */
+void armTo(int pos, int speed);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
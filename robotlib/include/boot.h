@@ -0,0 +1,62 @@
+/** @file boot.h
+ * @brief Start-up stages run side by side, with their times reported on the serial port
+ *
+ * Most of initialize() is waiting: IMEs being addressed, gyros and analog inputs being
+ * calibrated, the LCD menu waiting for a button. bootRun() gives each stage its own task so
+ * those waits overlap, and waits for all of them before it returns:
+ *
+ *     static const BootStage stages[] = {
+ *         { "calibration", loadCalibration, false },
+ *         { "subsystems", startSubsystems, true },
+ *         { "gyro", startGyro, false },
+ *         { "line", calibrateLine, false },
+ *     };
+ *     ...
+ *     bootRun(stages, 4);
+ *
+ * Stages that share a bus or a variable must not run at the same time; put a barrier between
+ * them with after.
+ */
+
+#ifndef BOOT_H_
+
+#define BOOT_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most stages bootRun() takes.
+ */
+#define BOOT_STAGES_MAX 8
+
+/**
+ * A start-up stage. name is printed with its time. With after set the stage starts only once
+ * every stage listed before it has finished; otherwise it starts with the one before it.
+ */
+typedef struct {
+	const char *name;
+	void (*run)();
+	bool after;
+} BootStage;
+
+/**
+ * Runs start-up stages, each in its own task at the caller's priority, and waits for them all.
+ * Prints how long each stage took, when it started and the total on the serial port.
+ *
+ * @param stages the stages, in order
+ * @param count the number of stages, at most BOOT_STAGES_MAX
+ * @return the total time in milliseconds
+ */
+unsigned long bootRun(const BootStage *stages, unsigned char count);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
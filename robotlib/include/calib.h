@@ -0,0 +1,75 @@
+/** @file calib.h
+ * @brief Calibration values kept in a reserved flash page and loaded at power up
+ *
+ * A project lists the values it measures on the robot (arm pot positions, line thresholds,
+ * ultrasonic distances) as CalibEntry items pointing into its own RAM struct, with the
+ * defaults filled in. calibInit() replaces the defaults with any values saved before, so the
+ * rest of the code just reads the struct.
+ *
+ * Values are changed with calibSet(), or captured from the live sensor on the LCD with
+ * calibLcd() or typed on the programming cable with calibSerial(). Each change is appended to
+ * the page named by the CALIBFLASH region in firmware/STM32F10x.ld, which is only erased when
+ * it fills up, about once every (256 - count) changes.
+ */
+
+#ifndef CALIB_H_
+
+#define CALIB_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A calibration value. name identifies the value in flash and on the LCD and serial port; it
+ * should not contain spaces and is shown up to 12 characters. read, if not NULL, measures the
+ * value live, e.g. armGetPos for an arm position.
+ */
+typedef struct {
+	const char *name;
+	int *value;
+	int (*read)();
+} CalibEntry;
+
+/**
+ * Loads the saved values over the defaults. Call from initialize() before the values are used.
+ *
+ * @param entries the values, kept for the other calibration functions
+ * @param count the number of values, at most 255
+ */
+void calibInit(const CalibEntry *entries, unsigned char count);
+/**
+ * Changes a value and saves it if it changed. Saving stalls the processor for about 120 us, or
+ * 20 ms more when the page has to be erased.
+ *
+ * @param index the index of the value in the entries given to calibInit()
+ * @param value the new value
+ * @return true if the value is saved
+ */
+bool calibSet(unsigned char index, int value);
+/**
+ * Lets values be captured from their sensors on the LCD. LEFT and RIGHT step through the
+ * values that have a read function, showing the saved value on line 1 and the live one on
+ * line 2; CENTER saves the live one. Returns once no button has been pressed for timeout
+ * milliseconds.
+ *
+ * @param lcdPort the LCD port, uart1 or uart2
+ * @param timeout the time to wait for a button in milliseconds
+ */
+void calibLcd(FILE *lcdPort, unsigned long timeout);
+/**
+ * Lets values be set from a terminal on the programming cable. Prints every value, then reads
+ * lines of "name value" to save a value, "name" to capture it from its sensor, or "list" to
+ * print them again, until an empty line.
+ */
+void calibSerial();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
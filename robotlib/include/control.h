@@ -0,0 +1,220 @@
+/** @file control.h
+ * @brief PID, feedforward and settle detection for any mechanism
+ *
+ * Controllers keep their state in a struct the caller owns, usually static, so nothing is
+ * allocated. Each has an integer version with gains in thousandths, which keeps to the
+ * Cortex's integer unit, and a Float version for gains that need more range.
+ *
+ *     static const PidGains liftGains = { 400, 8, 3000, 40, 127, 2 };
+ *     Pid liftPid;
+ *     Settle liftSettle;
+ *     int error;
+ *     ...
+ *     pidInit(&liftPid, &liftGains);
+ *     settleInit(&liftSettle, 15, 200);
+ *     do {
+ *         error = target - analogRead(LIFT_POT);
+ *         motorSet(LIFT, pidUpdate(&liftPid, error));
+ *         delay(10);
+ *     } while (!settleUpdate(&liftSettle, error));
+ */
+
+#ifndef CONTROL_H_
+
+#define CONTROL_H_
+
+#include <API.h>
+#include <ramfunc.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fraction bits of the filtered derivative of a Pid.
+ */
+#define PID_D_SHIFT 4
+
+/**
+ * Gains of a Pid, in thousandths of output: kP per unit of error, kI per unit of summed error
+ * (one error added each update) and kD per unit of change in error between updates.
+ *
+ * iMax is the most output the integral term may give; with kI of 0 there is no integral.
+ * outMax, if not 0, limits the output to +-outMax, and the integral stops growing while the
+ * output is held at the limit by error in the same direction, so it does not wind up.
+ * dFilter smooths the derivative: each update moves it 1 / 2^dFilter of the way to the new
+ * change in error, so 0 is no smoothing.
+ */
+typedef struct {
+	int kP;
+	int kI;
+	int kD;
+	int iMax;
+	int outMax;
+	unsigned char dFilter;
+} PidGains;
+
+/**
+ * State of an integer PID controller.
+ */
+typedef struct {
+	const PidGains *gains;
+	int integral;
+	int lastError;
+	// Change in error, with PID_D_SHIFT fraction bits
+	int derivative;
+	bool started;
+} Pid;
+
+/**
+ * Gains of a PidFloat, as for PidGains but in whole units of output. dAlpha is the part of
+ * the way the derivative moves to the new change in error each update, from 0 to 1; 1 is no
+ * smoothing.
+ */
+typedef struct {
+	float kP;
+	float kI;
+	float kD;
+	float iMax;
+	float outMax;
+	float dAlpha;
+} PidFloatGains;
+
+/**
+ * State of a floating point PID controller.
+ */
+typedef struct {
+	const PidFloatGains *gains;
+	float integral;
+	float lastError;
+	float derivative;
+	bool started;
+} PidFloat;
+
+/**
+ * Feedforward gains: kS is the output that just overcomes friction, given in the direction of
+ * travel, kV the thousandths of output per unit of velocity and kA per unit of acceleration.
+ */
+typedef struct {
+	int kS;
+	int kV;
+	int kA;
+} Feedforward;
+
+/**
+ * Feedforward gains as for Feedforward but in whole units of output.
+ */
+typedef struct {
+	float kS;
+	float kV;
+	float kA;
+} FeedforwardFloat;
+
+/**
+ * State of a settle detector, which reports when an error has stayed within tolerance for a
+ * time.
+ */
+typedef struct {
+	int tolerance;
+	unsigned long time;
+	unsigned long since;
+	bool inside;
+} Settle;
+
+/**
+ * Sets the gains of a PID controller and resets it.
+ *
+ * @param pid the controller
+ * @param gains the gains, kept by pointer so they can be tuned while it runs
+ */
+void pidInit(Pid *pid, const PidGains *gains);
+/**
+ * Clears the integral and derivative, as when the controller takes over from something else.
+ *
+ * @param pid the controller
+ */
+void pidReset(Pid *pid);
+/**
+ * Runs one update of a PID controller. Call at a steady rate; the gains are per update. It runs
+ * from RAM.
+ *
+ * @param pid the controller
+ * @param error the target less the measurement
+ * @return the output
+ */
+RAMFUNC int pidUpdate(Pid *pid, int error);
+
+/**
+ * Sets the gains of a floating point PID controller and resets it.
+ *
+ * @param pid the controller
+ * @param gains the gains, kept by pointer so they can be tuned while it runs
+ */
+void pidFloatInit(PidFloat *pid, const PidFloatGains *gains);
+/**
+ * Clears the integral and derivative of a floating point PID controller.
+ *
+ * @param pid the controller
+ */
+void pidFloatReset(PidFloat *pid);
+/**
+ * Runs one update of a floating point PID controller. Call at a steady rate.
+ *
+ * @param pid the controller
+ * @param error the target less the measurement
+ * @return the output
+ */
+float pidFloatUpdate(PidFloat *pid, float error);
+
+/**
+ * Gets the output that drives a mechanism at a velocity and acceleration without feedback.
+ *
+ * @param ff the gains
+ * @param velocity the wanted velocity; kS is added in its direction, or none when it is 0
+ * @param acceleration the wanted acceleration
+ * @return the output
+ */
+int feedforward(const Feedforward *ff, int velocity, int acceleration);
+/**
+ * Gets the feedforward output with floating point gains.
+ *
+ * @param ff the gains
+ * @param velocity the wanted velocity
+ * @param acceleration the wanted acceleration
+ * @return the output
+ */
+float feedforwardFloat(const FeedforwardFloat *ff, float velocity, float acceleration);
+
+/**
+ * Sets up a settle detector.
+ *
+ * @param settle the detector
+ * @param tolerance the largest error, either way, that counts as there
+ * @param time how long the error must stay within tolerance in milliseconds
+ */
+void settleInit(Settle *settle, int tolerance, unsigned long time);
+/**
+ * Checks an error against a settle detector. Call every update of the controller it watches.
+ *
+ * @param settle the detector
+ * @param error the target less the measurement
+ * @return true once the error has been within tolerance for the settle time
+ */
+bool settleUpdate(Settle *settle, int error);
+
+/**
+ * Times updates of each controller and prints the mean in microseconds and in processor cycles
+ * at 72 MHz on the serial port, then counts the cycles of pidUpdate() in RAM against the same
+ * code in flash.
+ *
+ * @param updates the number of updates to time each controller over
+ */
+void controlBench(unsigned int updates);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+/** @file coro.h
+ * @brief Stackless coroutines run side by side by one scheduler task
+ *
+ * Each task costs a stack of TASK_DEFAULT_STACK_SIZE words and there may only be TASK_MAX of
+ * them, too few to give every behavior its own. A coroutine is a function that returns to the
+ * scheduler whenever it waits and is called again every CORO_TICK_MS, carrying on from the
+ * line where it stopped. Its state is a Coro of a few bytes, so many can run at once: driving,
+ * the arm, the intake and watchdogs each as a coroutine.
+ *
+ *     static CoroStatus intakeBehavior(Coro *coro) {
+ *         CORO_BEGIN(coro);
+ *         intake();
+ *         CORO_DELAY(coro, 1500);
+ *         stopIntake();
+ *         CORO_END(coro);
+ *     }
+ *     ...
+ *     static Coro intakeCoro;
+ *     coroSpawn(&intakeCoro, intakeBehavior, NULL);
+ *
+ * The CORO_* macros jump back into the function with a switch, so local variables do not keep
+ * their values across a wait (keep them in the Coro's arg or make them static) and a switch
+ * must not wait in one of its cases. A coroutine that waits for another spawns it and then
+ * CORO_WAIT_UNTIL(coro, !coroRunning(&child)). Coroutines must not block: delay() or armTo()
+ * in one holds up all of them. coroBench() compares their cost with that of tasks.
+ */
+
+#ifndef CORO_H_
+
+#define CORO_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most coroutines running at once.
+ */
+#define CORO_MAX 16
+/**
+ * Time between runs of the coroutines in milliseconds.
+ */
+#define CORO_TICK_MS 5
+
+/**
+ * What a coroutine returns to the scheduler.
+ */
+typedef enum {
+	CORO_WAITING = 0,
+	CORO_DONE,
+} CoroStatus;
+
+typedef struct Coro Coro;
+
+/**
+ * The body of a coroutine, written between CORO_BEGIN() and CORO_END().
+ */
+typedef CoroStatus (*CoroFunction)(Coro *coro);
+
+/**
+ * State of a coroutine, owned by the caller and usually static.
+ */
+struct Coro {
+	CoroFunction function;
+	// Given to coroSpawn() for the coroutine's own use
+	void *arg;
+	// Time CORO_DELAY() waits for
+	unsigned long wake;
+	// Line to carry on from, 0 to start over
+	unsigned short line;
+	volatile bool running;
+};
+
+/**
+ * Starts the body of a coroutine.
+ */
+#define CORO_BEGIN(coro) switch ((coro)->line) { case 0:
+/**
+ * Ends the body of a coroutine, which is then done.
+ */
+#define CORO_END(coro) } (coro)->line = 0; return CORO_DONE
+/**
+ * Ends a coroutine early.
+ */
+#define CORO_EXIT(coro) do { (coro)->line = 0; return CORO_DONE; } while (0)
+/**
+ * Gives the other coroutines a turn, carrying on at the next tick.
+ */
+#define CORO_YIELD(coro) do { (coro)->line = __LINE__; return CORO_WAITING; \
+	case __LINE__:; } while (0)
+/**
+ * Waits until a condition is true, checking it every tick. It is checked once straight away.
+ */
+#define CORO_WAIT_UNTIL(coro, condition) do { (coro)->line = __LINE__; case __LINE__: \
+	if (!(condition)) return CORO_WAITING; } while (0)
+/**
+ * Waits for a time in milliseconds, to the next tick after it ends.
+ */
+#define CORO_DELAY(coro, ms) do { (coro)->wake = millis() + (ms); \
+	CORO_WAIT_UNTIL(coro, (long)(millis() - (coro)->wake) >= 0); } while (0)
+
+/**
+ * Clears the coroutines and starts the scheduler task that runs them. Call once from
+ * initialize().
+ */
+void coroInit();
+/**
+ * Starts a coroutine from the top. It first runs at the next tick. Any task may start one, and
+ * so may another coroutine. Requires coroInit().
+ *
+ * @param coro the coroutine's state; it must not be running already
+ * @param function the body
+ * @param arg a pointer for the body, left in coro->arg
+ * @return true if started, false if CORO_MAX coroutines are already running
+ */
+bool coroSpawn(Coro *coro, CoroFunction function, void *arg);
+/**
+ * Stops a coroutine where it is waiting. Whatever it was driving keeps going.
+ *
+ * @param coro the coroutine
+ */
+void coroStop(Coro *coro);
+/**
+ * Checks whether a coroutine is still running.
+ *
+ * @param coro the coroutine
+ * @return true until it ends or is stopped
+ */
+bool coroRunning(const Coro *coro);
+/**
+ * Runs every coroutine once, as the scheduler task does each tick.
+ */
+void coroRunAll();
+/**
+ * Prints the memory a coroutine and a task take and the time of a switch between two of each,
+ * in microseconds and in processor cycles at 72 MHz, on the serial port. Task switches are
+ * timed with semaphores passed between two tasks.
+ *
+ * @param switches the number of switches to time each over
+ */
+void coroBench(unsigned int switches);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
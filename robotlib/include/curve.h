@@ -0,0 +1,91 @@
+/** @file curve.h
+ * @brief Joystick response curves as lookup tables built by the compiler
+ *
+ * A curve is written as a macro of one joystick value x from -128 to 127, built from the
+ * shapes below, and turned into a 256-entry table with CURVE_TABLE():
+ *
+ *     #define DRIVE_CURVE(x) CURVE_EXPO(CURVE_DEADBAND(x, 10), 40)
+ *     static CURVE_TABLE(driveCurve, DRIVE_CURVE);
+ *     ...
+ *     driveTank(curveApply(driveCurve, joystickGetAnalog(1, 3)), ...);
+ *
+ * Every entry is a constant expression, so the compiler works the whole table out (floating
+ * point included) and places it in flash. Applying a curve is one indexed load; nothing is
+ * computed while driving.
+ */
+
+#ifndef CURVE_H_
+
+#define CURVE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * x with the band around zero cut out and the rest stretched back to full scale, so small
+ * stick offsets do not creep the motors and full stick is still full speed.
+ */
+#define CURVE_DEADBAND(x, band) ((x) > (band) ? ((x) - (band)) * 127.0 / (127 - (band)) : \
+	(x) < -(band) ? ((x) + (band)) * 127.0 / (127 - (band)) : 0.0)
+/**
+ * Blends x with its cube: percent 0 is linear and 100 is CURVE_CUBIC(). Higher values give
+ * finer control near the centre of the stick.
+ */
+#define CURVE_EXPO(x, percent) \
+	((x) * ((100 - (percent)) + (percent) * (x) * (x) / 16129.0) / 100.0)
+/**
+ * The cube of x, scaled so full stick is still full speed.
+ */
+#define CURVE_CUBIC(x) CURVE_EXPO(x, 100)
+/**
+ * Two straight lines meeting at (kneeIn, kneeOut) and mirrored for negative x, e.g. a slow
+ * range for lining up followed by a fast one.
+ */
+#define CURVE_PIECEWISE(x, kneeIn, kneeOut) ((x) >= 0 ? \
+	((x) <= (kneeIn) ? (x) * (double)(kneeOut) / (kneeIn) : \
+		(kneeOut) + ((x) - (kneeIn)) * (127.0 - (kneeOut)) / (127 - (kneeIn))) : \
+	((x) >= -(kneeIn) ? (x) * (double)(kneeOut) / (kneeIn) : \
+		-(kneeOut) + ((x) + (kneeIn)) * (127.0 - (kneeOut)) / (127 - (kneeIn))))
+
+/**
+ * Defines a curve table named name from a curve macro of one argument. Prefix with static to
+ * keep it in one file.
+ */
+#define CURVE_TABLE(name, curve) const signed char name[256] = { CURVE_256(curve, 0) }
+
+// Joystick value looked up at table index i: the index is the value's byte
+#define CURVE_IN(i) ((i) < 128 ? (i) : (i) - 256)
+// Rounded entry, limited to what a motor takes
+#define CURVE_OUT(v) ((v) >= 126.5 ? 127 : (v) <= -126.5 ? -127 : \
+	(signed char)((v) < 0 ? (v) - 0.5 : (v) + 0.5))
+#define CURVE_1(curve, i) CURVE_OUT(curve(CURVE_IN(i)))
+#define CURVE_4(curve, i) CURVE_1(curve, i), CURVE_1(curve, (i) + 1), \
+	CURVE_1(curve, (i) + 2), CURVE_1(curve, (i) + 3)
+#define CURVE_16(curve, i) CURVE_4(curve, i), CURVE_4(curve, (i) + 4), \
+	CURVE_4(curve, (i) + 8), CURVE_4(curve, (i) + 12)
+#define CURVE_64(curve, i) CURVE_16(curve, i), CURVE_16(curve, (i) + 16), \
+	CURVE_16(curve, (i) + 32), CURVE_16(curve, (i) + 48)
+#define CURVE_256(curve, i) CURVE_64(curve, i), CURVE_64(curve, (i) + 64), \
+	CURVE_64(curve, (i) + 128), CURVE_64(curve, (i) + 192)
+
+/**
+ * Shapes a joystick value with a curve table.
+ *
+ * @param curve a table defined with CURVE_TABLE()
+ * @param value the joystick value from -127 to 127
+ * @return the shaped value from -127 to 127
+ */
+static inline int curveApply(const signed char *curve, int value) {
+	return curve[(unsigned char)value];
+}
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
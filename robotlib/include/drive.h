@@ -0,0 +1,187 @@
+/** @file drive.h
+ * @brief Tank drive with IME or quadrature encoder feedback
+ *
+ * Drive routines shared by every robot with a left and a right side. Call driveInit() from
+ * initialize() with the robot's ports before using any other function in this file.
+ *
+ * Counts and velocities come from the IMEs unless the library and project are built with
+ * DRIVE_ENCODERS defined (make ENCODERS=1), when they come from quadrature encoders on the
+ * wheel axles instead. Encoder counts are scaled to IME counts, so distances are the same
+ * with either. driveBench() compares the two on a robot with both fitted.
+ */
+
+#ifndef DRIVE_H_
+
+#define DRIVE_H_
+
+#include <API.h>
+#include <motor.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Encoder counts per wheel revolution on a high-torque IME.
+ */
+#define DRIVE_COUNTS_PER_REV 620
+/**
+ * Turns of the motor inside a high-torque IME per turn of its output, in tenths: the IME's
+ * velocity is in RPM of that motor.
+ */
+#define DRIVE_IME_GEAR_TENTHS 392
+/**
+ * Counts per wheel revolution on a quadrature encoder.
+ */
+#define DRIVE_ENCODER_COUNTS_PER_REV 360
+/**
+ * Shortest time in milliseconds that encoder velocities are measured over.
+ */
+#define DRIVE_VELOCITY_MS 50
+
+/**
+ * Ports of a tank drive. Motor group signs are set so positive is forwards on both sides.
+ * A side's IME or encoder is reversed if it counts down while the side drives forwards; an
+ * encoder on the same side as an IME is expected to count the same way. Encoder ports of 0
+ * mean no encoders are fitted.
+ */
+typedef struct {
+	MotorGroup left;
+	MotorGroup right;
+	unsigned char imeLeft;
+	unsigned char imeRight;
+	bool imeLeftReversed;
+	bool imeRightReversed;
+	unsigned char encLeftTop;
+	unsigned char encLeftBottom;
+	unsigned char encRightTop;
+	unsigned char encRightBottom;
+} DriveConfig;
+
+/**
+ * How one feedback source performed in driveBench(). readUs is the mean time of one read;
+ * updateUs the mean time between reads that returned a new count, or 0 if it never changed.
+ * failed counts reads that got no answer.
+ */
+typedef struct {
+	unsigned long readUs;
+	unsigned long updateUs;
+	unsigned int failed;
+} DriveBenchResult;
+
+/**
+ * Sets the drive ports used by every other drive function.
+ *
+ * @param config the drive configuration, copied
+ */
+void driveInit(const DriveConfig *config);
+
+/**
+ * Sets the left side of the drive. Positive is forwards.
+ *
+ * @param speed the new speed from -127 to 127
+ */
+void motorsLeft(int speed);
+/**
+ * Sets the right side of the drive. Positive is forwards.
+ *
+ * @param speed the new speed from -127 to 127
+ */
+void motorsRight(int speed);
+/**
+ * Sets both sides of the drive at once, as with a tank drive joystick layout.
+ *
+ * @param left the new left speed from -127 to 127
+ * @param right the new right speed from -127 to 127
+ */
+void driveTank(int left, int right);
+/**
+ * Stops all drive motors.
+ */
+void driveStop();
+/**
+ * Stops all drive motors. Same as driveStop().
+ */
+void stopDrive();
+
+/**
+ * Resets both drive IMEs or encoders to zero.
+ */
+void clearEncoders();
+/**
+ * Gets both drive counts, corrected so forwards is positive on each side.
+ *
+ * @param left receives the left count
+ * @param right receives the right count
+ * @return true if both IMEs responded; always true with encoders
+ */
+bool driveGetCounts(int *left, int *right);
+/**
+ * Gets both drive velocities in counts of driveGetCounts() per second, forwards positive on
+ * each side. IMEs only report speed, in RPM of their internal motor, which is converted; the
+ * sign is taken from the direction each side was last driven. With encoders it is the change
+ * in counts since an earlier read of the counts at least DRIVE_VELOCITY_MS ago; if nothing has
+ * read them for a while this waits DRIVE_VELOCITY_MS to measure it.
+ *
+ * @param left receives the left velocity in counts per second
+ * @param right receives the right velocity in counts per second
+ * @return true if both IMEs responded; always true with encoders
+ */
+bool driveGetVelocity(int *left, int *right);
+/**
+ * Drives both sides at speed and reads the left IME and the left encoder back to back, reads
+ * times each, then stops. Prints and returns how long a read takes and how often the count
+ * changes. Run it with the wheels off the ground.
+ *
+ * @param speed the speed to drive at from -127 to 127
+ * @param reads the number of reads of each sensor
+ * @param ime receives the IME result
+ * @param encoder receives the encoder result
+ */
+void driveBench(int speed, unsigned int reads, DriveBenchResult *ime,
+	DriveBenchResult *encoder);
+
+/**
+ * Drives a set distance with straightness correction.
+ *
+ * @param dist distance to travel in encoder counts (DRIVE_COUNTS_PER_REV is one revolution);
+ * positive is forwards, negative back
+ * @param speed valid range 0 to 127, but small values may not move the robot
+ */
+void driveStraight(int dist, int speed);
+/**
+ * Drives until a front corner line sensor hits a line, then turns so that both are on it.
+ * Requires lineInit().
+ *
+ * @param forwards true drives the robot forwards to the line, false drives back
+ */
+void driveToLine(bool forwards);
+/**
+ * Turns approximately the given angle on the spot. Not precise, no angle correction.
+ *
+ * @param angle approximately in degrees; positive is left (CCW), negative is right (CW)
+ * @param speed from 0 to 127
+ * @param colour mirrors the turn when HIGH, so routines coded for the blue alliance (LOW)
+ * also run on red
+ */
+void driveTurn(int angle, int speed, bool colour);
+/**
+ * Applies a short reverse pulse proportional to the last wheel velocity, then stops.
+ */
+void driveBrake();
+/**
+ * Drives both sides at fixed speeds for a set time. For imprecise maneuvers.
+ *
+ * @param speedL the left speed from -127 to 127
+ * @param speedR the right speed from -127 to 127
+ * @param time the time to drive in milliseconds
+ */
+void driveDeadReckon(int speedL, int speedR, int time);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
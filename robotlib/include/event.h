@@ -0,0 +1,145 @@
+/** @file event.h
+ * @brief Events posted by sensors and subsystems for tasks to block on
+ *
+ * Rather than poll for a line, a limit switch or the arm reaching its target, a task subscribes
+ * to the types of event it cares about and sleeps in eventWait() until one is posted. Nothing
+ * is allocated but one semaphore per subscriber.
+ *
+ * Each type must have a single producer, a task or an interrupt, which is what lets posting
+ * go without locks. The library posts EVENT_LIMIT from the arm's limit switch interrupt and
+ * EVENT_ARM_SETTLED from its hold task. Types from EVENT_USER up are for projects, posted with
+ * eventPost() or by the EventWatch sampler started by eventInit().
+ *
+ *     static EventQueue lineEvents;
+ *     Event event;
+ *     ...
+ *     eventSubscribe(&lineEvents, EVENT_MASK(EVENT_LINE_LEFT) | EVENT_MASK(EVENT_LINE_RIGHT));
+ *     driveDeadReckon(30, 30, 0);
+ *     if (eventWait(&lineEvents, &event, 2000))
+ *         ...
+ *     eventUnsubscribe(&lineEvents);
+ */
+
+#ifndef EVENT_H_
+
+#define EVENT_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Event types posted by the library; projects number theirs from EVENT_USER.
+ */
+typedef enum {
+	// An arm limit switch closed; the value is ARM_FAULT_TOP or ARM_FAULT_BOTTOM
+	EVENT_LIMIT = 0,
+	// An armMoveTo() reached its target or a limit switch; the value is the pot reading
+	EVENT_ARM_SETTLED,
+	EVENT_USER,
+} EventType;
+
+/**
+ * Number of event types, library and project together.
+ */
+#define EVENT_TYPES 16
+/**
+ * Most queues subscribed at once.
+ */
+#define EVENT_SUBSCRIBERS_MAX 8
+/**
+ * Most sensors watched by the sampler.
+ */
+#define EVENT_WATCHES_MAX 8
+/**
+ * Time between samples of the watched sensors in milliseconds.
+ */
+#define EVENT_SAMPLE_MS 2
+/**
+ * Bit of an event type in a subscription mask.
+ */
+#define EVENT_MASK(type) (1U << (type))
+
+/**
+ * An event as taken from a queue. Posts of one type that a subscriber has not yet taken are
+ * merged: value and time are of the latest and count says how many there were.
+ */
+typedef struct {
+	unsigned char type;
+	int value;
+	unsigned long time;
+	unsigned int count;
+} Event;
+
+/**
+ * A subscriber's view of the bus, owned by the caller. It must start zeroed, as a static one
+ * does, and keeps its semaphore between subscriptions.
+ */
+typedef struct {
+	unsigned int mask;
+	// Posts of each type already taken
+	unsigned int seen[EVENT_TYPES];
+	Semaphore signal;
+} EventQueue;
+
+/**
+ * A sensor for the sampler task: while anyone subscribes to type, read() is called every
+ * EVENT_SAMPLE_MS and the event is posted, with the reading, when it comes into low to high.
+ * A reading already inside when the first subscriber arrives is posted too.
+ */
+typedef struct {
+	unsigned char type;
+	int (*read)();
+	int low;
+	int high;
+} EventWatch;
+
+/**
+ * Clears all subscriptions and starts the sampler task on a list of watches. Call once from
+ * initialize(), before the subsystems that subscribe.
+ *
+ * @param watches the watches, kept by pointer so their windows can be set after calibration
+ * @param count the number of watches, at most EVENT_WATCHES_MAX; 0 starts no task
+ */
+void eventInit(const EventWatch *watches, unsigned char count);
+/**
+ * Subscribes a queue to some event types, or changes the types of a queue already subscribed.
+ * Only events posted from here on are taken from it.
+ *
+ * @param queue the queue
+ * @param mask the EVENT_MASK() bits of the types wanted
+ * @return true if subscribed, false if EVENT_SUBSCRIBERS_MAX queues already are
+ */
+bool eventSubscribe(EventQueue *queue, unsigned int mask);
+/**
+ * Stops posting to a queue.
+ *
+ * @param queue the queue
+ */
+void eventUnsubscribe(EventQueue *queue);
+/**
+ * Posts an event to every queue subscribed to its type. May be called from an interrupt.
+ *
+ * @param type the event type, below EVENT_TYPES
+ * @param value a value for the subscribers, depending on the type
+ */
+void eventPost(unsigned char type, int value);
+/**
+ * Takes the oldest event waiting in a queue, sleeping until one is posted if there is none.
+ *
+ * @param queue the queue
+ * @param event where to put the event, or NULL
+ * @param timeout the most time to sleep in milliseconds
+ * @return true if an event was taken, false if the time ran out
+ */
+bool eventWait(EventQueue *queue, Event *event, unsigned long timeout);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+/** @file filter.h
+ * @brief Integer filters for noisy sensor readings
+ *
+ * Each filter keeps its state in a struct the caller owns and takes one integer sample per
+ * update, such as an analogRead() or encoderGet() value, returning the filtered value. They
+ * trade noise for lag differently:
+ *
+ * - AverageFilter: mean of the last few samples; lags half its window.
+ * - MedianFilter: middle of the last few samples; throws out single spikes entirely.
+ * - EmaFilter: exponential moving average; one shift per sample, lag set by the shift.
+ * - BiquadFilter: second order Butterworth low-pass; sharper cut of noise above its cutoff.
+ * - KalmanFilter: steady value with a noise model; weighs new samples by how much the value
+ *   is expected to move against how noisy the sensor is.
+ *
+ * Samples may be up to +-65535 (an ADC reading, or an encoder count within that range).
+ * filterBench() prints the cost of a sample of each.
+ */
+
+#ifndef FILTER_H_
+
+#define FILTER_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Largest window of an AverageFilter.
+ */
+#define FILTER_AVERAGE_MAX 16
+/**
+ * Largest window of a MedianFilter.
+ */
+#define FILTER_MEDIAN_MAX 9
+/**
+ * Fraction bits kept in the state of the EMA, biquad and Kalman filters.
+ */
+#define FILTER_FRAC 8
+
+/**
+ * Mean of the last size samples.
+ */
+typedef struct {
+	int samples[FILTER_AVERAGE_MAX];
+	long sum;
+	unsigned char size;
+	unsigned char count;
+	unsigned char next;
+} AverageFilter;
+
+/**
+ * Median of the last size samples.
+ */
+typedef struct {
+	int samples[FILTER_MEDIAN_MAX];
+	unsigned char size;
+	unsigned char count;
+	unsigned char next;
+} MedianFilter;
+
+/**
+ * Exponential moving average, moving 1 / 2^shift of the way to each sample.
+ */
+typedef struct {
+	long value;
+	unsigned char shift;
+	bool started;
+} EmaFilter;
+
+/**
+ * Second order IIR filter. Coefficients have FILTER_BIQUAD_BITS fraction bits.
+ */
+typedef struct {
+	long b0, b1, b2, a1, a2;
+	int x1, x2;
+	long y1, y2;
+	bool started;
+} BiquadFilter;
+
+/**
+ * Fraction bits of BiquadFilter coefficients.
+ */
+#define FILTER_BIQUAD_BITS 14
+
+/**
+ * One-dimensional Kalman filter of a value that wanders by processNoise (a variance, in
+ * squared sample units) between samples, read by a sensor with variance measurementNoise.
+ */
+typedef struct {
+	long estimate;
+	long variance;
+	long processNoise;
+	long measurementNoise;
+	bool started;
+} KalmanFilter;
+
+/**
+ * Sets up a moving average.
+ *
+ * @param filter the filter
+ * @param size the number of samples averaged, from 1 to FILTER_AVERAGE_MAX
+ */
+void averageInit(AverageFilter *filter, unsigned char size);
+/**
+ * Adds a sample to a moving average. Until the window fills it averages the samples so far.
+ *
+ * @param filter the filter
+ * @param sample the new sample
+ * @return the mean, rounded
+ */
+int averageUpdate(AverageFilter *filter, int sample);
+
+/**
+ * Sets up a running median.
+ *
+ * @param filter the filter
+ * @param size the number of samples, odd, from 1 to FILTER_MEDIAN_MAX
+ */
+void medianInit(MedianFilter *filter, unsigned char size);
+/**
+ * Adds a sample to a running median. Until the window fills it takes the median so far.
+ *
+ * @param filter the filter
+ * @param sample the new sample
+ * @return the median
+ */
+int medianUpdate(MedianFilter *filter, int sample);
+
+/**
+ * Sets up an exponential moving average. The first sample is taken as is.
+ *
+ * @param filter the filter
+ * @param shift the smoothing, from 0 (none) to 8; a step is 63% through after about 2^shift
+ * samples
+ */
+void emaInit(EmaFilter *filter, unsigned char shift);
+/**
+ * Adds a sample to an exponential moving average.
+ *
+ * @param filter the filter
+ * @param sample the new sample
+ * @return the average, rounded
+ */
+int emaUpdate(EmaFilter *filter, int sample);
+
+/**
+ * Sets up a Butterworth low-pass filter. The first sample fills its history.
+ *
+ * @param filter the filter
+ * @param cutoffHz the frequency above which the signal is cut, below half of sampleHz
+ * @param sampleHz the rate that samples will be added at
+ */
+void biquadLowPass(BiquadFilter *filter, unsigned int cutoffHz, unsigned int sampleHz);
+/**
+ * Adds a sample to a biquad filter.
+ *
+ * @param filter the filter
+ * @param sample the new sample
+ * @return the filtered value, rounded
+ */
+int biquadUpdate(BiquadFilter *filter, int sample);
+
+/**
+ * Sets up a Kalman filter. The first sample is taken as is.
+ *
+ * @param filter the filter
+ * @param processNoise how far the true value moves between samples, as a variance; at least 1
+ * @param measurementNoise the variance of the sensor's noise
+ */
+void kalmanInit(KalmanFilter *filter, int processNoise, int measurementNoise);
+/**
+ * Adds a sample to a Kalman filter.
+ *
+ * @param filter the filter
+ * @param sample the new sample
+ * @return the estimate, rounded
+ */
+int kalmanUpdate(KalmanFilter *filter, int sample);
+
+/**
+ * Times samples through each filter and prints the mean in microseconds and in processor
+ * cycles at 72 MHz on the serial port.
+ *
+ * @param samples the number of samples to time each filter over
+ */
+void filterBench(unsigned int samples);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+/** @file flash.h
+ * @brief Data kept in the Cortex's program flash across power cycles
+ *
+ * The last 16 KB of the STM32F103's flash are left out of the program by the USERFLASH and
+ * CALIBFLASH regions in firmware/STM32F10x.ld. Variables declared with FLASH_USER are placed in
+ * the 14 KB of USERFLASH, which the route and the autonomous selector fill, and read like any
+ * other variable, but can only be changed with flashErase() and flashWrite(). The last page,
+ * CALIBFLASH, belongs to calib.h.
+ * They are not part of output.bin, so downloading new code leaves them alone as long as the
+ * loader only erases the pages it writes.
+ *
+ * Flash is erased in FLASH_PAGE_BYTES pages, to all 1 bits, and written a half-word at a
+ * time. The processor stalls while flash is busy: about 20 ms per page erased and 60 us per
+ * half-word written, so erase before a run rather than during it. Only one task may erase or
+ * write at a time.
+ */
+
+#ifndef FLASH_H_
+
+#define FLASH_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Size of a flash page, the smallest area that can be erased.
+ */
+#define FLASH_PAGE_BYTES 2048
+
+/**
+ * Places a variable in the kept flash, starting on a page. Declare it without an initializer
+ * and treat it as read-only, e.g. static unsigned char saved[FLASH_PAGE_BYTES] FLASH_USER;
+ */
+#define FLASH_USER __attribute__((section(".userflash"), aligned(FLASH_PAGE_BYTES)))
+
+/**
+ * Erases one page of kept flash to 0xFF bytes.
+ *
+ * @param page an address in the page, which must lie inside a FLASH_USER variable; the whole
+ * page from its start is erased
+ * @return true if the page reads back erased
+ */
+bool flashErase(void *page);
+/**
+ * Writes to erased kept flash. Bits can only be cleared, so each half-word can be written once
+ * after its page is erased.
+ *
+ * @param dest where to write, aligned to 2 bytes
+ * @param data the bytes to write
+ * @param bytes the number of bytes, a multiple of 2
+ * @return true if every half-word reads back as written
+ */
+bool flashWrite(void *dest, const void *data, unsigned int bytes);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
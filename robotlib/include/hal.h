@@ -0,0 +1,183 @@
+/** @file hal.h
+ * @brief Robot ports as C++ types that compile to the API.h calls they stand for
+ *
+ * For projects with C++ sources (.cpp files in src/). Each device is a type with its port as a
+ * template argument, so it takes no RAM and every call inlines to the plain API.h call with a
+ * constant port, the same code as the C with #define port numbers. make halcheck in robotlib
+ * compares the two. Ports out of range fail to compile, and so do devices sharing a port when
+ * they are listed together in distinct():
+ *
+ *     typedef hal::Motor<6> DriveLeft;
+ *     typedef hal::Motor<9, true> DriveRight;
+ *     typedef hal::AnalogIn<1> ArmPot;
+ *     typedef hal::DigitalIn<3> LimitTop;
+ *     static_assert(hal::distinct<DriveLeft, DriveRight, ArmPot, LimitTop>(),
+ *         "two devices share a port");
+ *     ...
+ *     DriveLeft::set(127);
+ *     if (ArmPot::read() > 2000 && LimitTop::read() == LOW)
+ *
+ * Requires C++11, which CPPFLAGS in common.mk selects.
+ */
+
+#ifndef HAL_H_
+
+#define HAL_H_
+
+#include <API.h>
+
+#ifdef __cplusplus
+
+namespace hal {
+
+/**
+ * Kinds of port. Devices of different kinds may have the same port number.
+ */
+enum PortKind { MOTOR_PORT, ANALOG_PORT, DIGITAL_PORT, IME_ADDRESS };
+
+/**
+ * A motor on ports 1 to 10. An inverted motor is mounted so a positive speed moves the
+ * mechanism backwards, and has its speeds negated.
+ */
+template<unsigned char Port, bool Inverted = false>
+struct Motor {
+	static_assert(Port >= 1 && Port <= 10, "motor ports are 1 to 10");
+	static constexpr PortKind kind = MOTOR_PORT;
+	static constexpr unsigned char port = Port;
+
+	/**
+	 * @param speed the new signed speed; -127 is full reverse and 127 is full forward
+	 */
+	static void set(int speed) {
+		motorSet(Port, Inverted ? -speed : speed);
+	}
+	/**
+	 * @return the last speed set, as passed to set()
+	 */
+	static int get() {
+		return Inverted ? -motorGet(Port) : motorGet(Port);
+	}
+	static void stop() {
+		motorStop(Port);
+	}
+};
+
+/**
+ * An analog input on channels 1 to 8.
+ */
+template<unsigned char Channel>
+struct AnalogIn {
+	static_assert(Channel >= 1 && Channel <= 8, "analog channels are 1 to 8");
+	static constexpr PortKind kind = ANALOG_PORT;
+	static constexpr unsigned char port = Channel;
+
+	/**
+	 * @return the reading from 0 to 4095
+	 */
+	static int read() {
+		return analogRead(Channel);
+	}
+	/**
+	 * Samples the input for about half a second to find its resting value.
+	 *
+	 * @return the resting value, from 0 to 4095
+	 */
+	static int calibrate() {
+		return analogCalibrate(Channel);
+	}
+	/**
+	 * @return the reading less its resting value, from -4095 to 4095
+	 */
+	static int readCalibrated() {
+		return analogReadCalibrated(Channel);
+	}
+};
+
+/**
+ * A digital input, such as a limit switch or bumper, on pins 1 to 12.
+ */
+template<unsigned char Pin>
+struct DigitalIn {
+	static_assert(Pin >= 1 && Pin <= 12, "digital pins are 1 to 12");
+	static constexpr PortKind kind = DIGITAL_PORT;
+	static constexpr unsigned char port = Pin;
+
+	/**
+	 * Sets the pin as an input. Call from initializeIO().
+	 */
+	static void init() {
+		pinMode(Pin, INPUT);
+	}
+	/**
+	 * @return HIGH or LOW; switches read LOW when pressed
+	 */
+	static bool read() {
+		return digitalRead(Pin);
+	}
+};
+
+/**
+ * An IME at an address from 0 to IME_ADDR_MAX. A reversed IME counts down while its mechanism
+ * moves forwards, and has its counts negated.
+ */
+template<unsigned char Address, bool Reversed = false>
+struct Ime {
+	static_assert(Address <= IME_ADDR_MAX, "IME addresses are 0 to IME_ADDR_MAX");
+	static constexpr PortKind kind = IME_ADDRESS;
+	static constexpr unsigned char port = Address;
+
+	/**
+	 * @param value receives the count
+	 * @return true if the IME responded
+	 */
+	static bool get(int *value) {
+		bool ok = imeGet(Address, value);
+
+		if (Reversed)
+			*value = -*value;
+		return ok;
+	}
+	/**
+	 * @param value receives the velocity, which like imeGetVelocity() has no direction
+	 * @return true if the IME responded
+	 */
+	static bool velocity(int *value) {
+		return imeGetVelocity(Address, value);
+	}
+	/**
+	 * @return true if the IME responded
+	 */
+	static bool reset() {
+		return imeReset(Address);
+	}
+};
+
+/**
+ * Whether A shares a port with any of Others.
+ */
+template<class A>
+constexpr bool sharesPort() {
+	return false;
+}
+template<class A, class B, class... Others>
+constexpr bool sharesPort() {
+	return (A::kind == B::kind && A::port == B::port) || sharesPort<A, Others...>();
+}
+
+/**
+ * Whether no two of the devices share a port. Use in a static_assert listing every device.
+ */
+template<class A>
+constexpr bool distinct() {
+	return true;
+}
+template<class A, class B, class... Others>
+constexpr bool distinct() {
+	return !sharesPort<A, B, Others...>() && distinct<B, Others...>();
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/** @file motor.h
+ * @brief Motor groups driven as one mechanism
+ *
+ * Most mechanisms on our robots are several motor ports wired to the same gearbox, some of
+ * them mounted backwards. A MotorGroup lists the ports and their directions once so the
+ * control code can command the mechanism with a single speed.
+ */
+
+#ifndef MOTOR_H_
+
+#define MOTOR_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Largest number of ports in one motor group.
+ */
+#define MOTOR_GROUP_MAX 4
+
+/**
+ * A set of motor ports that always move together.
+ *
+ * sign[i] is 1 if a positive speed on port[i] moves the mechanism in its positive direction
+ * (forwards, up) and -1 if the motor is mounted reversed.
+ */
+typedef struct {
+	unsigned char count;
+	unsigned char port[MOTOR_GROUP_MAX];
+	signed char sign[MOTOR_GROUP_MAX];
+} MotorGroup;
+
+/**
+ * Sets every motor in the group to the given speed, corrected for each motor's direction.
+ *
+ * @param group the motor group to drive
+ * @param speed the new signed speed; -127 is full reverse and 127 is full forward
+ */
+void motorGroupSet(const MotorGroup *group, int speed);
+/**
+ * Stops every motor in the group.
+ *
+ * @param group the motor group to stop
+ */
+void motorGroupStop(const MotorGroup *group);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+/** @file oversample.h
+ * @brief Analog inputs averaged at a fixed rate for extra resolution and less noise
+ *
+ * A background task reads each added channel every OVERSAMPLE_MS and keeps the sum of the
+ * last OVERSAMPLE_SAMPLES readings. Every OVERSAMPLE_BLOCK readings that sum, shifted down by
+ * OVERSAMPLE_BITS, is published: 16 samples of 12 bits give a 14-bit value, 0 to 16380, with
+ * the noise of one reading cut by 4. The extra bits are only real when the input has at least
+ * a count of noise to spread the readings, which the pot and line sensors on the Cortex do.
+ *
+ * The task's readings are left out of the log of record.h, so a replay answers
+ * oversampleGet() from the channel as it is on the host rather than from the log.
+ */
+
+#ifndef OVERSAMPLE_H_
+
+#define OVERSAMPLE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most channels that can be oversampled at once.
+ */
+#define OVERSAMPLE_CHANNELS_MAX 4
+/**
+ * Bits of resolution added: 4^OVERSAMPLE_BITS readings make one value.
+ */
+#define OVERSAMPLE_BITS 2
+/**
+ * Readings summed into one value.
+ */
+#define OVERSAMPLE_SAMPLES (1 << (2 * OVERSAMPLE_BITS))
+/**
+ * Readings between published values, so a new value comes every
+ * OVERSAMPLE_BLOCK * OVERSAMPLE_MS milliseconds.
+ */
+#define OVERSAMPLE_BLOCK 4
+/**
+ * Time between readings of each channel in milliseconds.
+ */
+#define OVERSAMPLE_MS 1
+
+/**
+ * Starts oversampling analog channels in a background task. Each channel's value is available
+ * once its first OVERSAMPLE_SAMPLES readings are taken; until then oversampleGet() reads it
+ * directly. Call from initialize(); a later call changes the channels the same task reads and
+ * starts their values over.
+ *
+ * @param channels the analog channels, 1 to 8
+ * @param count the number of channels, at most OVERSAMPLE_CHANNELS_MAX; 0 stops the readings of
+ * a running task, as for timing other reads, until a later call gives it channels again
+ */
+void oversampleInit(const unsigned char *channels, unsigned char count);
+/**
+ * Gets the oversampled value of a channel. A channel that is not oversampled is read once and
+ * scaled to match.
+ *
+ * @param channel the analog channel, 1 to 8
+ * @return the value, 0 to 4095 << OVERSAMPLE_BITS
+ */
+int oversampleGet(unsigned char channel);
+/**
+ * Gets the oversampled value of a channel rounded back to the range of analogRead(), as a
+ * less noisy drop-in for it.
+ *
+ * @param channel the analog channel, 1 to 8
+ * @return the value, 0 to 4095
+ */
+int oversampleRead(unsigned char channel);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
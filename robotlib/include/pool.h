@@ -0,0 +1,102 @@
+/** @file pool.h
+ * @brief Fixed-size block pools in static storage, with usage counters
+ *
+ * A pool hands out blocks of one size from an array fixed at build time, so objects made while
+ * the robot runs (controllers, event queues, log buffers) show up in the RAM map and cannot
+ * fragment the heap that task stacks come from. Each pool counts the blocks in use, the most
+ * ever in use and the allocations it had to refuse; poolReport() prints them all, so the
+ * arrays can be sized from what a match really needed.
+ *
+ *     POOL_STORAGE(logBlocks, LogBuffer, 4);
+ *     static Pool logPool;
+ *     ...
+ *     poolInit(&logPool, "log", logBlocks, sizeof(logBlocks[0]), 4);
+ *     LogBuffer *log = poolAlloc(&logPool);
+ *     ...
+ *     poolFree(&logPool, log);
+ */
+
+#ifndef POOL_H_
+
+#define POOL_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most pools that poolReport() lists.
+ */
+#define POOL_MAX 8
+/**
+ * Most blocks in one pool.
+ */
+#define POOL_BLOCKS_MAX 64
+
+/**
+ * Declares static storage for count blocks of a type, each aligned and large enough to hold
+ * the pool's link to the next free block.
+ */
+#define POOL_STORAGE(name, type, count) static union { type item; void *next; } name[count]
+
+/**
+ * A pool of blocks, owned by the caller and usually static. used, peak and failed may be read
+ * at any time.
+ */
+typedef struct {
+	const char *name;
+	unsigned char *storage;
+	unsigned int blockSize;
+	unsigned int count;
+	// Free blocks, each holding a pointer to the next
+	void *free;
+	// A bit for each block in use, so a block freed twice is only linked in once
+	unsigned long taken[POOL_BLOCKS_MAX / 32];
+	Mutex lock;
+	unsigned int used;
+	unsigned int peak;
+	unsigned int failed;
+} Pool;
+
+/**
+ * Sets up a pool with all its blocks free and adds it to poolReport(). Setting up a pool again
+ * frees its blocks and clears its counters.
+ *
+ * @param pool the pool
+ * @param name the name poolReport() gives it
+ * @param storage the blocks, usually from POOL_STORAGE()
+ * @param blockSize the size of one block in bytes, at least that of a pointer and a multiple
+ * of its alignment; a smaller one leaves the pool empty
+ * @param count the number of blocks, at most POOL_BLOCKS_MAX
+ */
+void poolInit(Pool *pool, const char *name, void *storage, unsigned int blockSize,
+	unsigned int count);
+/**
+ * Takes a free block from a pool. Its contents are left as they were.
+ *
+ * @param pool the pool
+ * @return the block, or NULL if all are in use
+ */
+void *poolAlloc(Pool *pool);
+/**
+ * Gives a block back to its pool. NULL, pointers that are not one of its blocks and blocks
+ * that are already free are ignored.
+ *
+ * @param pool the pool
+ * @param block the block
+ */
+void poolFree(Pool *pool, void *block);
+/**
+ * Prints the size, use, peak use and refusals of every pool on the serial port.
+ */
+void poolReport();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+/** @file pursuit.h
+ * @brief Odometry and a pure-pursuit path follower
+ *
+ * Odometry keeps a pose estimate in field units (inches here) from the drive counts, and from
+ * a gyro when one is fitted: x and y from where odomReset() put the robot, heading in radians
+ * counterclockwise from the x axis. It moves on each odomUpdate(), so something must call that
+ * while the robot moves; pursuitFollow() does every tick. The drive functions that clear the
+ * counts (driveStraight(), driveTurn(), clearEncoders()) throw it off, so reset the pose after
+ * them.
+ *
+ * The follower steers towards a goal point a lookahead distance further along a list of
+ * waypoints, on the arc that joins it to the robot, so one smooth motion replaces a chain of
+ * timed turns and drives. The lookahead grows with speed: short to follow tight corners slowly,
+ * long to stay steady fast. Power drops over the last slowDistance so it stops on the end.
+ *
+ *     static const Waypoint toGoal[] = { { 0, 0 }, { 24, 0 }, { 48, 24 } };
+ *     static const PursuitPath toGoalPath = { toGoal, 3, 100, 8, 20, 0.5f, 12, 2 };
+ *     ...
+ *     odomReset(0, 0, 0);
+ *     pursuitFollow(&toGoalPath, 4000);
+ */
+
+#ifndef PURSUIT_H_
+
+#define PURSUIT_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Time between updates of pursuitFollow() in milliseconds.
+ */
+#define PURSUIT_MS 10
+/**
+ * Least power pursuitFollow() slows to near the end of a path, so it does not stall short.
+ */
+#define PURSUIT_MIN_POWER 25
+
+/**
+ * How drive counts become distances. countsPerInch is counts of driveGetCounts() per inch of
+ * travel; trackWidth the distance between the left and right wheels in inches. With a gyro
+ * its heading is used rather than the difference of the two sides, which slip when turning;
+ * gyroReversed is set if it counts up turning clockwise.
+ */
+typedef struct {
+	float countsPerInch;
+	float trackWidth;
+	Gyro gyro;
+	bool gyroReversed;
+} OdomConfig;
+
+/**
+ * Where the robot is: x and y in inches, heading in radians counterclockwise from the x axis
+ * and speed in inches per second, forwards positive.
+ */
+typedef struct {
+	float x;
+	float y;
+	float heading;
+	float speed;
+} Pose;
+
+/**
+ * A point on a path, in inches.
+ */
+typedef struct {
+	float x;
+	float y;
+} Waypoint;
+
+/**
+ * A path and how to follow it. power is the motor power on straights, negative to drive the
+ * path backwards. The lookahead is lookaheadMin plus lookaheadGain inches per inch per second
+ * of speed, up to lookaheadMax. Power drops from slowDistance inches before the end, and the
+ * path is done within tolerance inches of it.
+ */
+typedef struct {
+	const Waypoint *points;
+	unsigned char count;
+	int power;
+	float lookaheadMin;
+	float lookaheadMax;
+	float lookaheadGain;
+	float slowDistance;
+	float tolerance;
+} PursuitPath;
+
+/**
+ * State of a path being followed.
+ */
+typedef struct {
+	const PursuitPath *path;
+	// Segment the robot was last nearest; it only moves on, so a path may cross itself
+	unsigned char segment;
+	bool done;
+} Pursuit;
+
+/**
+ * Sets how drive counts become distances and resets the pose to the origin. Call after
+ * driveInit() and, with a gyro, after gyroInit().
+ *
+ * @param config the odometry configuration, copied
+ */
+void odomInit(const OdomConfig *config);
+/**
+ * Puts the robot at a pose, taking the drive counts and gyro as they are now as the start.
+ *
+ * @param x the x position in inches
+ * @param y the y position in inches
+ * @param heading the heading in radians
+ */
+void odomReset(float x, float y, float heading);
+/**
+ * Moves the pose by the change in the drive counts and gyro since the last update. Call often
+ * while moving: each update takes the path since the last as a single arc.
+ */
+void odomUpdate();
+/**
+ * Gets the pose as of the last odomUpdate().
+ *
+ * @param pose receives the pose
+ */
+void odomGet(Pose *pose);
+
+/**
+ * Starts following a path from its first segment.
+ *
+ * @param pursuit the follower's state
+ * @param path the path, kept by pointer
+ */
+void pursuitStart(Pursuit *pursuit, const PursuitPath *path);
+/**
+ * Works out the wheel powers that steer the robot along the path. Call every control tick with
+ * a fresh pose.
+ *
+ * @param pursuit the follower's state
+ * @param pose where the robot is
+ * @param left receives the left power, -127 to 127
+ * @param right receives the right power, -127 to 127
+ * @return true once the robot is at the end, when both powers are 0
+ */
+bool pursuitUpdate(Pursuit *pursuit, const Pose *pose, int *left, int *right);
+/**
+ * Follows a path from wherever the odometry puts the robot, updating it every PURSUIT_MS, and
+ * stops the drive at the end.
+ *
+ * @param path the path
+ * @param timeout the most time to take in milliseconds
+ * @return true if the end was reached, false if the time ran out first
+ */
+bool pursuitFollow(const PursuitPath *path, unsigned long timeout);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
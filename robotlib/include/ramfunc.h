@@ -0,0 +1,53 @@
+/** @file ramfunc.h
+ * @brief Code run from RAM, and the cycle counter that shows whether it pays
+ *
+ * At 72 MHz the STM32F103 reads flash with two wait states, which its prefetch buffer only
+ * hides on straight runs of code. Functions declared RAMFUNC are put in the .RAMtext section,
+ * which firmware/cortex.ld places in .data, so the start-up code in libccos.a copies them to
+ * RAM along with the initialized variables. The library runs the PID update and the arm's
+ * gravity table from RAM.
+ *
+ * From RAM the Cortex-M3 fetches over the same bus as its data, so not every function gains:
+ * time it with cyclesGet() before moving it, as controlBench() does for pidUpdate(). Code in
+ * RAM takes that RAM from the heap and still takes the flash its copy is loaded from.
+ */
+
+#ifndef RAMFUNC_H_
+
+#define RAMFUNC_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runs a function from RAM. Calls to it are made by address, as RAM is too far from flash for
+ * a direct branch. On the host it only keeps the function out of line.
+ */
+#ifdef __arm__
+#define RAMFUNC __attribute__((section(".RAMtext"), noinline, long_call))
+#else
+#define RAMFUNC __attribute__((noinline))
+#endif
+
+/**
+ * Starts the processor's cycle counter (DWT CYCCNT). Safe to call again.
+ */
+void cyclesInit();
+/**
+ * Gets the processor's cycle count, which wraps every minute at 72 MHz. On the host it is
+ * derived from micros().
+ *
+ * @return the cycles since cyclesInit()
+ */
+unsigned long cyclesGet();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+/** @file record.h
+ * @brief Sensor and motor log for replaying a run on the host
+ *
+ * A project built with make RECORD=1 links its calls (and the library's) to analogRead(),
+ * digitalRead(), imeGet(), imeGetVelocity(), encoderGet(), ultrasonicGet(), millis(),
+ * motorSet() and motorStop() through recorders that log every result or command to RAM.
+ * Only calls that do not follow from the previous ones are stored: each port's results are
+ * predicted to keep changing by the same step as the last change, so polling loops cost
+ * nothing while their inputs hold still or move steadily (a clock, a drive at speed) and most
+ * other changes take 4 bytes. A pot sweeping through every reading fills the default log in
+ * about two seconds of movement, so stop recording soon after the run of interest.
+ * Recording starts at power on and stops at recordStop() or when the log is full.
+ *
+ * recordDump() prints the log on the serial port. Saving the terminal output to a file and
+ * running make replay LOG=file on the host feeds the recorded results back into the unmodified
+ * initialize() and autonomous(): the n-th call on a port gets what the n-th call on that port
+ * returned on the robot, and every motor command that differs from the log is reported.
+ *
+ * Replay is exact as long as each port is only used from one task. Without RECORD=1 the log
+ * is not built: these functions do nothing and take no RAM.
+ */
+
+#ifndef RECORD_H_
+
+#define RECORD_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bytes of RAM held for the log under RECORD=1. Most entries take 4 bytes, a port's first
+ * entry 12.
+ */
+#ifndef RECORD_BYTES
+#define RECORD_BYTES 12288
+#endif
+
+/**
+ * Kinds of recorded call, as printed by recordDump(). A failed imeGet() or imeGetVelocity()
+ * is logged with the upper case kind.
+ */
+#define RECORD_ANALOG 'a'
+#define RECORD_DIGITAL 'd'
+#define RECORD_IME 'i'
+#define RECORD_IME_FAILED 'I'
+#define RECORD_IME_VELOCITY 'v'
+#define RECORD_IME_VELOCITY_FAILED 'V'
+#define RECORD_ENCODER 'e'
+#define RECORD_ULTRASONIC 'u'
+#define RECORD_MILLIS 't'
+#define RECORD_MOTOR 'm'
+
+/**
+ * Clears the log and records again from now, e.g. at the top of autonomous() to keep only the
+ * autonomous run. A replay of it starts where it started, so the code must reach the same
+ * point on the host.
+ */
+void recordStart();
+/**
+ * Stops recording, keeping the log for recordDump(). Call it where the run of interest ends,
+ * e.g. at the top of operatorControl().
+ */
+void recordStop();
+/**
+ * Gets the number of calls recorded so far.
+ *
+ * @return the number of calls, including the ones that needed no entry
+ */
+unsigned int recordCount();
+/**
+ * Prints the log on the serial port for make replay. Takes about a second per 500 entries at
+ * 115200 baud.
+ *
+ * The format is a "record <bytes> <dropped>" line, one "<kind> <port> <gap> <value> <step>"
+ * line per entry and one "calls <kind> <port> <count>" line per port used, then an "end"
+ * line. gap counts the calls on the port since its previous entry that matched the
+ * prediction. value is "=<n>" for an absolute value or "+<n>"/"-<n>" relative to the
+ * prediction, and step is the change predicted for each call after it. dropped counts calls
+ * made after the log filled up.
+ */
+void recordDump();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
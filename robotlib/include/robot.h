@@ -0,0 +1,38 @@
+/** @file robot.h
+ * @brief Shared robot library
+ *
+ * Drive, arm, sensor, telemetry, recording, route, joystick curve, autonomous selector,
+ * calibration, start-up, controller, filter, oversampling, event, coroutine, memory pool, math,
+ * RAM code, path following and trajectory code reused by every project in the workspace.
+ * Projects link the bin/<variant>/librobot.a built with their options through LIBRARIES in
+ * their common.mk and include this header from main.h.
+ */
+
+#ifndef ROBOT_H_
+
+#define ROBOT_H_
+
+#include <motor.h>
+#include <drive.h>
+#include <arm.h>
+#include <sensors.h>
+#include <telemetry.h>
+#include <record.h>
+#include <flash.h>
+#include <route.h>
+#include <curve.h>
+#include <selector.h>
+#include <calib.h>
+#include <boot.h>
+#include <control.h>
+#include <filter.h>
+#include <oversample.h>
+#include <event.h>
+#include <coro.h>
+#include <pool.h>
+#include <robotmath.h>
+#include <ramfunc.h>
+#include <pursuit.h>
+#include <trajectory.h>
+
+#endif
@@ -0,0 +1,47 @@
+/** @file robotmath.h
+ * @brief Single precision math for path following and filter design
+ *
+ * The Cortex has no floating point unit, and libm's functions work in double precision, so
+ * the odometry and path followers of pursuit.h and the biquad design of filter.h use these
+ * instead. They are accurate to about a float's precision over the angles and distances a
+ * robot sees. Named robotmath.h so it does not hide the C library's math.h.
+ */
+
+#ifndef ROBOTMATH_H_
+
+#define ROBOTMATH_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Pi, as a float.
+ */
+#define MATH_PI 3.14159265f
+
+/**
+ * Gets the sine and cosine of an angle by their series.
+ *
+ * @param x the angle in radians, any number of turns from 0
+ * @param sine receives the sine
+ * @param cosine receives the cosine
+ */
+void mathSinCos(float x, float *sine, float *cosine);
+/**
+ * Gets a square root by Newton's method.
+ *
+ * @param x the number
+ * @return its square root, or 0 if it is not positive
+ */
+float mathSqrt(float x);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+/** @file route.h
+ * @brief Driver routes recorded from the joysticks and played back in autonomous
+ *
+ * routeRecordStart() samples both joysticks every ROUTE_TICK_MS, along with how far each
+ * drive side moved, and writes each tick's changes to kept flash (see flash.h) as it goes, so
+ * the last route survives power cycles. routePlay() feeds the samples back on the same ticks.
+ *
+ * Driver control code that reads the joysticks through routeJoystickAnalog() and
+ * routeJoystickDigital() gets the recorded values while a route plays and the live ones
+ * otherwise, so the same code drives the robot in both modes: autonomous() starts a route and
+ * runs one pass of the driver control loop at a time until routePlaying() turns false.
+ * Passing the drive speeds through routeCorrect() trims them towards the recorded wheel
+ * travel, making up for a low battery or a slipping wheel. Requires driveInit() and
+ * routeInit().
+ */
+
+#ifndef ROUTE_H_
+
+#define ROUTE_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Time between joystick samples in milliseconds. The joysticks update every 20 ms.
+ */
+#define ROUTE_TICK_MS 20
+/**
+ * Flash kept for the route, a multiple of FLASH_PAGE_BYTES. An idle tick costs nothing and a
+ * tick that moves one stick about 5 bytes, so the default holds well over a minute of driving.
+ */
+#ifndef ROUTE_BYTES
+#define ROUTE_BYTES 12288
+#endif
+/**
+ * Encoder counts of drive error that routeCorrect() turns into 1 of motor speed.
+ */
+#define ROUTE_CORRECT_DIV 4
+
+/**
+ * Sets up the lock the route functions and their task share. Call once from initialize(),
+ * before any other route function.
+ */
+void routeInit();
+/**
+ * Erases the saved route and starts recording a new one from the next joystick movement.
+ * Erasing stalls the processor for about 120 ms.
+ *
+ * @param maxTime the longest route to record in milliseconds, e.g. 15000 for autonomous; 0
+ * records until routeRecordStop() or the flash is full
+ * @return true if recording started
+ */
+bool routeRecordStart(unsigned long maxTime);
+/**
+ * Stops recording and saves the route for routePlay().
+ */
+void routeRecordStop();
+/**
+ * Gets whether a route is being recorded.
+ *
+ * @return true between routeRecordStart() and the end of the recording
+ */
+bool routeRecording();
+/**
+ * Starts playing the saved route.
+ *
+ * @param correct true to let routeCorrect() steer the drive towards the recorded wheel travel
+ * @return false if no route was saved
+ */
+bool routePlay(bool correct);
+/**
+ * Stops the route playing, returning the joysticks to live values.
+ */
+void routePlayStop();
+/**
+ * Gets whether a route is playing.
+ *
+ * @return true from routePlay() until the last recorded tick has passed
+ */
+bool routePlaying();
+/**
+ * Gets the length of the saved route.
+ *
+ * @return the length in milliseconds, or 0 if no route was saved
+ */
+unsigned long routeLength();
+/**
+ * Reads a joystick axis, from the route while one plays. Same as joystickGetAnalog() for axes
+ * 1 to 4; other axes always read live.
+ *
+ * @param joystick the joystick slot, 1 or 2
+ * @param axis the axis, 1 to 4
+ * @return the axis value from -127 to 127
+ */
+int routeJoystickAnalog(unsigned char joystick, unsigned char axis);
+/**
+ * Reads a joystick button, from the route while one plays. Same as joystickGetDigital().
+ *
+ * @param joystick the joystick slot, 1 or 2
+ * @param buttonGroup the button group, 5 to 8
+ * @param button one of JOY_UP, JOY_DOWN, JOY_LEFT or JOY_RIGHT
+ * @return true if the button is pressed
+ */
+bool routeJoystickDigital(unsigned char joystick, unsigned char buttonGroup,
+	unsigned char button);
+/**
+ * Adds a correction towards the recorded wheel travel to the drive speeds while a route plays
+ * with correction on. Leaves them alone otherwise.
+ *
+ * @param left the left speed, positive forwards, corrected in place
+ * @param right the right speed, positive forwards, corrected in place
+ */
+void routeCorrect(int *left, int *right);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
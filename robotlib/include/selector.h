@@ -0,0 +1,79 @@
+/** @file selector.h
+ * @brief Autonomous routine and alliance chosen on the VEX LCD
+ *
+ * selectorInit() runs from initialize(). It shows the alliance and then the routine on the LCD:
+ * LEFT and RIGHT change the choice and CENTER accepts it. The choice is saved in kept flash
+ * (see flash.h), so it survives power cycles and is used as it is when nobody touches the
+ * buttons. It is looked up once, when it is made, so autonomous() only has to call
+ * selectorRun():
+ *
+ *     static const SelectorRoutine routines[] = {
+ *         { "Score", autoScore },
+ *         { "Ram", autoRam },
+ *     };
+ *     ...
+ *     selectorInit(uart1, routines, 2, 5000);
+ */
+
+#ifndef SELECTOR_H_
+
+#define SELECTOR_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An autonomous routine that can be selected. name is shown on the LCD, up to 12 characters.
+ * run is called with true on the red alliance and false on the blue one.
+ */
+typedef struct {
+	const char *name;
+	void (*run)(bool red);
+} SelectorRoutine;
+
+/**
+ * Loads the saved choice, then lets it be changed on the LCD until CENTER accepts the routine,
+ * no button has been pressed for timeout milliseconds, or the robot is enabled. Saves the
+ * choice if it changed and leaves it on the LCD. A choice saved for a longer list than this
+ * one falls back to the first routine on the blue alliance.
+ *
+ * @param lcdPort the LCD port, uart1 or uart2
+ * @param routines the routines to choose from, kept for selectorRun()
+ * @param count the number of routines, 1 to 255
+ * @param timeout the time to wait for a button in milliseconds; 0 only loads the saved choice
+ */
+void selectorInit(FILE *lcdPort, const SelectorRoutine *routines, unsigned char count,
+	unsigned long timeout);
+/**
+ * Runs the selected routine with the selected alliance. Does nothing before selectorInit().
+ */
+void selectorRun();
+/**
+ * Gets the selected routine.
+ *
+ * @return the index into the routines given to selectorInit()
+ */
+unsigned char selectorRoutine();
+/**
+ * Gets the number of routines to choose from.
+ *
+ * @return the count given to selectorInit(), or 0 before it is called
+ */
+unsigned char selectorCount();
+/**
+ * Gets the selected alliance.
+ *
+ * @return true for red, false for blue
+ */
+bool selectorRed();
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
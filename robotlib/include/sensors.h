@@ -0,0 +1,60 @@
+/** @file sensors.h
+ * @brief Line sensor configuration and reading
+ *
+ * Line sensors read low over white tape and high over grey tiles. The threshold between the
+ * two is set once at startup so every routine agrees on what counts as a line.
+ */
+
+#ifndef SENSORS_H_
+
+#define SENSORS_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Analog ports of the two front corner line sensors and the reading below which a sensor is
+ * considered to be over a line.
+ */
+typedef struct {
+	unsigned char left;
+	unsigned char right;
+	int thresh;
+} LineConfig;
+
+/**
+ * Sets the line sensor ports and threshold used by lineRead*() and driveToLine().
+ *
+ * @param config the line sensor configuration, copied
+ */
+void lineInit(const LineConfig *config);
+/**
+ * Gets the raw value of the left line sensor.
+ *
+ * @return the analog reading, 0 to 4095
+ */
+int lineReadLeft();
+/**
+ * Gets the raw value of the right line sensor.
+ *
+ * @return the analog reading, 0 to 4095
+ */
+int lineReadRight();
+/**
+ * Checks whether a line sensor reading is over a line.
+ *
+ * @param value a reading from lineReadLeft() or lineReadRight()
+ * @return true if the reading is at or below the line threshold
+ */
+bool lineSeen(int value);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
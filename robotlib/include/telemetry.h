@@ -0,0 +1,39 @@
+/** @file telemetry.h
+ * @brief Sensor dumps over the serial port
+ *
+ * Prints the state of every configured drive, arm and line sensor so routines can be tuned
+ * from a terminal on the programming cable.
+ */
+
+#ifndef TELEMETRY_H_
+
+#define TELEMETRY_H_
+
+#include <API.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Prints one line with the arm position, drive IME counts, ultrasonic distance and line
+ * sensor readings. Subsystems that have not been initialized are left out.
+ *
+ * @param ult the ultrasonic sensor to read, or NULL if none is fitted
+ */
+void telemetryPrint(Ultrasonic ult);
+/**
+ * Prints telemetry forever at a fixed period. Never returns.
+ *
+ * @param ult the ultrasonic sensor to read, or NULL if none is fitted
+ * @param period the time between lines in milliseconds
+ */
+void telemetryRun(Ultrasonic ult, unsigned long period);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+/** @file trajectory.h
+ * @brief Drive trajectories planned on the host and played from tables in flash
+ *
+ * Planning a curved path with speed limits takes square roots and splines that a soft-float
+ * Cortex-M3 would rather not run between control updates, so tools/trajgen/trajgen.c does it
+ * on the host. From the waypoints and limits in a project's paths/<name>.path it writes
+ * src/<name>.c, a const table of where each drive side should be and how fast it should go
+ * every period, which stays in flash; make trajectories rebuilds the tables after a path
+ * changes. The project declares each one in main.h:
+ *
+ *     extern const Trajectory ramCurve;
+ *     static const TrajectoryGains gains = { { 10, 127, 20 }, 300 };
+ *     ...
+ *     trajectoryFollow(&ramCurve, &gains, colour);
+ *
+ * Following a table takes one feedforward and one proportional term a side each period, all
+ * in integers. It moves the drive counts under the odometry of pursuit.h, so reset the pose
+ * afterwards. Requires driveInit().
+ */
+
+#ifndef TRAJECTORY_H_
+
+#define TRAJECTORY_H_
+
+#include <API.h>
+#include <control.h>
+
+// Allow usage of this file in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Drive counts either side may be off the end of a table for trajectoryFollow() to call it
+ * reached.
+ */
+#define TRAJECTORY_TOLERANCE 50
+
+/**
+ * One entry of a table: the drive counts of each side from the start, and their speeds in
+ * counts per second.
+ */
+typedef struct {
+	int left;
+	int right;
+	short leftVelocity;
+	short rightVelocity;
+} TrajectoryPoint;
+
+/**
+ * A table and the milliseconds between its entries.
+ */
+typedef struct {
+	const TrajectoryPoint *points;
+	unsigned short count;
+	unsigned char period;
+} Trajectory;
+
+/**
+ * Gains of a trajectory follower: the feedforward of each side from its speed in counts per
+ * second and acceleration in counts per second squared, and kP thousandths of output per
+ * count it is behind.
+ */
+typedef struct {
+	Feedforward ff;
+	int kP;
+} TrajectoryGains;
+
+/**
+ * Gets how long a trajectory takes.
+ *
+ * @param trajectory the trajectory
+ * @return its time in milliseconds
+ */
+unsigned long trajectoryTime(const Trajectory *trajectory);
+/**
+ * Drives a trajectory from where the robot is, then stops the drive.
+ *
+ * @param trajectory the trajectory
+ * @param gains the follower's gains
+ * @param mirror true to swap the sides, mirroring the path left for right, as for the other
+ * alliance
+ * @return true if both sides ended within TRAJECTORY_TOLERANCE of the table's end
+ */
+bool trajectoryFollow(const Trajectory *trajectory, const TrajectoryGains *gains, bool mirror);
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+/** @file arm.c
+ * @brief Potentiometer-positioned arm with limit switches
+ */
+
+#include "internal.h"
+
+// Largest part of the hold power that may come from the integral term
+#define ARM_HOLD_I_MAX 40
+// A move ends this many pot counts from its target, unless the ArmConfig says otherwise
+#define ARM_MOVE_THRESH 10
+
+typedef enum {
+	ARM_FREE = 0,
+	ARM_MOVING,
+	ARM_HOLDING,
+} ArmState;
+
+static ArmConfig arm;
+bool armConfigured = false;
+// The hold task works in pot counts << armShift: OVERSAMPLE_BITS when oversampled, keeping the
+// bits that oversampleRead() would round away
+static unsigned char armShift;
+static volatile ArmState state;
+// Target of the move or hold, in pot counts << armShift
+static volatile int holdPos;
+// Power of the move, negative to move down
+static volatile int moveSpeed;
+// Power last sent to the arm motors, read by the limit switch interrupt
+static volatile int armPower;
+// ARM_FAULT_* bits latched by the limit switch interrupt
+static volatile unsigned char faults;
+// Most upwards power allowed while the top fault is latched: enough to rest on the switch
+static int restPower;
+// In pot counts << armShift
+static int moveThresh;
+// Wakes armTo() as a move ends
+static EventQueue armEvents;
+
+static int armClamp(int power) {
+	if (power > 127)
+		return 127;
+	if (power < -127)
+		return -127;
+	return power;
+}
+
+// Limits a speed to what the latched faults allow
+static int armAllowed(int speed) {
+	unsigned char latched = faults;
+
+	if ((latched & ARM_FAULT_TOP) && speed > restPower)
+		return restPower;
+	if ((latched & ARM_FAULT_BOTTOM) && speed < 0)
+		return 0;
+	return speed;
+}
+
+// Reads the pot in pot counts << armShift
+static int armGetPosFine() {
+	return arm.oversample ? oversampleGet(arm.pot) : analogRead(arm.pot);
+}
+
+// Rounds a position in pot counts << armShift back to pot counts
+static int armCoarse(int pos) {
+	return armShift ? (pos + (1 << (armShift - 1))) >> armShift : pos;
+}
+
+// Runs in the interrupt as a limit switch closes; keep it short. It stays in flash: the motor
+// stop and event post it makes are there anyway
+static void armLimitHit(unsigned char pin) {
+	if (pin == arm.limitTop) {
+		faults |= ARM_FAULT_TOP;
+		if (armPower > restPower) {
+			armPower = 0;
+			motorGroupStop(&arm.motors);
+		}
+		eventPost(EVENT_LIMIT, ARM_FAULT_TOP);
+	}
+	else if (pin == arm.limitBot) {
+		faults |= ARM_FAULT_BOTTOM;
+		if (armPower < 0) {
+			armPower = 0;
+			motorGroupStop(&arm.motors);
+		}
+		eventPost(EVENT_LIMIT, ARM_FAULT_BOTTOM);
+	}
+}
+
+static void armHoldTask(void *ignore) {
+	unsigned long wakeTime = millis();
+	//The error is in fine counts, so the output is scaled back and the integral may run longer
+	const PidGains gains = { arm.holdP, arm.holdI, arm.holdD, ARM_HOLD_I_MAX << armShift, 0, 0 };
+	int pos = 0, gravity, power;
+	bool wasHolding = false;
+	Pid pid;
+
+	pidInit(&pid, &gains);
+
+	while (1) {
+		//Switches are only polled while latched, to see them open again
+		if (faults)
+			armClearFault();
+		//The only pot read of the tick; lower is higher
+		if (state != ARM_FREE)
+			pos = armGetPosFine();
+		if (state == ARM_MOVING) {
+			if (moveSpeed > 0 ? pos <= holdPos + moveThresh : pos >= holdPos - moveThresh)
+				state = ARM_HOLDING;
+			else if (moveSpeed > 0 ? (faults & ARM_FAULT_TOP) : (faults & ARM_FAULT_BOTTOM)) {
+				//Stopped short by a limit switch: stay there
+				holdPos = pos;
+				state = ARM_HOLDING;
+			}
+			else
+				motorsArm(moveSpeed);
+			if (state == ARM_HOLDING)
+				eventPost(EVENT_ARM_SETTLED, armCoarse(pos));
+		}
+		if (state == ARM_HOLDING) {
+			if (!wasHolding)
+				pidReset(&pid);
+			gravity = armGravity(armCoarse(pos));
+			//A positive error needs up
+			power = gravity + pidUpdate(&pid, pos - holdPos) / (1 << armShift);
+			//Rest on a pressed limit switch rather than push into it
+			if (power > gravity && (faults & ARM_FAULT_TOP))
+				power = gravity;
+			motorsArm(armClamp(power));
+		}
+		wasHolding = state == ARM_HOLDING;
+		taskDelayUntil(&wakeTime, ARM_HOLD_MS);
+	}
+}
+
+void armInit(const ArmConfig *config) {
+	unsigned char i;
+
+	arm = *config;
+	armConfigured = true;
+	state = ARM_FREE;
+	armPower = 0;
+	restPower = arm.idleSpeed;
+	armShift = arm.oversample ? OVERSAMPLE_BITS : 0;
+	moveThresh = arm.moveThresh > 0 ? arm.moveThresh : ARM_MOVE_THRESH << armShift;
+	for (i = 0; i < ARM_GRAVITY_POINTS; i++)
+		if (arm.gravity[i] > restPower)
+			restPower = arm.gravity[i];
+	//A switch already closed raises no interrupt
+	faults = (armAtTop() ? ARM_FAULT_TOP : 0) | (armAtBottom() ? ARM_FAULT_BOTTOM : 0);
+	if (arm.limitTop)
+		ioSetInterrupt(arm.limitTop, INTERRUPT_EDGE_FALLING, armLimitHit);
+	if (arm.limitBot)
+		ioSetInterrupt(arm.limitBot, INTERRUPT_EDGE_FALLING, armLimitHit);
+	eventSubscribe(&armEvents, EVENT_MASK(EVENT_ARM_SETTLED));
+	taskCreate(armHoldTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+void motorsArm(int speed) {
+	speed = armAllowed(speed);
+	//Set first, so a switch closing from here on sees which way the arm is going
+	armPower = speed;
+	motorGroupSet(&arm.motors, speed);
+	//It may have closed while the motors were being set
+	if (armAllowed(speed) != speed) {
+		armPower = armAllowed(speed);
+		motorGroupSet(&arm.motors, armPower);
+	}
+}
+
+unsigned char armFault() {
+	return faults;
+}
+
+void armClearFault() {
+	unsigned char released = 0;
+
+	//Whatever is still pressed stays latched
+	if ((faults & ARM_FAULT_TOP) && !armAtTop())
+		released |= ARM_FAULT_TOP;
+	if ((faults & ARM_FAULT_BOTTOM) && !armAtBottom())
+		released |= ARM_FAULT_BOTTOM;
+	faults &= ~released;
+	//A switch that closed again meanwhile may have had its interrupt cleared with it
+	if ((released & ARM_FAULT_TOP) && armAtTop())
+		faults |= ARM_FAULT_TOP;
+	if ((released & ARM_FAULT_BOTTOM) && armAtBottom())
+		faults |= ARM_FAULT_BOTTOM;
+}
+
+void stopArm() {
+	state = ARM_FREE;
+	motorsArm(arm.idleSpeed);
+}
+
+void armHold(int pos) {
+	holdPos = pos << armShift;
+	state = ARM_HOLDING;
+}
+
+void armMoveTo(int pos, int speed) {
+	int currentPos = armGetPosFine();
+
+	pos <<= armShift;
+	if (currentPos - pos <= moveThresh && pos - currentPos <= moveThresh) {
+		holdPos = pos;
+		state = ARM_HOLDING;
+		return;
+	}
+	//Set the move up before the task can see it
+	state = ARM_FREE;
+	holdPos = pos;
+	moveSpeed = currentPos > pos ? speed : -speed;
+	state = ARM_MOVING;
+}
+
+bool armMoving() {
+	return state == ARM_MOVING;
+}
+
+void armRelease() {
+	state = ARM_FREE;
+}
+
+RAMFUNC int armGravity(int pos) {
+	int span = arm.gravityBot - arm.gravityTop;
+	int at, i, part;
+
+	if (span <= 0)
+		return arm.idleSpeed;
+	//Position along the table in units of span / (ARM_GRAVITY_POINTS - 1)
+	at = (pos - arm.gravityTop) * (ARM_GRAVITY_POINTS - 1);
+	if (at <= 0)
+		return arm.gravity[0];
+	if (at >= span * (ARM_GRAVITY_POINTS - 1))
+		return arm.gravity[ARM_GRAVITY_POINTS - 1];
+	i = at / span;
+	part = at % span;
+	return arm.gravity[i] + (arm.gravity[i + 1] - arm.gravity[i]) * part / span;
+}
+
+int armGetPos() {
+	return armCoarse(armGetPosFine());
+}
+
+bool armAtTop() {
+	return arm.limitTop && digitalRead(arm.limitTop) == LOW;
+}
+
+bool armAtBottom() {
+	return arm.limitBot && digitalRead(arm.limitBot) == LOW;
+}
+
+void armTo(int pos, int speed) {
+	armMoveTo(pos, speed);
+	//Woken as the move ends; the timeout notices one ended by stopArm() or armRelease()
+	while (armMoving())
+		eventWait(&armEvents, NULL, ARM_HOLD_MS * 5);
+}
@@ -0,0 +1,64 @@
+/** @file boot.c
+ * @brief Start-up stages run side by side, with their times reported on the serial port
+ */
+
+#include "internal.h"
+
+// Time between checks for finished stages in milliseconds
+#define BOOT_POLL_MS 2
+
+typedef struct {
+	const BootStage *stage;
+	unsigned long start;
+	unsigned long end;
+	volatile bool done;
+} BootSlot;
+
+static BootSlot slots[BOOT_STAGES_MAX];
+
+static void bootStage(BootSlot *slot) {
+	slot->start = millis();
+	slot->stage->run();
+	slot->end = millis();
+	slot->done = true;
+}
+
+static void bootTask(void *parameters) {
+	bootStage((BootSlot *)parameters);
+	taskDelete(NULL);
+}
+
+// Waits for the first count stages to finish
+static void bootWait(unsigned char count) {
+	unsigned char i;
+
+	for (i = 0; i < count; i++)
+		while (!slots[i].done)
+			delay(BOOT_POLL_MS);
+}
+
+unsigned long bootRun(const BootStage *stages, unsigned char count) {
+	unsigned int priority = taskPriorityGet(NULL);
+	unsigned long start = millis(), total;
+	unsigned char i;
+
+	if (count > BOOT_STAGES_MAX)
+		count = BOOT_STAGES_MAX;
+	for (i = 0; i < count; i++) {
+		if (stages[i].after)
+			bootWait(i);
+		slots[i].stage = &stages[i];
+		slots[i].done = false;
+		//No room for another task: run it here instead
+		if (!taskCreate(bootTask, TASK_DEFAULT_STACK_SIZE, &slots[i], priority))
+			bootStage(&slots[i]);
+	}
+	bootWait(count);
+	total = millis() - start;
+
+	for (i = 0; i < count; i++)
+		printf("boot: %s %lu ms, from %lu ms\r\n", stages[i].name, slots[i].end - slots[i].start,
+			slots[i].start - start);
+	printf("boot: ready in %lu ms\r\n", total);
+	return total;
+}
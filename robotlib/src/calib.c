@@ -0,0 +1,237 @@
+/** @file calib.c
+ * @brief Calibration values kept in a reserved flash page and loaded at power up
+ *
+ * The page holds 8-byte records one after another: a key made from the value's name, the value
+ * as two half-words, low first, and a check half-word. The last record of a key holds its
+ * value. When the page is full it is erased and the current value of every entry written back.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+
+// Key of an erased record
+#define KEY_FREE 0xFFFF
+// Time between reads of the LCD buttons in milliseconds
+#define CALIB_POLL_MS 20
+// Longest line calibSerial() reads
+#define LINE_MAX 32
+
+typedef struct {
+	unsigned short key;
+	unsigned short low;
+	unsigned short high;
+	unsigned short check;
+} CalibRecord;
+
+#define RECORDS (FLASH_PAGE_BYTES / sizeof(CalibRecord))
+
+// Placed on its own page by the CALIBFLASH region, so it stays put when other kept data moves
+static CalibRecord page[RECORDS] __attribute__((section(".calib"), aligned(FLASH_PAGE_BYTES)));
+
+static const CalibEntry *entries;
+static unsigned char entryCount;
+// Records in use
+static unsigned int used;
+
+// Hashes a name to a key that cannot be mistaken for an erased record
+static unsigned short calibKey(const char *name) {
+	unsigned long hash = 2166136261UL;
+
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619UL;
+	}
+	hash = (hash >> 16) ^ (hash & 0xFFFF);
+	return hash == KEY_FREE ? 0 : hash;
+}
+
+static unsigned short calibCheck(const CalibRecord *record) {
+	return ~(record->key + record->low + record->high);
+}
+
+static bool calibWrite(unsigned char index) {
+	CalibRecord record;
+	unsigned int value = *entries[index].value;
+
+	record.key = calibKey(entries[index].name);
+	record.low = value;
+	record.high = value >> 16;
+	record.check = calibCheck(&record);
+	if (!flashWrite(&page[used], &record, sizeof(record)))
+		return false;
+	used++;
+	return true;
+}
+
+// Starts the page again with the current values
+static bool calibCompact() {
+	unsigned char i;
+	bool ok;
+
+	ok = flashErase(page);
+	used = 0;
+	for (i = 0; ok && i < entryCount; i++)
+		ok = calibWrite(i);
+	return ok;
+}
+
+void calibInit(const CalibEntry *list, unsigned char count) {
+	unsigned short key;
+	unsigned int r;
+	unsigned char i;
+
+	entries = list;
+	entryCount = count;
+	for (used = 0; used < RECORDS && page[used].key != KEY_FREE; used++);
+	for (i = 0; i < count; i++) {
+		key = calibKey(entries[i].name);
+		for (r = 0; r < used; r++)
+			if (page[r].key == key && page[r].check == calibCheck(&page[r]))
+				*entries[i].value = page[r].low | ((unsigned long)page[r].high << 16);
+	}
+}
+
+bool calibSet(unsigned char index, int value) {
+	if (!entries || index >= entryCount)
+		return false;
+	if (*entries[index].value == value)
+		return true;
+	*entries[index].value = value;
+	if (used == RECORDS)
+		return calibCompact();
+	return calibWrite(index);
+}
+
+// Finds the next value with a read function after index, or index if there is none
+static unsigned char calibStep(unsigned char index, int direction) {
+	unsigned char i, next = index;
+
+	for (i = 0; i < entryCount; i++) {
+		next = (next + entryCount + direction) % entryCount;
+		if (entries[next].read)
+			return next;
+	}
+	return index;
+}
+
+void calibLcd(FILE *lcdPort, unsigned long timeout) {
+	unsigned int buttons, held, pressed;
+	unsigned long pressTime;
+	unsigned char index;
+	char name[13];
+
+	if (!entries || entryCount == 0)
+		return;
+	index = entries[0].read ? 0 : calibStep(0, 1);
+	if (!entries[index].read)
+		return;
+	lcdInit(lcdPort);
+	lcdSetBacklight(lcdPort, true);
+	held = lcdReadButtons(lcdPort);
+	pressTime = millis();
+	while (millis() - pressTime < timeout) {
+		strncpy(name, entries[index].name, sizeof(name) - 1);
+		name[sizeof(name) - 1] = '\0';
+		lcdPrint(lcdPort, 1, "%s %d", name, *entries[index].value);
+		lcdPrint(lcdPort, 2, "< %d >", entries[index].read());
+		delay(CALIB_POLL_MS);
+		buttons = lcdReadButtons(lcdPort);
+		pressed = buttons & ~held;
+		held = buttons;
+		if (!pressed)
+			continue;
+		pressTime = millis();
+		if (pressed & LCD_BTN_CENTER)
+			calibSet(index, entries[index].read());
+		else if (pressed & LCD_BTN_LEFT)
+			index = calibStep(index, -1);
+		else
+			index = calibStep(index, 1);
+	}
+	lcdClear(lcdPort);
+}
+
+static void calibList() {
+	unsigned char i;
+
+	for (i = 0; i < entryCount; i++) {
+		printf("%s %d", entries[i].name, *entries[i].value);
+		if (entries[i].read)
+			printf(" (now %d)", entries[i].read());
+		printf("\r\n");
+	}
+}
+
+// Reads a line without its ending; returns false at the end of input
+static bool calibReadLine(char *line) {
+	static bool afterCr = false;
+	unsigned int length = 0;
+	int c;
+
+	while (1) {
+		c = getchar();
+		if (c < 0)
+			return false;
+		//A CR LF pair ends one line, not two
+		if (c == '\n' && afterCr && length == 0) {
+			afterCr = false;
+			continue;
+		}
+		afterCr = c == '\r';
+		if (c == '\r' || c == '\n')
+			break;
+		if (length < LINE_MAX - 1)
+			line[length++] = c;
+	}
+	line[length] = '\0';
+	return true;
+}
+
+// Parses a decimal number with an optional sign; returns false if text is not one
+static bool calibParse(const char *text, int *value) {
+	bool negative = *text == '-';
+	int result = 0;
+
+	if (*text == '-' || *text == '+')
+		text++;
+	if (*text == '\0')
+		return false;
+	for (; *text; text++) {
+		if (*text < '0' || *text > '9')
+			return false;
+		result = result * 10 + (*text - '0');
+	}
+	*value = negative ? -result : result;
+	return true;
+}
+
+void calibSerial() {
+	char line[LINE_MAX];
+	char *argument;
+	unsigned char i;
+	int value;
+
+	if (!entries)
+		return;
+	calibList();
+	while (calibReadLine(line) && line[0] != '\0') {
+		if (strcmp(line, "list") == 0) {
+			calibList();
+			continue;
+		}
+		argument = strchr(line, ' ');
+		if (argument)
+			*argument++ = '\0';
+		for (i = 0; i < entryCount && strcmp(entries[i].name, line) != 0; i++);
+		if (i == entryCount)
+			printf("no value %s\r\n", line);
+		else if (argument ? !calibParse(argument, &value) : !entries[i].read)
+			printf("%s needs a number\r\n", line);
+		else {
+			if (!argument)
+				value = entries[i].read();
+			printf("%s %d %s\r\n", line, value, calibSet(i, value) ? "saved" : "not saved");
+		}
+	}
+}
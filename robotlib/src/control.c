@@ -0,0 +1,197 @@
+/** @file control.c
+ * @brief PID, feedforward and settle detection for any mechanism
+ */
+
+#include "internal.h"
+
+void pidInit(Pid *pid, const PidGains *gains) {
+	pid->gains = gains;
+	pidReset(pid);
+}
+
+void pidReset(Pid *pid) {
+	pid->integral = 0;
+	pid->derivative = 0;
+	pid->started = false;
+}
+
+// The PID update, built into pidUpdate() in RAM and into pidUpdateFlash() for controlBench()
+static inline __attribute__((always_inline)) int pidStep(Pid *pid, int error) {
+	const PidGains *gains = pid->gains;
+	int integral = pid->integral, integralMax, output;
+
+	//No change to differentiate on the first update
+	if (!pid->started) {
+		pid->lastError = error;
+		pid->started = true;
+	}
+	pid->derivative += ((error - pid->lastError) * (1 << PID_D_SHIFT) - pid->derivative) >>
+		gains->dFilter;
+	pid->lastError = error;
+
+	integral += error;
+	integralMax = gains->kI ? gains->iMax * 1000 / gains->kI : 0;
+	if (integralMax < 0)
+		integralMax = -integralMax;
+	if (integral > integralMax)
+		integral = integralMax;
+	if (integral < -integralMax)
+		integral = -integralMax;
+	output = (gains->kP * error + gains->kI * integral +
+		((gains->kD * pid->derivative) >> PID_D_SHIFT)) / 1000;
+
+	if (gains->outMax && (output > gains->outMax || output < -gains->outMax)) {
+		//Saturated: only let the integral move back towards zero
+		if ((output > 0) == (error > 0))
+			integral = pid->integral;
+		output = output > 0 ? gains->outMax : -gains->outMax;
+	}
+	pid->integral = integral;
+	return output;
+}
+
+RAMFUNC int pidUpdate(Pid *pid, int error) {
+	return pidStep(pid, error);
+}
+
+static __attribute__((noinline)) int pidUpdateFlash(Pid *pid, int error) {
+	return pidStep(pid, error);
+}
+
+void pidFloatInit(PidFloat *pid, const PidFloatGains *gains) {
+	pid->gains = gains;
+	pidFloatReset(pid);
+}
+
+void pidFloatReset(PidFloat *pid) {
+	pid->integral = 0;
+	pid->derivative = 0;
+	pid->started = false;
+}
+
+float pidFloatUpdate(PidFloat *pid, float error) {
+	const PidFloatGains *gains = pid->gains;
+	float integral = pid->integral, integralMax, output;
+
+	if (!pid->started) {
+		pid->lastError = error;
+		pid->started = true;
+	}
+	pid->derivative += (error - pid->lastError - pid->derivative) * gains->dAlpha;
+	pid->lastError = error;
+
+	integral += error;
+	integralMax = gains->kI != 0 ? gains->iMax / gains->kI : 0;
+	if (integralMax < 0)
+		integralMax = -integralMax;
+	if (integral > integralMax)
+		integral = integralMax;
+	if (integral < -integralMax)
+		integral = -integralMax;
+	output = gains->kP * error + gains->kI * integral + gains->kD * pid->derivative;
+
+	if (gains->outMax > 0 && (output > gains->outMax || output < -gains->outMax)) {
+		if ((output > 0) == (error > 0))
+			integral = pid->integral;
+		output = output > 0 ? gains->outMax : -gains->outMax;
+	}
+	pid->integral = integral;
+	return output;
+}
+
+int feedforward(const Feedforward *ff, int velocity, int acceleration) {
+	int output = (ff->kV * velocity + ff->kA * acceleration) / 1000;
+
+	if (velocity > 0)
+		output += ff->kS;
+	else if (velocity < 0)
+		output -= ff->kS;
+	return output;
+}
+
+float feedforwardFloat(const FeedforwardFloat *ff, float velocity, float acceleration) {
+	float output = ff->kV * velocity + ff->kA * acceleration;
+
+	if (velocity > 0)
+		output += ff->kS;
+	else if (velocity < 0)
+		output -= ff->kS;
+	return output;
+}
+
+void settleInit(Settle *settle, int tolerance, unsigned long time) {
+	settle->tolerance = tolerance;
+	settle->time = time;
+	settle->inside = false;
+}
+
+bool settleUpdate(Settle *settle, int error) {
+	unsigned long now = millis();
+
+	if (error > settle->tolerance || error < -settle->tolerance) {
+		settle->inside = false;
+		return false;
+	}
+	if (!settle->inside) {
+		settle->inside = true;
+		settle->since = now;
+	}
+	return now - settle->since >= settle->time;
+}
+
+// Times a PID update by the cycle counter, called through a pointer so both copies are alike
+static void controlBenchCycles(const char *name, int (*update)(Pid *, int),
+		const PidGains *gains, unsigned int updates) {
+	volatile int sink = 0;
+	unsigned long start;
+	unsigned int i;
+	Pid pid;
+
+	pidInit(&pid, gains);
+	start = cyclesGet();
+	for (i = 0; i < updates; i++)
+		sink += update(&pid, (int)(i & 255) - 128);
+	printf("bench: %s %lu cycles per update\r\n", name, (cyclesGet() - start) / updates);
+}
+
+void controlBench(unsigned int updates) {
+	static const PidGains gains = { 400, 8, 3000, 40, 127, 2 };
+	static const PidFloatGains floatGains = { 0.4f, 0.008f, 3.0f, 40.0f, 127.0f, 0.25f };
+	static const Feedforward ff = { 12, 90, 20 };
+	static const FeedforwardFloat ffFloat = { 12.0f, 0.09f, 0.02f };
+	// Outputs are summed here so the updates are not optimized away
+	volatile int sink = 0;
+	volatile float sinkFloat = 0;
+	unsigned long start;
+	unsigned int i;
+	Pid pid;
+	PidFloat pidFloat;
+
+	if (updates == 0)
+		updates = 1;
+	pidInit(&pid, &gains);
+	start = micros();
+	for (i = 0; i < updates; i++)
+		sink += pidUpdate(&pid, (int)(i & 255) - 128);
+	benchPrint("pid", micros() - start, updates, "update");
+	cyclesInit();
+	controlBenchCycles("pid in ram", pidUpdate, &gains, updates);
+	controlBenchCycles("pid in flash", pidUpdateFlash, &gains, updates);
+
+	pidFloatInit(&pidFloat, &floatGains);
+	start = micros();
+	for (i = 0; i < updates; i++)
+		sinkFloat += pidFloatUpdate(&pidFloat, (float)((int)(i & 255) - 128));
+	benchPrint("pid float", micros() - start, updates, "update");
+
+	start = micros();
+	for (i = 0; i < updates; i++)
+		sink += feedforward(&ff, (int)(i & 255) - 128, (int)(i & 15) - 8);
+	benchPrint("feedforward", micros() - start, updates, "update");
+
+	start = micros();
+	for (i = 0; i < updates; i++)
+		sinkFloat += feedforwardFloat(&ffFloat, (float)((int)(i & 255) - 128),
+			(float)((int)(i & 15) - 8));
+	benchPrint("feedforward float", micros() - start, updates, "update");
+}
@@ -0,0 +1,144 @@
+/** @file coro.c
+ * @brief Stackless coroutines run side by side by one scheduler task
+ */
+
+#include "internal.h"
+
+// Bytes in a stack word on the Cortex
+#define CORO_WORD_BYTES 4
+
+// Empty slots are NULL; a slot is only filled once its coroutine is set up
+static Coro * volatile coros[CORO_MAX];
+// Held while a slot is claimed or emptied, so two tasks spawning at once take different ones
+static Mutex slotLock;
+
+static void coroTask(void *ignore) {
+	unsigned long wakeTime = millis();
+
+	while (1) {
+		coroRunAll();
+		taskDelayUntil(&wakeTime, CORO_TICK_MS);
+	}
+}
+
+void coroInit() {
+	unsigned char i;
+
+	for (i = 0; i < CORO_MAX; i++)
+		coros[i] = NULL;
+	if (!slotLock)
+		slotLock = mutexCreate();
+	taskCreate(coroTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+}
+
+bool coroSpawn(Coro *coro, CoroFunction function, void *arg) {
+	unsigned char i;
+
+	coro->function = function;
+	coro->arg = arg;
+	coro->line = 0;
+	coro->running = true;
+	mutexTake(slotLock, WAIT_FOREVER);
+	for (i = 0; i < CORO_MAX; i++) {
+		if (!coros[i]) {
+			coros[i] = coro;
+			mutexGive(slotLock);
+			return true;
+		}
+	}
+	mutexGive(slotLock);
+	coro->running = false;
+	return false;
+}
+
+void coroStop(Coro *coro) {
+	unsigned char i;
+
+	coro->running = false;
+	mutexTake(slotLock, WAIT_FOREVER);
+	for (i = 0; i < CORO_MAX; i++)
+		if (coros[i] == coro)
+			coros[i] = NULL;
+	mutexGive(slotLock);
+}
+
+bool coroRunning(const Coro *coro) {
+	return coro->running;
+}
+
+void coroRunAll() {
+	unsigned char i;
+	Coro *coro;
+
+	for (i = 0; i < CORO_MAX; i++) {
+		coro = coros[i];
+		//One stopped by another earlier in this round is already out of its slot
+		if (coro && coro->running && coro->function(coro) == CORO_DONE)
+			coroStop(coro);
+	}
+}
+
+// Counts its turns in the int at arg
+static CoroStatus coroBenchCoro(Coro *coro) {
+	CORO_BEGIN(coro);
+	while (1) {
+		(*(volatile unsigned int *)coro->arg)++;
+		CORO_YIELD(coro);
+	}
+	CORO_END(coro);
+}
+
+// Passed between the two tasks of the bench
+static Semaphore benchPing, benchPong;
+static unsigned int benchRounds;
+
+static void coroBenchTask(void *ignore) {
+	unsigned int i;
+
+	for (i = 0; i < benchRounds; i++) {
+		semaphoreTake(benchPing, WAIT_FOREVER);
+		semaphoreGive(benchPong);
+	}
+	taskDelete(NULL);
+}
+
+void coroBench(unsigned int switches) {
+	volatile unsigned int turns = 0;
+	unsigned long start;
+	unsigned int i;
+	Coro a, b;
+
+	if (switches < 2)
+		switches = 2;
+	switches -= switches % 2;
+	printf("bench: coroutine %u bytes, task %u bytes of stack and its control block\r\n",
+		(unsigned int)sizeof(Coro), TASK_DEFAULT_STACK_SIZE * CORO_WORD_BYTES);
+
+	//Two coroutines taking turns, as the scheduler would run them
+	a.function = b.function = coroBenchCoro;
+	a.arg = b.arg = (void *)&turns;
+	a.line = b.line = 0;
+	start = micros();
+	for (i = 0; i < switches; i += 2) {
+		a.function(&a);
+		b.function(&b);
+	}
+	benchPrint("coroutine", micros() - start, switches, "switch");
+
+	//Two tasks taking turns: each round is a switch there and a switch back
+	benchPing = semaphoreCreate();
+	benchPong = semaphoreCreate();
+	//Both start taken, so each take waits for the other task's give
+	semaphoreTake(benchPing, 0);
+	semaphoreTake(benchPong, 0);
+	benchRounds = switches / 2;
+	taskCreate(coroBenchTask, TASK_MINIMAL_STACK_SIZE, NULL, taskPriorityGet(NULL));
+	start = micros();
+	for (i = 0; i < benchRounds; i++) {
+		semaphoreGive(benchPing);
+		semaphoreTake(benchPong, WAIT_FOREVER);
+	}
+	benchPrint("task", micros() - start, benchRounds * 2, "switch");
+	semaphoreDelete(benchPing);
+	semaphoreDelete(benchPong);
+}
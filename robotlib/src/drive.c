@@ -0,0 +1,311 @@
+/** @file drive.c
+ * @brief Tank drive with IME or quadrature encoder feedback
+ */
+
+#include "internal.h"
+
+// Age in milliseconds past which a velocity measurement no longer says how fast the drive is
+#define DRIVE_VELOCITY_STALE_MS (5 * DRIVE_VELOCITY_MS)
+
+static DriveConfig drive;
+// Last commanded speed of each side; IME velocity has no direction, so this supplies it
+static int lastLeft, lastRight;
+static Encoder encLeft, encRight;
+#ifdef DRIVE_ENCODERS
+// Counts and time of the start of the current velocity measurement
+static int sampleLeft, sampleRight;
+static unsigned long sampleTime;
+// Velocities from the last finished measurement, in counts per second, and when it finished
+static int velLeft, velRight;
+static unsigned long velTime;
+#endif
+bool driveConfigured = false;
+
+void driveInit(const DriveConfig *config) {
+	drive = *config;
+	if (drive.encLeftTop)
+		encLeft = encoderInit(drive.encLeftTop, drive.encLeftBottom, false);
+	if (drive.encRightTop)
+		encRight = encoderInit(drive.encRightTop, drive.encRightBottom, false);
+	driveConfigured = true;
+}
+
+void motorsLeft(int speed) {
+	lastLeft = speed;
+	motorGroupSet(&drive.left, speed);
+}
+
+void motorsRight(int speed) {
+	lastRight = speed;
+	motorGroupSet(&drive.right, speed);
+}
+
+void driveTank(int left, int right) {
+	motorsLeft(left);
+	motorsRight(right);
+}
+
+void driveStop() {
+	lastLeft = 0;
+	lastRight = 0;
+	motorGroupStop(&drive.left);
+	motorGroupStop(&drive.right);
+}
+
+void stopDrive() {
+	driveStop();
+}
+
+#ifdef DRIVE_ENCODERS
+
+void clearEncoders() {
+	encoderReset(encLeft);
+	encoderReset(encRight);
+	sampleLeft = 0;
+	sampleRight = 0;
+	sampleTime = millis();
+}
+
+// Scales an encoder count to IME counts, forwards positive
+static int driveEncoder(Encoder enc, bool reversed) {
+	int count = encoderGet(enc) * DRIVE_COUNTS_PER_REV / DRIVE_ENCODER_COUNTS_PER_REV;
+
+	return reversed ? -count : count;
+}
+
+bool driveGetCounts(int *left, int *right) {
+	unsigned long now = millis(), elapsed = now - sampleTime;
+
+	*left = driveEncoder(encLeft, drive.imeLeftReversed);
+	*right = driveEncoder(encRight, drive.imeRightReversed);
+	//Every read of the counts may finish a velocity measurement; one over a long gap would
+	//only give the average speed, so that starts a new one instead
+	if (elapsed >= DRIVE_VELOCITY_MS && elapsed <= DRIVE_VELOCITY_STALE_MS) {
+		velLeft = (*left - sampleLeft) * 1000L / (long)elapsed;
+		velRight = (*right - sampleRight) * 1000L / (long)elapsed;
+		velTime = now;
+	}
+	if (elapsed >= DRIVE_VELOCITY_MS) {
+		sampleLeft = *left;
+		sampleRight = *right;
+		sampleTime = now;
+	}
+	return true;
+}
+
+bool driveGetVelocity(int *left, int *right) {
+	int countL, countR;
+
+	driveGetCounts(&countL, &countR);
+	//Nothing has read the counts lately, so measure the speed now
+	if (millis() - velTime > DRIVE_VELOCITY_STALE_MS) {
+		delay(DRIVE_VELOCITY_MS);
+		driveGetCounts(&countL, &countR);
+	}
+	*left = velLeft;
+	*right = velRight;
+	return true;
+}
+
+#else
+
+void clearEncoders() {
+	imeReset(drive.imeLeft);
+	imeReset(drive.imeRight);
+}
+
+bool driveGetCounts(int *left, int *right) {
+	bool ok = imeGet(drive.imeLeft, left);
+	ok = imeGet(drive.imeRight, right) && ok;
+
+	if (drive.imeLeftReversed)
+		*left = -*left;
+	if (drive.imeRightReversed)
+		*right = -*right;
+	return ok;
+}
+
+bool driveGetVelocity(int *left, int *right) {
+	bool ok = imeGetVelocity(drive.imeLeft, left);
+	ok = imeGetVelocity(drive.imeRight, right) && ok;
+
+	//The IMEs give RPM of the motor inside the gearbox; make it counts per second of the wheel
+	*left = *left * DRIVE_COUNTS_PER_REV * 10 / (DRIVE_IME_GEAR_TENTHS * 60);
+	*right = *right * DRIVE_COUNTS_PER_REV * 10 / (DRIVE_IME_GEAR_TENTHS * 60);
+	if (lastLeft < 0)
+		*left = -*left;
+	if (lastRight < 0)
+		*right = -*right;
+	return ok;
+}
+
+#endif
+
+// Fills in a bench result from the reads and count changes of one sensor
+static void driveBenchResult(DriveBenchResult *result, const char *name, unsigned int reads,
+		unsigned long start, unsigned long end, unsigned int changes, unsigned long first,
+		unsigned long last) {
+	result->readUs = (end - start) / reads;
+	result->updateUs = changes > 1 ? (last - first) / (changes - 1) : 0;
+	printf("bench: %s %lu us per read, new count every %lu us, %u failed\r\n", name,
+		result->readUs, result->updateUs, result->failed);
+}
+
+void driveBench(int speed, unsigned int reads, DriveBenchResult *ime,
+		DriveBenchResult *encoder) {
+	unsigned long start, now, first = 0, last = 0;
+	unsigned int i, changes;
+	int value, previous;
+
+	if (reads == 0)
+		reads = 1;
+	driveTank(speed, speed);
+	//Let the drive reach speed first
+	delay(500);
+
+	ime->failed = 0;
+	changes = 0;
+	previous = 0;
+	imeGet(drive.imeLeft, &previous);
+	start = micros();
+	for (i = 0; i < reads; i++) {
+		if (!imeGet(drive.imeLeft, &value))
+			ime->failed++;
+		else if (value != previous) {
+			now = micros();
+			if (changes++ == 0)
+				first = now;
+			last = now;
+			previous = value;
+		}
+	}
+	driveBenchResult(ime, "ime", reads, start, micros(), changes, first, last);
+
+	encoder->failed = 0;
+	changes = 0;
+	previous = encoderGet(encLeft);
+	start = micros();
+	for (i = 0; i < reads; i++) {
+		value = encoderGet(encLeft);
+		if (value != previous) {
+			now = micros();
+			if (changes++ == 0)
+				first = now;
+			last = now;
+			previous = value;
+		}
+	}
+	driveBenchResult(encoder, "encoder", reads, start, micros(), changes, first, last);
+	driveStop();
+}
+
+void driveStraight(int dist, int speed) {
+	int countL;
+	int countR;
+	int speedAdj;
+
+	if (dist < 0) {
+		speed = -speed;
+	}
+	clearEncoders();
+	do {
+		driveGetCounts(&countL, &countR);
+		speedAdj = (countL - countR) * 1; //Speed adjustment factor
+
+		motorsLeft(speed - speedAdj);
+		motorsRight(speed + speedAdj);
+
+	} while ( (dist < 0 && (countL+countR)/2 > dist) || (dist > 0 && (countL+countR)/2 < dist));
+
+	stopDrive();
+}
+
+void driveToLine(bool forwards) {
+	int senseR, senseL;
+
+	int speedBack = -15;
+	int speed = 25;
+
+	if (!forwards) {
+		speed = -speed;
+		speedBack = -speedBack;
+	}
+
+	senseR = lineReadRight();
+	senseL = lineReadLeft();
+	while (!lineSeen(senseR) && !lineSeen(senseL)) {
+		senseR = lineReadRight();
+		senseL = lineReadLeft();
+		motorsRight(speed);
+		motorsLeft(speed);
+	}
+
+	if (lineSeen(senseR) && !lineSeen(senseL)) { //TODO Add feedback loop here
+		while (!lineSeen(senseL) && lineSeen(senseR)) { //Should correct overshoot
+			senseR = lineReadRight(); //Also, needs to bias towards direction it came from to not get lost
+			senseL = lineReadLeft();
+			motorsRight(speedBack); //TODO Add timeout for feedback loop
+			motorsLeft(speed);
+		}
+	}
+	else if (!lineSeen(senseR) && lineSeen(senseL)) {
+		while (!lineSeen(senseR) && lineSeen(senseL)) {
+			senseR = lineReadRight();
+			senseL = lineReadLeft();
+			motorsLeft(speedBack);
+			motorsRight(speed);
+		}
+	}
+	driveBrake();
+}
+
+void driveTurn(int angle, int speed, bool colour) {
+	int dist;
+	int countL, countR;
+	double degToEncoder = 2.5;
+
+	if (colour == HIGH) {
+		dist = -angle*degToEncoder;
+	}
+	else {
+		dist = angle*degToEncoder;
+	}
+
+	//Uses the encoder on the side driving forwards only
+	clearEncoders();
+	if (dist > 0) {
+		do {
+			driveGetCounts(&countL, &countR);
+			motorsRight(speed);
+			motorsLeft(-speed);
+		} while (countR < dist);
+	}
+	else {
+		do {
+			driveGetCounts(&countL, &countR);
+			motorsRight(-speed);
+			motorsLeft(speed);
+		} while (countL < -dist);
+	}
+}
+
+void driveBrake() {
+	int velL;
+	int velR;
+	//Power per count per second; .24 per internal RPM of the IMEs it was tuned with
+	double brakeConst = .91;
+
+	//If the IMEs do not answer, just stop dumbly
+	if (driveGetVelocity(&velL, &velR)) {
+		motorsLeft(-velL*brakeConst);
+		motorsRight(-velR*brakeConst);
+		delay(150);
+	}
+	stopDrive();
+}
+
+void driveDeadReckon(int speedL, int speedR, int time) {
+	motorsLeft(speedL);
+	motorsRight(speedR);
+	delay(time);
+}
@@ -0,0 +1,150 @@
+/** @file event.c
+ * @brief Events posted by sensors and subsystems for tasks to block on
+ */
+
+#include "internal.h"
+
+// Posts of each type so far; only the type's producer writes its entries
+static volatile unsigned int posted[EVENT_TYPES];
+static volatile int postedValue[EVENT_TYPES];
+static volatile unsigned long postedTime[EVENT_TYPES];
+// Empty slots are NULL so an interrupt posting meanwhile never sees a half-moved table
+static EventQueue * volatile subscribers[EVENT_SUBSCRIBERS_MAX];
+static const EventWatch *watches;
+static unsigned char watchCount;
+
+// Types with at least one subscriber
+static unsigned int eventWanted() {
+	unsigned int mask = 0;
+	unsigned char i;
+	EventQueue *queue;
+
+	for (i = 0; i < EVENT_SUBSCRIBERS_MAX; i++) {
+		queue = subscribers[i];
+		if (queue)
+			mask |= queue->mask;
+	}
+	return mask;
+}
+
+static void eventSampleTask(void *ignore) {
+	unsigned long wakeTime = millis();
+	// Whether each watch's last reading was in its window; unknown while nobody wants it
+	bool inside[EVENT_WATCHES_MAX], known[EVENT_WATCHES_MAX];
+	unsigned int wanted;
+	unsigned char i;
+	const EventWatch *watch;
+	int reading;
+	bool now;
+
+	for (i = 0; i < watchCount; i++)
+		known[i] = false;
+	while (1) {
+		wanted = eventWanted();
+		for (i = 0; i < watchCount; i++) {
+			watch = &watches[i];
+			if (!(wanted & EVENT_MASK(watch->type))) {
+				known[i] = false;
+				continue;
+			}
+			reading = watch->read();
+			now = reading >= watch->low && reading <= watch->high;
+			if (now && (!known[i] || !inside[i]))
+				eventPost(watch->type, reading);
+			inside[i] = now;
+			known[i] = true;
+		}
+		taskDelayUntil(&wakeTime, EVENT_SAMPLE_MS);
+	}
+}
+
+void eventInit(const EventWatch *list, unsigned char count) {
+	unsigned char i;
+
+	for (i = 0; i < EVENT_SUBSCRIBERS_MAX; i++)
+		subscribers[i] = NULL;
+	watches = list;
+	watchCount = count > EVENT_WATCHES_MAX ? EVENT_WATCHES_MAX : count;
+	if (watchCount > 0)
+		taskCreate(eventSampleTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+bool eventSubscribe(EventQueue *queue, unsigned int mask) {
+	unsigned char i, slot = EVENT_SUBSCRIBERS_MAX;
+
+	for (i = 0; i < EVENT_TYPES; i++)
+		queue->seen[i] = posted[i];
+	if (!queue->signal)
+		queue->signal = semaphoreCreate();
+	queue->mask = mask;
+	for (i = 0; i < EVENT_SUBSCRIBERS_MAX; i++) {
+		if (subscribers[i] == queue)
+			return true;
+		if (!subscribers[i] && slot == EVENT_SUBSCRIBERS_MAX)
+			slot = i;
+	}
+	if (slot == EVENT_SUBSCRIBERS_MAX)
+		return false;
+	subscribers[slot] = queue;
+	return true;
+}
+
+void eventUnsubscribe(EventQueue *queue) {
+	unsigned char i;
+
+	for (i = 0; i < EVENT_SUBSCRIBERS_MAX; i++)
+		if (subscribers[i] == queue)
+			subscribers[i] = NULL;
+}
+
+void eventPost(unsigned char type, int value) {
+	unsigned char i;
+	EventQueue *queue;
+
+	if (type >= EVENT_TYPES)
+		return;
+	//The value goes in before the count that makes it visible
+	postedValue[type] = value;
+	postedTime[type] = millis();
+	posted[type]++;
+	for (i = 0; i < EVENT_SUBSCRIBERS_MAX; i++) {
+		queue = subscribers[i];
+		if (queue && (queue->mask & EVENT_MASK(type)))
+			semaphoreGive(queue->signal);
+	}
+}
+
+// Takes the oldest waiting event of a queue, if there is one
+static bool eventTake(EventQueue *queue, Event *event) {
+	unsigned char type, oldest = EVENT_TYPES;
+	unsigned int count;
+
+	for (type = 0; type < EVENT_TYPES; type++)
+		if ((queue->mask & EVENT_MASK(type)) && posted[type] != queue->seen[type] &&
+				(oldest == EVENT_TYPES || postedTime[type] < postedTime[oldest]))
+			oldest = type;
+	if (oldest == EVENT_TYPES)
+		return false;
+	count = posted[oldest];
+	if (event) {
+		event->type = oldest;
+		event->value = postedValue[oldest];
+		event->time = postedTime[oldest];
+		event->count = count - queue->seen[oldest];
+	}
+	queue->seen[oldest] = count;
+	return true;
+}
+
+bool eventWait(EventQueue *queue, Event *event, unsigned long timeout) {
+	unsigned long start = millis(), waited;
+
+	while (!eventTake(queue, event)) {
+		waited = millis() - start;
+		if (waited >= timeout)
+			return false;
+		//A give left over from an event already taken only wakes it to look again
+		semaphoreTake(queue->signal, timeout - waited);
+	}
+	return true;
+}
@@ -0,0 +1,202 @@
+/** @file filter.c
+ * @brief Integer filters for noisy sensor readings
+ */
+
+#include "internal.h"
+
+// Fraction bits of a Kalman gain
+#define FILTER_GAIN_BITS 15
+
+// Drops the fraction bits of filter state, rounding to nearest
+static int filterRound(long long value, unsigned char bits) {
+	return (int)((value + (1LL << (bits - 1))) >> bits);
+}
+
+void averageInit(AverageFilter *filter, unsigned char size) {
+	if (size < 1)
+		size = 1;
+	if (size > FILTER_AVERAGE_MAX)
+		size = FILTER_AVERAGE_MAX;
+	filter->size = size;
+	filter->count = 0;
+	filter->next = 0;
+	filter->sum = 0;
+}
+
+int averageUpdate(AverageFilter *filter, int sample) {
+	//The oldest sample leaves the sum as the new one enters
+	if (filter->count == filter->size)
+		filter->sum -= filter->samples[filter->next];
+	else
+		filter->count++;
+	filter->samples[filter->next] = sample;
+	filter->sum += sample;
+	filter->next = filter->next + 1 == filter->size ? 0 : filter->next + 1;
+	if (filter->sum < 0)
+		return -(int)((-filter->sum + filter->count / 2) / filter->count);
+	return (int)((filter->sum + filter->count / 2) / filter->count);
+}
+
+void medianInit(MedianFilter *filter, unsigned char size) {
+	if (size < 1)
+		size = 1;
+	if (size > FILTER_MEDIAN_MAX)
+		size = FILTER_MEDIAN_MAX;
+	filter->size = size | 1;
+	filter->count = 0;
+	filter->next = 0;
+}
+
+int medianUpdate(MedianFilter *filter, int sample) {
+	int sorted[FILTER_MEDIAN_MAX], value;
+	unsigned char i, j;
+
+	filter->samples[filter->next] = sample;
+	filter->next = filter->next + 1 == filter->size ? 0 : filter->next + 1;
+	if (filter->count < filter->size)
+		filter->count++;
+	//Insertion sort: the window is small
+	for (i = 0; i < filter->count; i++) {
+		value = filter->samples[i];
+		for (j = i; j > 0 && sorted[j - 1] > value; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = value;
+	}
+	return sorted[(filter->count - 1) / 2];
+}
+
+void emaInit(EmaFilter *filter, unsigned char shift) {
+	filter->shift = shift > FILTER_FRAC ? FILTER_FRAC : shift;
+	filter->started = false;
+}
+
+int emaUpdate(EmaFilter *filter, int sample) {
+	long scaled = (long)sample << FILTER_FRAC;
+
+	if (!filter->started) {
+		filter->value = scaled;
+		filter->started = true;
+	}
+	filter->value += (scaled - filter->value) >> filter->shift;
+	return filterRound(filter->value, FILTER_FRAC);
+}
+
+void biquadLowPass(BiquadFilter *filter, unsigned int cutoffHz, unsigned int sampleHz) {
+	float sine, cosine, alpha, a0, one = 1 << FILTER_BIQUAD_BITS;
+
+	if (sampleHz == 0)
+		sampleHz = 1;
+	if (cutoffHz * 2 >= sampleHz)
+		cutoffHz = (sampleHz - 1) / 2;
+	if (cutoffHz == 0)
+		cutoffHz = 1;
+	//Butterworth, Q of 1 / sqrt(2)
+	mathSinCos(2 * MATH_PI * cutoffHz / sampleHz, &sine, &cosine);
+	alpha = sine * 0.70710678f;
+	a0 = 1 + alpha;
+	filter->b0 = (long)((1 - cosine) / 2 / a0 * one + 0.5f);
+	filter->b1 = (long)((1 - cosine) / a0 * one + 0.5f);
+	filter->b2 = filter->b0;
+	filter->a1 = -(long)(2 * cosine / a0 * one + (cosine > 0 ? 0.5f : -0.5f));
+	filter->a2 = (long)((1 - alpha) / a0 * one + 0.5f);
+	//The gain at rest must be exactly 1 so a steady reading comes through unchanged
+	filter->b1 = one + filter->a1 + filter->a2 - filter->b0 - filter->b2;
+	filter->started = false;
+}
+
+int biquadUpdate(BiquadFilter *filter, int sample) {
+	long long acc;
+	long y;
+
+	if (!filter->started) {
+		filter->x1 = filter->x2 = sample;
+		filter->y1 = filter->y2 = (long)sample << FILTER_FRAC;
+		filter->started = true;
+	}
+	//Inputs are whole samples, outputs keep FILTER_FRAC fraction bits
+	acc = ((long long)filter->b0 * sample + (long long)filter->b1 * filter->x1 +
+		(long long)filter->b2 * filter->x2) << FILTER_FRAC;
+	acc -= (long long)filter->a1 * filter->y1 + (long long)filter->a2 * filter->y2;
+	y = (long)(acc >> FILTER_BIQUAD_BITS);
+	filter->x2 = filter->x1;
+	filter->x1 = sample;
+	filter->y2 = filter->y1;
+	filter->y1 = y;
+	return filterRound(y, FILTER_FRAC);
+}
+
+void kalmanInit(KalmanFilter *filter, int processNoise, int measurementNoise) {
+	filter->processNoise = (long)(processNoise < 1 ? 1 : processNoise) << FILTER_FRAC;
+	filter->measurementNoise = (long)(measurementNoise < 0 ? 0 : measurementNoise) << FILTER_FRAC;
+	filter->started = false;
+}
+
+int kalmanUpdate(KalmanFilter *filter, int sample) {
+	long scaled = (long)sample << FILTER_FRAC;
+	long gain;
+
+	if (!filter->started) {
+		filter->estimate = scaled;
+		filter->variance = filter->measurementNoise;
+		filter->started = true;
+		return sample;
+	}
+	//Predict: the value may have moved; correct: weigh the sample by the gain
+	filter->variance += filter->processNoise;
+	gain = (long)(((long long)filter->variance << FILTER_GAIN_BITS) /
+		(filter->variance + filter->measurementNoise));
+	filter->estimate += (long)(((long long)gain * (scaled - filter->estimate)) >>
+		FILTER_GAIN_BITS);
+	filter->variance = (long)(((long long)((1L << FILTER_GAIN_BITS) - gain) *
+		filter->variance) >> FILTER_GAIN_BITS);
+	return filterRound(filter->estimate, FILTER_FRAC);
+}
+
+// A noisy reading for the bench
+static int filterBenchSample(unsigned int i) {
+	return 2000 + (int)((i * 37) & 63) - 32;
+}
+
+void filterBench(unsigned int samples) {
+	// Outputs are summed here so the updates are not optimized away
+	volatile int sink = 0;
+	unsigned long start;
+	unsigned int i;
+	AverageFilter average;
+	MedianFilter median;
+	EmaFilter ema;
+	BiquadFilter biquad;
+	KalmanFilter kalman;
+
+	if (samples == 0)
+		samples = 1;
+	averageInit(&average, 8);
+	start = micros();
+	for (i = 0; i < samples; i++)
+		sink += averageUpdate(&average, filterBenchSample(i));
+	benchPrint("average 8", micros() - start, samples, "sample");
+
+	medianInit(&median, 5);
+	start = micros();
+	for (i = 0; i < samples; i++)
+		sink += medianUpdate(&median, filterBenchSample(i));
+	benchPrint("median 5", micros() - start, samples, "sample");
+
+	emaInit(&ema, 3);
+	start = micros();
+	for (i = 0; i < samples; i++)
+		sink += emaUpdate(&ema, filterBenchSample(i));
+	benchPrint("ema", micros() - start, samples, "sample");
+
+	biquadLowPass(&biquad, 10, 100);
+	start = micros();
+	for (i = 0; i < samples; i++)
+		sink += biquadUpdate(&biquad, filterBenchSample(i));
+	benchPrint("biquad", micros() - start, samples, "sample");
+
+	kalmanInit(&kalman, 4, 400);
+	start = micros();
+	for (i = 0; i < samples; i++)
+		sink += kalmanUpdate(&kalman, filterBenchSample(i));
+	benchPrint("kalman", micros() - start, samples, "sample");
+}
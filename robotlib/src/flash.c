@@ -0,0 +1,83 @@
+/** @file flash.c
+ * @brief Erasing and writing the kept flash through the STM32F10x flash controller
+ *
+ * The host simulation provides its own flashErase() and flashWrite().
+ */
+
+#include "internal.h"
+
+// Flash controller registers (STM32F10x reference manual, section 3.3)
+#define FLASH_KEYR (*(volatile unsigned long *)0x40022004)
+#define FLASH_SR (*(volatile unsigned long *)0x4002200C)
+#define FLASH_CR (*(volatile unsigned long *)0x40022010)
+#define FLASH_AR (*(volatile unsigned long *)0x40022014)
+
+#define FLASH_KEY1 0x45670123
+#define FLASH_KEY2 0xCDEF89AB
+
+#define SR_BSY 0x01
+#define SR_PGERR 0x04
+#define SR_WRPRTERR 0x10
+#define SR_EOP 0x20
+
+#define CR_PG 0x01
+#define CR_PER 0x02
+#define CR_STRT 0x40
+#define CR_LOCK 0x80
+
+static void flashUnlock() {
+	if (FLASH_CR & CR_LOCK) {
+		FLASH_KEYR = FLASH_KEY1;
+		FLASH_KEYR = FLASH_KEY2;
+	}
+	//Clear the results of the last operation
+	FLASH_SR = SR_PGERR | SR_WRPRTERR | SR_EOP;
+}
+
+// Waits for the current operation and reports whether it succeeded
+static bool flashDone() {
+	while (FLASH_SR & SR_BSY);
+	return (FLASH_SR & (SR_PGERR | SR_WRPRTERR)) == 0;
+}
+
+bool flashErase(void *page) {
+	const volatile unsigned long *check;
+	unsigned int i;
+	bool ok;
+
+	//The controller erases the whole page an address is in, so check from its start
+	page = (void *)((unsigned long)page & ~(FLASH_PAGE_BYTES - 1UL));
+	check = (const volatile unsigned long *)page;
+	flashUnlock();
+	FLASH_CR |= CR_PER;
+	FLASH_AR = (unsigned long)page;
+	FLASH_CR |= CR_STRT;
+	ok = flashDone();
+	FLASH_CR &= ~CR_PER;
+	FLASH_CR |= CR_LOCK;
+
+	for (i = 0; ok && i < FLASH_PAGE_BYTES / sizeof(unsigned long); i++)
+		ok = check[i] == 0xFFFFFFFF;
+	return ok;
+}
+
+bool flashWrite(void *dest, const void *data, unsigned int bytes) {
+	volatile unsigned short *to = (volatile unsigned short *)dest;
+	const unsigned char *from = (const unsigned char *)data;
+	unsigned short value;
+	bool ok = true;
+
+	flashUnlock();
+	FLASH_CR |= CR_PG;
+	for (; ok && bytes >= 2; bytes -= 2) {
+		//data need not be aligned
+		value = from[0] | (from[1] << 8);
+		*to = value;
+		ok = flashDone() && *to == value;
+		to++;
+		from += 2;
+	}
+	FLASH_CR &= ~CR_PG;
+	FLASH_CR |= CR_LOCK;
+	return ok;
+}
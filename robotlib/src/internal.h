@@ -0,0 +1,36 @@
+/** @file internal.h
+ * @brief State shared between robot library modules
+ *
+ * Not installed for projects; only the library sources include this file.
+ */
+
+#ifndef INTERNAL_H_
+
+#define INTERNAL_H_
+
+#include <robot.h>
+
+// Set once the matching *Init() function has been called
+extern bool driveConfigured;
+extern bool armConfigured;
+extern bool lineConfigured;
+
+// Clock of the Cortex's STM32F103 in MHz
+#define CPU_MHZ 72
+
+// Block time of a semaphore or mutex wait that never gives up: the MAX_DELAY that API.h
+// mentions but does not define
+#define WAIT_FOREVER ((unsigned long)-1)
+
+// Prints the mean time of one of count operations that took us microseconds together, and
+// about how many cycles that is, for the *Bench() functions; unit names an operation
+void benchPrint(const char *name, unsigned long us, unsigned int count, const char *unit);
+
+// Drops the sampling task of oversample.h, for the host simulation: each scenario starts from
+// power-on, without the tasks of the last
+void oversampleForget();
+
+// Logs one call for record.h
+void recordAdd(char kind, unsigned char port, int value);
+
+#endif
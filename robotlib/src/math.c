@@ -0,0 +1,42 @@
+/** @file math.c
+ * @brief Single precision math for path following and filter design
+ */
+
+#include "internal.h"
+
+void mathSinCos(float x, float *sine, float *cosine) {
+	float term, x2, s = 0, c = 0;
+	long turns;
+	int n;
+
+	//The series are only accurate within half a turn of 0
+	turns = (long)(x / (2 * MATH_PI) + (x >= 0 ? 0.5f : -0.5f));
+	x -= turns * 2 * MATH_PI;
+	term = x;
+	x2 = x * x;
+
+	for (n = 1; n < 16; n += 2) {
+		s += term;
+		term *= -x2 / ((n + 1) * (n + 2));
+	}
+	term = 1;
+	for (n = 0; n < 16; n += 2) {
+		c += term;
+		term *= -x2 / ((n + 1) * (n + 2));
+	}
+	*sine = s;
+	*cosine = c;
+}
+
+float mathSqrt(float x) {
+	float root;
+	int i;
+
+	if (x <= 0)
+		return 0;
+	//Newton's method, from above the root so it only comes down
+	root = x > 1 ? x : 1;
+	for (i = 0; i < 24; i++)
+		root = (root + x / root) / 2;
+	return root;
+}
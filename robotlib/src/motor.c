@@ -0,0 +1,21 @@
+/** @file motor.c
+ * @brief Motor groups driven as one mechanism
+ */
+
+#include "internal.h"
+
+void motorGroupSet(const MotorGroup *group, int speed) {
+	unsigned char i;
+
+	for (i = 0; i < group->count; i++) {
+		motorSet(group->port[i], group->sign[i] * speed);
+	}
+}
+
+void motorGroupStop(const MotorGroup *group) {
+	unsigned char i;
+
+	for (i = 0; i < group->count; i++) {
+		motorStop(group->port[i]);
+	}
+}
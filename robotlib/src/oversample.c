@@ -0,0 +1,115 @@
+/** @file oversample.c
+ * @brief Analog inputs averaged at a fixed rate for extra resolution and less noise
+ */
+
+#include "internal.h"
+
+#define OVERSAMPLE_BLOCKS (OVERSAMPLE_SAMPLES / OVERSAMPLE_BLOCK)
+
+#ifdef RECORD
+// Under make RECORD=1 analogRead() is logged; a reading of every channel each millisecond
+// would fill the log in seconds, so the task reads past the recorder
+int __real_analogRead(unsigned char channel);
+#define oversampleAnalog(channel) __real_analogRead(channel)
+#else
+#define oversampleAnalog(channel) analogRead(channel)
+#endif
+
+typedef struct {
+	unsigned char channel;
+	// Sums of the last OVERSAMPLE_BLOCKS blocks of readings, and of the block being read
+	unsigned int blocks[OVERSAMPLE_BLOCKS];
+	unsigned int block;
+	unsigned char readings;
+	unsigned char next;
+	unsigned char filled;
+	volatile int value;
+	volatile bool ready;
+} OversampleChannel;
+
+static OversampleChannel channels[OVERSAMPLE_CHANNELS_MAX];
+static volatile unsigned char channelCount;
+// The sampling task, made by the first oversampleInit() with channels; later calls only change
+// the channels it reads, so there is never a second one adding to the same sums
+static TaskHandle sampler;
+
+static void oversampleTask(void *ignore) {
+	unsigned long wakeTime = millis();
+	unsigned int sum;
+	unsigned char i, b;
+	OversampleChannel *c;
+
+	while (1) {
+		for (i = 0; i < channelCount; i++) {
+			c = &channels[i];
+			c->block += oversampleAnalog(c->channel);
+			if (++c->readings < OVERSAMPLE_BLOCK)
+				continue;
+			//A block is done: it replaces the oldest and the value is published
+			c->blocks[c->next] = c->block;
+			c->next = (c->next + 1) % OVERSAMPLE_BLOCKS;
+			c->block = 0;
+			c->readings = 0;
+			if (c->filled < OVERSAMPLE_BLOCKS)
+				c->filled++;
+			if (c->filled == OVERSAMPLE_BLOCKS) {
+				sum = 0;
+				for (b = 0; b < OVERSAMPLE_BLOCKS; b++)
+					sum += c->blocks[b];
+				c->value = sum >> OVERSAMPLE_BITS;
+				c->ready = true;
+			}
+		}
+		taskDelayUntil(&wakeTime, OVERSAMPLE_MS);
+	}
+}
+
+// Finds an oversampled channel, or NULL if it is not one
+static OversampleChannel *oversampleFind(unsigned char channel) {
+	unsigned char i;
+
+	for (i = 0; i < channelCount; i++)
+		if (channels[i].channel == channel)
+			return &channels[i];
+	return NULL;
+}
+
+void oversampleInit(const unsigned char *list, unsigned char count) {
+	unsigned char i;
+
+	if (count > OVERSAMPLE_CHANNELS_MAX)
+		count = OVERSAMPLE_CHANNELS_MAX;
+	//The task reads no channels while the list is swapped
+	channelCount = 0;
+	for (i = 0; i < count; i++) {
+		channels[i].channel = list[i];
+		channels[i].block = 0;
+		channels[i].readings = 0;
+		channels[i].next = 0;
+		channels[i].filled = 0;
+		channels[i].ready = false;
+	}
+	channelCount = count;
+	if (count > 0 && !sampler)
+		sampler = taskCreate(oversampleTask, TASK_MINIMAL_STACK_SIZE, NULL,
+			TASK_PRIORITY_DEFAULT + 2);
+}
+
+#ifndef __arm__
+void oversampleForget() {
+	sampler = NULL;
+	channelCount = 0;
+}
+#endif
+
+int oversampleGet(unsigned char channel) {
+	OversampleChannel *c = oversampleFind(channel);
+
+	if (c && c->ready)
+		return c->value;
+	return analogRead(channel) << OVERSAMPLE_BITS;
+}
+
+int oversampleRead(unsigned char channel) {
+	return (oversampleGet(channel) + (1 << (OVERSAMPLE_BITS - 1))) >> OVERSAMPLE_BITS;
+}
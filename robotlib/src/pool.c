@@ -0,0 +1,104 @@
+/** @file pool.c
+ * @brief Fixed-size block pools in static storage, with usage counters
+ */
+
+#include "internal.h"
+
+static Pool *pools[POOL_MAX];
+
+// Adds a pool to the report, once
+static void poolRegister(Pool *pool) {
+	unsigned char i;
+
+	for (i = 0; i < POOL_MAX; i++) {
+		if (pools[i] == pool)
+			return;
+		if (!pools[i]) {
+			pools[i] = pool;
+			return;
+		}
+	}
+}
+
+void poolInit(Pool *pool, const char *name, void *storage, unsigned int blockSize,
+		unsigned int count) {
+	unsigned int i;
+
+	//A block too small for the free list link gives an empty pool rather than an overrun
+	if (blockSize < sizeof(void *))
+		count = 0;
+	if (count > POOL_BLOCKS_MAX)
+		count = POOL_BLOCKS_MAX;
+	pool->name = name;
+	pool->storage = storage;
+	pool->blockSize = blockSize;
+	pool->count = count;
+	//Threaded from the last block down, so the first block is handed out first
+	pool->free = NULL;
+	for (i = count; i > 0; i--) {
+		*(void **)(pool->storage + (i - 1) * blockSize) = pool->free;
+		pool->free = pool->storage + (i - 1) * blockSize;
+	}
+	for (i = 0; i < POOL_BLOCKS_MAX / 32; i++)
+		pool->taken[i] = 0;
+	if (!pool->lock)
+		pool->lock = mutexCreate();
+	pool->used = 0;
+	pool->peak = 0;
+	pool->failed = 0;
+	poolRegister(pool);
+}
+
+void *poolAlloc(Pool *pool) {
+	unsigned int index;
+	void *block;
+
+	mutexTake(pool->lock, WAIT_FOREVER);
+	block = pool->free;
+	if (block) {
+		pool->free = *(void **)block;
+		index = ((unsigned char *)block - pool->storage) / pool->blockSize;
+		pool->taken[index / 32] |= 1UL << (index % 32);
+		pool->used++;
+		if (pool->used > pool->peak)
+			pool->peak = pool->used;
+	}
+	else
+		pool->failed++;
+	mutexGive(pool->lock);
+	return block;
+}
+
+void poolFree(Pool *pool, void *block) {
+	unsigned char *at = block;
+	unsigned long bit;
+	unsigned int index;
+
+	if (!at || at < pool->storage || at >= pool->storage + pool->count * pool->blockSize ||
+			(unsigned int)(at - pool->storage) % pool->blockSize != 0)
+		return;
+	index = (at - pool->storage) / pool->blockSize;
+	bit = 1UL << (index % 32);
+	mutexTake(pool->lock, WAIT_FOREVER);
+	//Linked in twice, the block would be handed out twice
+	if (pool->taken[index / 32] & bit) {
+		pool->taken[index / 32] &= ~bit;
+		*(void **)block = pool->free;
+		pool->free = block;
+		pool->used--;
+	}
+	mutexGive(pool->lock);
+}
+
+void poolReport() {
+	unsigned char i;
+	Pool *pool;
+
+	printf("pool: name         block count  used  peak failed\r\n");
+	for (i = 0; i < POOL_MAX; i++) {
+		pool = pools[i];
+		if (pool)
+			printf("pool: %-12s %5u %5u %5u %5u %6u\r\n", pool->name, pool->blockSize,
+				pool->count, pool->used, pool->peak, pool->failed);
+	}
+}
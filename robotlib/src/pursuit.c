@@ -0,0 +1,208 @@
+/** @file pursuit.c
+ * @brief Odometry and a pure-pursuit path follower
+ */
+
+#include "internal.h"
+
+static OdomConfig odom;
+static volatile Pose pose;
+// Counts, gyro reading and time the pose was last moved from
+static int lastLeft, lastRight, lastGyro;
+static unsigned long lastTime;
+// Heading the gyro reads as 0
+static float gyroOffset;
+
+// Heading by the gyro, in radians counterclockwise
+static float odomGyroHeading(int reading) {
+	return gyroOffset + (odom.gyroReversed ? -reading : reading) * MATH_PI / 180;
+}
+
+void odomInit(const OdomConfig *config) {
+	odom = *config;
+	if (odom.countsPerInch <= 0)
+		odom.countsPerInch = 1;
+	if (odom.trackWidth <= 0)
+		odom.trackWidth = 1;
+	odomReset(0, 0, 0);
+}
+
+void odomReset(float x, float y, float heading) {
+	driveGetCounts(&lastLeft, &lastRight);
+	if (odom.gyro)
+		lastGyro = gyroGet(odom.gyro);
+	gyroOffset = heading - (odom.gyro ? odomGyroHeading(lastGyro) - gyroOffset : 0);
+	lastTime = millis();
+	pose.x = x;
+	pose.y = y;
+	pose.heading = heading;
+	pose.speed = 0;
+}
+
+void odomUpdate() {
+	int left, right, reading;
+	unsigned long now = millis();
+	float distLeft, distRight, dist, turn, sine, cosine;
+
+	//A side that did not answer is left for the next update to catch up on
+	if (!driveGetCounts(&left, &right))
+		return;
+	distLeft = (left - lastLeft) / odom.countsPerInch;
+	distRight = (right - lastRight) / odom.countsPerInch;
+	dist = (distLeft + distRight) / 2;
+	if (odom.gyro) {
+		reading = gyroGet(odom.gyro);
+		turn = odomGyroHeading(reading) - pose.heading;
+		lastGyro = reading;
+	}
+	else
+		turn = (distRight - distLeft) / odom.trackWidth;
+	//The arc's chord points half way between the headings at its ends
+	mathSinCos(pose.heading + turn / 2, &sine, &cosine);
+	pose.x += dist * cosine;
+	pose.y += dist * sine;
+	pose.heading += turn;
+	if (now != lastTime)
+		pose.speed += (dist * 1000 / (now - lastTime) - pose.speed) / 2;
+	lastLeft = left;
+	lastRight = right;
+	lastTime = now;
+}
+
+void odomGet(Pose *out) {
+	out->x = pose.x;
+	out->y = pose.y;
+	out->heading = pose.heading;
+	out->speed = pose.speed;
+}
+
+void pursuitStart(Pursuit *pursuit, const PursuitPath *path) {
+	pursuit->path = path;
+	pursuit->segment = 0;
+	pursuit->done = false;
+}
+
+bool pursuitUpdate(Pursuit *pursuit, const Pose *at, int *left, int *right) {
+	const PursuitPath *path = pursuit->path;
+	const Waypoint *points = path->points;
+	float bestDist = -1, bestT = 0, t, dx, dy, length2, px, py, dist;
+	float lookahead, remaining, toEnd, segLength, goalX, goalY, startX, startY;
+	float heading, sine, cosine, localX, localY, curvature, power, l, r, most;
+	unsigned char i, best = pursuit->segment;
+	bool reverse = path->power < 0, found = false;
+
+	*left = 0;
+	*right = 0;
+	if (pursuit->done || path->count < 2) {
+		pursuit->done = true;
+		return true;
+	}
+	//Nearest point on the segments from the last nearest on
+	for (i = pursuit->segment; i + 1 < path->count; i++) {
+		dx = points[i + 1].x - points[i].x;
+		dy = points[i + 1].y - points[i].y;
+		length2 = dx * dx + dy * dy;
+		t = length2 > 0 ? ((at->x - points[i].x) * dx + (at->y - points[i].y) * dy) / length2 : 0;
+		if (t < 0)
+			t = 0;
+		if (t > 1)
+			t = 1;
+		px = points[i].x + dx * t - at->x;
+		py = points[i].y + dy * t - at->y;
+		dist = px * px + py * py;
+		if (bestDist < 0 || dist < bestDist) {
+			bestDist = dist;
+			best = i;
+			bestT = t;
+		}
+	}
+	pursuit->segment = best;
+
+	//The goal is lookahead along the path from the nearest point, or the end if that is nearer
+	lookahead = path->lookaheadMin + path->lookaheadGain * (at->speed < 0 ? -at->speed : at->speed);
+	if (lookahead > path->lookaheadMax)
+		lookahead = path->lookaheadMax;
+	remaining = lookahead;
+	toEnd = 0;
+	goalX = points[path->count - 1].x;
+	goalY = points[path->count - 1].y;
+	for (i = best; i + 1 < path->count; i++) {
+		startX = i == best ? points[i].x + (points[i + 1].x - points[i].x) * bestT : points[i].x;
+		startY = i == best ? points[i].y + (points[i + 1].y - points[i].y) * bestT : points[i].y;
+		dx = points[i + 1].x - startX;
+		dy = points[i + 1].y - startY;
+		segLength = mathSqrt(dx * dx + dy * dy);
+		if (!found && segLength >= remaining) {
+			goalX = startX + dx * remaining / segLength;
+			goalY = startY + dy * remaining / segLength;
+			found = true;
+		}
+		else if (!found)
+			remaining -= segLength;
+		toEnd += segLength;
+	}
+	if (toEnd <= path->tolerance) {
+		pursuit->done = true;
+		return true;
+	}
+
+	//Backwards the robot follows as if its back were its front, with the sides swapped
+	heading = at->heading + (reverse ? MATH_PI : 0);
+	mathSinCos(heading, &sine, &cosine);
+	dx = goalX - at->x;
+	dy = goalY - at->y;
+	localX = cosine * dx + sine * dy;
+	localY = cosine * dy - sine * dx;
+	dist = localX * localX + localY * localY;
+	curvature = dist > 0 ? 2 * localY / dist : 0;
+
+	power = (float)(reverse ? -path->power : path->power);
+	if (toEnd < path->slowDistance) {
+		power = power * toEnd / path->slowDistance;
+		if (power < PURSUIT_MIN_POWER)
+			power = PURSUIT_MIN_POWER;
+		if (power > (reverse ? -path->power : path->power))
+			power = (float)(reverse ? -path->power : path->power);
+	}
+	l = power * (1 - curvature * odom.trackWidth / 2);
+	r = power * (1 + curvature * odom.trackWidth / 2);
+	//A tight arc slows the outside wheel to the power rather than speeding it past
+	most = l < 0 ? -l : l;
+	if ((r < 0 ? -r : r) > most)
+		most = r < 0 ? -r : r;
+	if (most > power) {
+		l = l * power / most;
+		r = r * power / most;
+	}
+	if (reverse) {
+		*left = -(int)(r + (r < 0 ? -0.5f : 0.5f));
+		*right = -(int)(l + (l < 0 ? -0.5f : 0.5f));
+	}
+	else {
+		*left = (int)(l + (l < 0 ? -0.5f : 0.5f));
+		*right = (int)(r + (r < 0 ? -0.5f : 0.5f));
+	}
+	return false;
+}
+
+bool pursuitFollow(const PursuitPath *path, unsigned long timeout) {
+	unsigned long start = millis(), wakeTime = start;
+	Pursuit pursuit;
+	Pose at;
+	int left, right;
+
+	pursuitStart(&pursuit, path);
+	while (1) {
+		odomUpdate();
+		odomGet(&at);
+		if (pursuitUpdate(&pursuit, &at, &left, &right)) {
+			driveStop();
+			return true;
+		}
+		if (millis() - start >= timeout) {
+			driveStop();
+			return false;
+		}
+		driveTank(left, right);
+		taskDelayUntil(&wakeTime, PURSUIT_MS);
+	}
+}
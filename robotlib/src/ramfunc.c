@@ -0,0 +1,41 @@
+/** @file ramfunc.c
+ * @brief Code run from RAM, and the cycle counter that shows whether it pays
+ */
+
+#include "internal.h"
+
+#ifdef __arm__
+// Debug exception and monitor control: TRCENA turns on the DWT
+#define CYCLES_DEMCR (*(volatile unsigned long *)0xE000EDFC)
+#define CYCLES_DEMCR_TRCENA (1UL << 24)
+// Data watchpoint and trace unit: CYCCNTENA runs CYCCNT
+#define CYCLES_DWT_CTRL (*(volatile unsigned long *)0xE0001000)
+#define CYCLES_DWT_CTRL_CYCCNTENA 1UL
+#define CYCLES_DWT_CYCCNT (*(volatile unsigned long *)0xE0001004)
+
+void cyclesInit() {
+	if (!(CYCLES_DWT_CTRL & CYCLES_DWT_CTRL_CYCCNTENA)) {
+		CYCLES_DEMCR |= CYCLES_DEMCR_TRCENA;
+		CYCLES_DWT_CYCCNT = 0;
+		CYCLES_DWT_CTRL |= CYCLES_DWT_CTRL_CYCCNTENA;
+	}
+}
+
+unsigned long cyclesGet() {
+	return CYCLES_DWT_CYCCNT;
+}
+#else
+void cyclesInit() {
+}
+
+unsigned long cyclesGet() {
+	return micros() * CPU_MHZ;
+}
+#endif
+
+void benchPrint(const char *name, unsigned long us, unsigned int count, const char *unit) {
+	unsigned long ns = us * 1000 / count;
+
+	printf("bench: %s %lu.%03lu us per %s, about %lu cycles\r\n", name, ns / 1000, ns % 1000,
+		unit, ns * CPU_MHZ / 1000);
+}
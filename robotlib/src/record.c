@@ -0,0 +1,270 @@
+/** @file record.c
+ * @brief Sensor and motor log for replaying a run on the host
+ *
+ * The log is a byte stream of two entry forms, both starting with the port's channel number:
+ *
+ * short (4 bytes): channel, gap (u8), difference from the prediction (s8), new step (s8)
+ * long (12 bytes): channel | 0x80, kind, new step (s16), gap (u32), value (s32)
+ *
+ * The long form is used for a port's first call, a change of kind (an IME failing) and
+ * anything too big for the short form. Multi-byte fields are little-endian.
+ *
+ * Calls come from every task and from interrupt handlers (a limit switch stopping a motor), so
+ * each one is appended with interrupts masked. Without RECORD (make RECORD=1) only empty stubs
+ * are built, so the log takes no RAM.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+
+#ifdef RECORD
+
+// IMEs recorded; calls on higher addresses are not logged
+#define RECORD_IMES 8
+
+// Index of the first port of each kind of call in the per-port tables
+#define CHANNEL_ANALOG 0
+#define CHANNEL_DIGITAL (CHANNEL_ANALOG + BOARD_NR_ADC_PINS + 1)
+#define CHANNEL_IME (CHANNEL_DIGITAL + BOARD_NR_GPIO_PINS + 1)
+#define CHANNEL_IME_VELOCITY (CHANNEL_IME + RECORD_IMES)
+#define CHANNEL_ENCODER (CHANNEL_IME_VELOCITY + RECORD_IMES)
+#define CHANNEL_ULTRASONIC (CHANNEL_ENCODER + 1)
+#define CHANNEL_MILLIS (CHANNEL_ULTRASONIC + 1)
+#define CHANNEL_MOTOR (CHANNEL_MILLIS + 1)
+#define CHANNELS (CHANNEL_MOTOR + 11)
+
+#define RECORD_LONG 0x80
+#define RECORD_SHORT_SIZE 4
+#define RECORD_LONG_SIZE 12
+
+// Prediction state of one port
+typedef struct {
+	unsigned int calls;
+	unsigned int gap; //Calls since the last entry that matched the prediction
+	int last;
+	short step;
+	char kind;
+} RecordPort;
+
+static unsigned char stream[RECORD_BYTES];
+static unsigned int used = 0;
+static unsigned int dropped = 0;
+static unsigned int total = 0;
+static bool stopped = false;
+static bool full = false;
+static RecordPort ports[CHANNELS];
+
+// Gets the table index of a port, or -1 if it is not recorded
+static int recordChannel(char kind, unsigned char port) {
+	unsigned int first, count;
+
+	switch (kind) {
+	case RECORD_ANALOG:
+		first = CHANNEL_ANALOG; count = BOARD_NR_ADC_PINS + 1; break;
+	case RECORD_DIGITAL:
+		first = CHANNEL_DIGITAL; count = BOARD_NR_GPIO_PINS + 1; break;
+	case RECORD_IME:
+	case RECORD_IME_FAILED:
+		first = CHANNEL_IME; count = RECORD_IMES; break;
+	case RECORD_IME_VELOCITY:
+	case RECORD_IME_VELOCITY_FAILED:
+		first = CHANNEL_IME_VELOCITY; count = RECORD_IMES; break;
+	case RECORD_ENCODER:
+		first = CHANNEL_ENCODER; count = 1; break;
+	case RECORD_ULTRASONIC:
+		first = CHANNEL_ULTRASONIC; count = 1; break;
+	case RECORD_MILLIS:
+		first = CHANNEL_MILLIS; count = 1; break;
+	default:
+		first = CHANNEL_MOTOR; count = CHANNELS - CHANNEL_MOTOR; break;
+	}
+	return port < count ? (int)(first + port) : -1;
+}
+
+// Gets the kind of a channel's port 0, which is the recorded kind of every port in its group
+static char recordKindOf(unsigned int channel) {
+	if (channel >= CHANNEL_MOTOR)
+		return RECORD_MOTOR;
+	if (channel >= CHANNEL_MILLIS)
+		return RECORD_MILLIS;
+	if (channel >= CHANNEL_ULTRASONIC)
+		return RECORD_ULTRASONIC;
+	if (channel >= CHANNEL_ENCODER)
+		return RECORD_ENCODER;
+	if (channel >= CHANNEL_IME_VELOCITY)
+		return RECORD_IME_VELOCITY;
+	if (channel >= CHANNEL_IME)
+		return RECORD_IME;
+	if (channel >= CHANNEL_DIGITAL)
+		return RECORD_DIGITAL;
+	return RECORD_ANALOG;
+}
+
+static void recordPut(unsigned int at, unsigned int value, unsigned int bytes) {
+	while (bytes-- > 0) {
+		stream[at++] = (unsigned char)value;
+		value >>= 8;
+	}
+}
+
+#ifdef __arm__
+// Masks interrupts, returning the mask as it was so a call from a handler leaves it masked
+static inline unsigned long recordLock() {
+	unsigned long primask;
+
+	__asm__ volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) : : "memory");
+	return primask;
+}
+
+static inline void recordUnlock(unsigned long primask) {
+	__asm__ volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+#else
+// The simulation only switches tasks inside API calls, so an append is already atomic
+#define recordLock() 0UL
+#define recordUnlock(primask) ((void)(primask))
+#endif
+
+static unsigned int recordGet(unsigned int at, unsigned int bytes) {
+	unsigned int value = 0;
+
+	while (bytes-- > 0)
+		value = (value << 8) | stream[at + bytes];
+	return value;
+}
+
+// Appends a call to the log; interrupts must be masked
+static void recordAppend(char kind, unsigned char port, int value) {
+	int channel = recordChannel(kind, port);
+	RecordPort *p;
+	int difference, step;
+	bool isShort;
+
+	if (channel < 0)
+		return;
+	if (stopped) {
+		if (full)
+			dropped++;
+		return;
+	}
+	p = &ports[channel];
+	difference = value - (p->last + p->step);
+
+	if (p->calls > 0 && p->kind == kind && difference == 0) {
+		p->gap++;
+	}
+	else {
+		//A change straight after another sets the step; one after a steady run keeps it
+		step = (p->gap == 0 && p->calls > 0) ? value - p->last : p->step;
+		if (step < -32768 || step > 32767)
+			step = 0;
+		isShort = p->calls > 0 && p->kind == kind && p->gap <= 0xFF && difference >= -128 &&
+			difference <= 127 && step >= -128 && step <= 127;
+
+		if (used + (isShort ? RECORD_SHORT_SIZE : RECORD_LONG_SIZE) > RECORD_BYTES) {
+			//Keep the log consistent up to the last call that fitted
+			stopped = true;
+			full = true;
+			dropped++;
+			return;
+		}
+		if (isShort) {
+			stream[used] = channel;
+			stream[used + 1] = p->gap;
+			stream[used + 2] = (unsigned char)difference;
+			stream[used + 3] = (unsigned char)step;
+			used += RECORD_SHORT_SIZE;
+		}
+		else {
+			stream[used] = channel | RECORD_LONG;
+			stream[used + 1] = kind;
+			recordPut(used + 2, step, 2);
+			recordPut(used + 4, p->gap, 4);
+			recordPut(used + 8, value, 4);
+			used += RECORD_LONG_SIZE;
+		}
+		p->gap = 0;
+		p->step = step;
+		p->kind = kind;
+	}
+	p->last = value;
+	p->calls++;
+	total++;
+}
+
+void recordAdd(char kind, unsigned char port, int value) {
+	unsigned long primask = recordLock();
+
+	recordAppend(kind, port, value);
+	recordUnlock(primask);
+}
+
+void recordStart() {
+	unsigned long primask = recordLock();
+
+	memset(ports, 0, sizeof(ports));
+	used = 0;
+	dropped = 0;
+	total = 0;
+	stopped = false;
+	full = false;
+	recordUnlock(primask);
+}
+
+void recordStop() {
+	stopped = true;
+}
+
+unsigned int recordCount() {
+	return total;
+}
+
+void recordDump() {
+	unsigned int at, channel;
+
+	printf("record %u %u\r\n", used, dropped);
+	for (at = 0; at < used; ) {
+		channel = stream[at] & ~RECORD_LONG;
+		if (stream[at] & RECORD_LONG) {
+			printf("%c %u %u =%d %d\r\n", stream[at + 1], channel - recordChannel(stream[at + 1], 0),
+				recordGet(at + 4, 4), (int)recordGet(at + 8, 4), (short)recordGet(at + 2, 2));
+			at += RECORD_LONG_SIZE;
+		}
+		else {
+			signed char difference = (signed char)stream[at + 2];
+
+			printf("%c %u %u %c%d %d\r\n", recordKindOf(channel), channel -
+				recordChannel(recordKindOf(channel), 0), stream[at + 1], difference < 0 ? '-' : '+',
+				difference < 0 ? -difference : difference, (signed char)stream[at + 3]);
+			at += RECORD_SHORT_SIZE;
+		}
+	}
+	//Each port's number of calls, so a replay knows where the log runs out
+	for (channel = 0; channel < CHANNELS; channel++) {
+		if (ports[channel].calls > 0)
+			printf("calls %c %u %u\r\n", recordKindOf(channel), channel -
+				recordChannel(recordKindOf(channel), 0), ports[channel].calls);
+	}
+	printf("end\r\n");
+}
+
+#else
+
+void recordAdd(char kind, unsigned char port, int value) {
+}
+
+void recordStart() {
+}
+
+void recordStop() {
+}
+
+unsigned int recordCount() {
+	return 0;
+}
+
+void recordDump() {
+}
+
+#endif
@@ -0,0 +1,79 @@
+/** @file recordwrap.c
+ * @brief Recorders linked in place of the sensor and motor API by make RECORD=1
+ *
+ * The linker's --wrap option sends every call to analogRead() and the rest to
+ * __wrap_analogRead(), which reaches the real function as __real_analogRead(). Nothing refers
+ * to this file otherwise, so normal builds leave it in the archive and the host build skips it.
+ */
+
+#include "internal.h"
+
+int __real_analogRead(unsigned char channel);
+bool __real_digitalRead(unsigned char pin);
+bool __real_imeGet(unsigned char address, int *value);
+bool __real_imeGetVelocity(unsigned char address, int *value);
+int __real_encoderGet(Encoder enc);
+int __real_ultrasonicGet(Ultrasonic ult);
+unsigned long __real_millis();
+void __real_motorSet(unsigned char channel, int speed);
+void __real_motorStop(unsigned char channel);
+
+int __wrap_analogRead(unsigned char channel) {
+	int value = __real_analogRead(channel);
+
+	recordAdd(RECORD_ANALOG, channel, value);
+	return value;
+}
+
+bool __wrap_digitalRead(unsigned char pin) {
+	bool value = __real_digitalRead(pin);
+
+	recordAdd(RECORD_DIGITAL, pin, value);
+	return value;
+}
+
+bool __wrap_imeGet(unsigned char address, int *value) {
+	bool ok = __real_imeGet(address, value);
+
+	recordAdd(ok ? RECORD_IME : RECORD_IME_FAILED, address, ok ? *value : 0);
+	return ok;
+}
+
+bool __wrap_imeGetVelocity(unsigned char address, int *value) {
+	bool ok = __real_imeGetVelocity(address, value);
+
+	recordAdd(ok ? RECORD_IME_VELOCITY : RECORD_IME_VELOCITY_FAILED, address, ok ? *value : 0);
+	return ok;
+}
+
+//Encoder and ultrasonic handles do not give their ports away; they are logged as port 0
+int __wrap_encoderGet(Encoder enc) {
+	int value = __real_encoderGet(enc);
+
+	recordAdd(RECORD_ENCODER, 0, value);
+	return value;
+}
+
+int __wrap_ultrasonicGet(Ultrasonic ult) {
+	int value = __real_ultrasonicGet(ult);
+
+	recordAdd(RECORD_ULTRASONIC, 0, value);
+	return value;
+}
+
+unsigned long __wrap_millis() {
+	unsigned long time = __real_millis();
+
+	recordAdd(RECORD_MILLIS, 0, (int)time);
+	return time;
+}
+
+void __wrap_motorSet(unsigned char channel, int speed) {
+	recordAdd(RECORD_MOTOR, channel, speed);
+	__real_motorSet(channel, speed);
+}
+
+void __wrap_motorStop(unsigned char channel) {
+	recordAdd(RECORD_MOTOR, channel, 0);
+	__real_motorStop(channel);
+}
@@ -0,0 +1,375 @@
+/** @file route.c
+ * @brief Driver routes recorded from the joysticks and played back in autonomous
+ *
+ * A saved route is a RouteHeader followed by one record per tick in which a field changed: a
+ * 3-byte mask of the changed fields, low byte first, then the change of each of those fields
+ * modulo 256 in field order. A zero mask is followed by a count of 1 to 255 ticks in which
+ * nothing changed. The header is written last, so a route cut short by a reset is not saved.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+
+// Fields of a tick: axes 1-4 of joysticks 1 and 2, groups 5-8 of joysticks 1 and 2 as JOY_*
+// masks, then the counts each drive side moved since the last tick
+#define FIELD_AXES 0
+#define FIELD_BUTTONS 8
+#define FIELD_TRAVEL 16
+#define FIELDS 18
+
+// Marks a saved route; change it whenever the format changes
+#define ROUTE_MAGIC 0x31545452
+// Most ticks in one idle record
+#define IDLE_MAX 255
+
+typedef struct {
+	unsigned long magic;
+	// ROUTE_TICK_MS of the build that recorded it
+	unsigned long tick;
+	unsigned long ticks;
+	unsigned long bytes;
+	// Sum of the data bytes
+	unsigned long check;
+} RouteHeader;
+
+typedef enum {
+	ROUTE_IDLE = 0,
+	ROUTE_RECORDING,
+	ROUTE_PLAYING,
+} RouteState;
+
+#define ROUTE_DATA (ROUTE_BYTES - sizeof(RouteHeader))
+
+static unsigned char routeFlash[ROUTE_BYTES] FLASH_USER;
+static const RouteHeader *const header = (const RouteHeader *)routeFlash;
+static unsigned char *const data = routeFlash + sizeof(RouteHeader);
+
+// Held by the tick task while it works and by the functions that start and stop it; made by
+// routeInit() before any task can race to make it
+static Mutex lock;
+static volatile RouteState state;
+// Tells a tick task that has been replaced to end
+static unsigned long generation;
+static unsigned long tick;
+// Field values as of the last tick recorded or played
+static unsigned char frame[FIELDS];
+static unsigned long ticks, maxTicks;
+// Bytes of data written or read
+static unsigned long pos;
+static unsigned long check;
+// Ticks without a change, not yet written or still to play
+static unsigned int idle;
+// Recording waits for the first joystick movement
+static bool started;
+// Half-word waiting for its second byte
+static unsigned char half[2];
+// Drive counts as recorded so far, or as expected by now during playback
+static int countLeft, countRight;
+static bool correcting;
+
+static void routeLock() {
+	mutexTake(lock, WAIT_FOREVER);
+}
+
+static void routeUnlock() {
+	mutexGive(lock);
+}
+
+// Whether the saved route is complete and intact
+static bool routeValid() {
+	unsigned long i, sum = 0;
+
+	if (header->magic != ROUTE_MAGIC || header->tick == 0 || header->bytes > ROUTE_DATA)
+		return false;
+	for (i = 0; i < header->bytes; i++)
+		sum += data[i];
+	return sum == header->check;
+}
+
+static unsigned char routeButtons(unsigned char joystick, unsigned char group) {
+	unsigned char buttons = 0;
+
+	if (joystickGetDigital(joystick, group, JOY_DOWN))
+		buttons |= JOY_DOWN;
+	if (joystickGetDigital(joystick, group, JOY_LEFT))
+		buttons |= JOY_LEFT;
+	if (joystickGetDigital(joystick, group, JOY_UP))
+		buttons |= JOY_UP;
+	if (joystickGetDigital(joystick, group, JOY_RIGHT))
+		buttons |= JOY_RIGHT;
+	return buttons;
+}
+
+// Moves a recorded count towards the real one by at most what a field holds
+static int routeTravel(int *recorded, int count) {
+	int travel = count - *recorded;
+
+	if (travel > 127)
+		travel = 127;
+	if (travel < -127)
+		travel = -127;
+	*recorded += travel;
+	return travel;
+}
+
+static void routeSample(unsigned char *sample) {
+	unsigned char joystick, i;
+	int countL = countLeft, countR = countRight;
+
+	memset(sample, 0, FIELDS);
+	for (joystick = 1; joystick <= 2; joystick++) {
+		if (!isJoystickConnected(joystick))
+			continue;
+		for (i = 0; i < 4; i++) {
+			sample[FIELD_AXES + (joystick - 1) * 4 + i] = joystickGetAnalog(joystick, i + 1);
+			sample[FIELD_BUTTONS + (joystick - 1) * 4 + i] = routeButtons(joystick, i + 5);
+		}
+	}
+	if (driveConfigured)
+		driveGetCounts(&countL, &countR);
+	if (!started) {
+		//Travel is measured from the first movement
+		countLeft = countL;
+		countRight = countR;
+	}
+	sample[FIELD_TRAVEL] = routeTravel(&countLeft, countL);
+	sample[FIELD_TRAVEL + 1] = routeTravel(&countRight, countR);
+}
+
+static void routePut(unsigned char value) {
+	half[pos & 1] = value;
+	pos++;
+	check += value;
+	if ((pos & 1) == 0)
+		flashWrite(data + pos - 2, half, 2);
+}
+
+static void routePutIdle() {
+	if (idle > 0) {
+		routePut(0);
+		routePut(0);
+		routePut(0);
+		routePut(idle);
+		idle = 0;
+	}
+}
+
+// Saves what has been recorded and stops; called with the lock held
+static void routeFinish() {
+	RouteHeader saved;
+
+	if (state == ROUTE_RECORDING && started) {
+		//Nothing happened after the last change
+		ticks -= idle;
+		if (pos & 1) {
+			half[1] = 0xFF;
+			flashWrite(data + pos - 1, half, 2);
+		}
+		saved.magic = ROUTE_MAGIC;
+		saved.tick = tick;
+		saved.ticks = ticks;
+		saved.bytes = pos;
+		saved.check = check;
+		flashWrite(routeFlash, &saved, sizeof(saved));
+	}
+	state = ROUTE_IDLE;
+}
+
+static void routeRecordTick() {
+	unsigned char sample[FIELDS];
+	unsigned long mask = 0;
+	unsigned int i, size = 3;
+
+	routeSample(sample);
+	for (i = 0; i < FIELDS; i++)
+		if (sample[i] != frame[i]) {
+			mask |= 1UL << i;
+			size++;
+		}
+	if (!started && mask == 0)
+		return;
+	started = true;
+	if (mask == 0) {
+		if (idle == IDLE_MAX) {
+			if (pos + 4 > ROUTE_DATA) {
+				routeFinish();
+				return;
+			}
+			routePutIdle();
+		}
+		idle++;
+	}
+	else if (pos + size + (idle > 0 ? 4 : 0) > ROUTE_DATA) {
+		routeFinish();
+		return;
+	}
+	else {
+		routePutIdle();
+		routePut(mask);
+		routePut(mask >> 8);
+		routePut(mask >> 16);
+		for (i = 0; i < FIELDS; i++)
+			if (mask & (1UL << i))
+				routePut(sample[i] - frame[i]);
+		memcpy(frame, sample, FIELDS);
+	}
+	ticks++;
+	if (ticks == maxTicks)
+		routeFinish();
+}
+
+static void routePlayTick() {
+	unsigned long mask;
+	unsigned int i;
+
+	if (ticks == header->ticks) {
+		state = ROUTE_IDLE;
+		return;
+	}
+	if (idle > 0)
+		idle--;
+	else {
+		mask = data[pos] | (data[pos + 1] << 8) | ((unsigned long)data[pos + 2] << 16);
+		pos += 3;
+		if (mask == 0)
+			idle = data[pos++] - 1;
+		for (i = 0; i < FIELDS; i++)
+			if (mask & (1UL << i))
+				frame[i] += data[pos++];
+	}
+	countLeft += (signed char)frame[FIELD_TRAVEL];
+	countRight += (signed char)frame[FIELD_TRAVEL + 1];
+	ticks++;
+}
+
+static void routeTask(void *parameters) {
+	unsigned long mine = (unsigned long)parameters;
+	unsigned long wakeTime = millis();
+
+	while (1) {
+		routeLock();
+		if (generation != mine || state == ROUTE_IDLE) {
+			routeUnlock();
+			break;
+		}
+		if (state == ROUTE_RECORDING)
+			routeRecordTick();
+		else
+			routePlayTick();
+		routeUnlock();
+		taskDelayUntil(&wakeTime, tick);
+	}
+	taskDelete(NULL);
+}
+
+// Resets the tick state and starts a new tick task; called with the lock held
+static void routeStart(RouteState newState) {
+	memset(frame, 0, sizeof(frame));
+	ticks = 0;
+	pos = 0;
+	check = 0;
+	idle = 0;
+	started = false;
+	state = newState;
+	generation++;
+	taskCreate(routeTask, TASK_DEFAULT_STACK_SIZE, (void *)generation,
+		TASK_PRIORITY_DEFAULT + 1);
+}
+
+void routeInit() {
+	if (!lock)
+		lock = mutexCreate();
+}
+
+bool routeRecordStart(unsigned long maxTime) {
+	unsigned int i;
+	bool ok = true;
+
+	routeLock();
+	routeFinish();
+	for (i = 0; ok && i < ROUTE_BYTES; i += FLASH_PAGE_BYTES)
+		ok = flashErase(routeFlash + i);
+	if (ok) {
+		tick = ROUTE_TICK_MS;
+		maxTicks = maxTime / tick;
+		routeStart(ROUTE_RECORDING);
+	}
+	routeUnlock();
+	return ok;
+}
+
+void routeRecordStop() {
+	routeLock();
+	if (state == ROUTE_RECORDING)
+		routeFinish();
+	routeUnlock();
+}
+
+bool routeRecording() {
+	return state == ROUTE_RECORDING;
+}
+
+bool routePlay(bool correct) {
+	bool ok;
+
+	routeLock();
+	routeFinish();
+	ok = routeValid();
+	if (ok) {
+		tick = header->tick;
+		correcting = correct && driveConfigured;
+		countLeft = countRight = 0;
+		if (driveConfigured)
+			driveGetCounts(&countLeft, &countRight);
+		routeStart(ROUTE_PLAYING);
+	}
+	routeUnlock();
+	return ok;
+}
+
+void routePlayStop() {
+	routeLock();
+	if (state == ROUTE_PLAYING)
+		routeFinish();
+	routeUnlock();
+}
+
+bool routePlaying() {
+	return state == ROUTE_PLAYING;
+}
+
+unsigned long routeLength() {
+	return routeValid() ? header->ticks * header->tick : 0;
+}
+
+int routeJoystickAnalog(unsigned char joystick, unsigned char axis) {
+	if (state == ROUTE_PLAYING && joystick >= 1 && joystick <= 2 && axis >= 1 && axis <= 4)
+		return (signed char)frame[FIELD_AXES + (joystick - 1) * 4 + axis - 1];
+	return joystickGetAnalog(joystick, axis);
+}
+
+bool routeJoystickDigital(unsigned char joystick, unsigned char buttonGroup,
+		unsigned char button) {
+	if (state == ROUTE_PLAYING && joystick >= 1 && joystick <= 2 && buttonGroup >= 5 &&
+			buttonGroup <= 8)
+		return (frame[FIELD_BUTTONS + (joystick - 1) * 4 + buttonGroup - 5] & button) != 0;
+	return joystickGetDigital(joystick, buttonGroup, button);
+}
+
+static int routeClamp(int speed) {
+	if (speed > 127)
+		return 127;
+	if (speed < -127)
+		return -127;
+	return speed;
+}
+
+void routeCorrect(int *left, int *right) {
+	int countL, countR;
+
+	if (state != ROUTE_PLAYING || !correcting || !driveGetCounts(&countL, &countR))
+		return;
+	*left = routeClamp(*left + (countLeft - countL) / ROUTE_CORRECT_DIV);
+	*right = routeClamp(*right + (countRight - countR) / ROUTE_CORRECT_DIV);
+}
@@ -0,0 +1,163 @@
+/** @file selector.c
+ * @brief Autonomous routine and alliance chosen on the VEX LCD
+ *
+ * Each choice is saved as a 4-byte entry after the last one in a page of kept flash, so the
+ * page is only erased once it fills up: the mark, the routine, the alliance and a check byte.
+ * The last intact entry is the saved choice.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+
+// First byte of a saved entry
+#define SAVE_MARK 0xA5
+#define SAVE_ENTRY 4
+#define SAVE_ENTRIES (FLASH_PAGE_BYTES / SAVE_ENTRY)
+// Time between reads of the LCD buttons in milliseconds
+#define SELECTOR_POLL_MS 20
+// Width of the LCD in characters
+#define LCD_WIDTH 16
+
+static unsigned char saved[FLASH_PAGE_BYTES] FLASH_USER;
+
+static const SelectorRoutine *routines;
+static unsigned char routineCount;
+static void (*chosen)(bool red);
+static unsigned char routine;
+static bool red;
+
+static unsigned char selectorCheck(unsigned char index, bool isRed) {
+	return ~(index + isRed);
+}
+
+// Finds the last intact entry, if any, and the first free one, SAVE_ENTRIES if the page is full
+static bool selectorFind(unsigned int *last, unsigned int *next) {
+	const unsigned char *entry;
+	unsigned int i;
+	bool found = false;
+
+	for (i = 0; i < SAVE_ENTRIES; i++) {
+		entry = saved + i * SAVE_ENTRY;
+		if (entry[0] == 0xFF && entry[1] == 0xFF && entry[2] == 0xFF && entry[3] == 0xFF)
+			break;
+		if (entry[0] == SAVE_MARK && entry[2] <= 1 &&
+				entry[3] == selectorCheck(entry[1], entry[2])) {
+			*last = i;
+			found = true;
+		}
+	}
+	*next = i;
+	return found;
+}
+
+static void selectorSave() {
+	unsigned char entry[SAVE_ENTRY];
+	unsigned int last, next;
+
+	if (selectorFind(&last, &next) && saved[last * SAVE_ENTRY + 1] == routine &&
+			saved[last * SAVE_ENTRY + 2] == red)
+		return;
+	if (next == SAVE_ENTRIES) {
+		if (!flashErase(saved))
+			return;
+		next = 0;
+	}
+	entry[0] = SAVE_MARK;
+	entry[1] = routine;
+	entry[2] = red;
+	entry[3] = selectorCheck(routine, red);
+	flashWrite(saved + next * SAVE_ENTRY, entry, SAVE_ENTRY);
+}
+
+// Shows a title on line 1 and text between arrows on line 2, or without them when done
+static void selectorShow(FILE *lcdPort, const char *title, const char *text, bool arrows) {
+	char line[LCD_WIDTH + 1];
+	unsigned int length = strlen(text), i;
+
+	if (length > LCD_WIDTH - 4)
+		length = LCD_WIDTH - 4;
+	for (i = 0; i < LCD_WIDTH; i++)
+		line[i] = ' ';
+	line[LCD_WIDTH] = '\0';
+	memcpy(line + (LCD_WIDTH - length) / 2, text, length);
+	if (arrows) {
+		line[0] = '<';
+		line[LCD_WIDTH - 1] = '>';
+	}
+	lcdSetText(lcdPort, 1, title);
+	lcdSetText(lcdPort, 2, line);
+}
+
+static void selectorPage(FILE *lcdPort, unsigned char page) {
+	if (page == 0)
+		selectorShow(lcdPort, "Alliance", red ? "Red" : "Blue", true);
+	else if (page == 1)
+		selectorShow(lcdPort, "Autonomous", routines[routine].name, true);
+	else
+		selectorShow(lcdPort, red ? "Red alliance" : "Blue alliance", routines[routine].name,
+			false);
+}
+
+void selectorInit(FILE *lcdPort, const SelectorRoutine *list, unsigned char count,
+		unsigned long timeout) {
+	unsigned int last, next, buttons, held, pressed;
+	unsigned long pressTime;
+	unsigned char page = 0;
+
+	routines = list;
+	routineCount = count;
+	routine = 0;
+	red = false;
+	if (selectorFind(&last, &next) && saved[last * SAVE_ENTRY + 1] < count) {
+		routine = saved[last * SAVE_ENTRY + 1];
+		red = saved[last * SAVE_ENTRY + 2];
+	}
+
+	lcdInit(lcdPort);
+	lcdSetBacklight(lcdPort, true);
+	if (timeout > 0) {
+		selectorPage(lcdPort, page);
+		//A button already held when the menu opens does nothing until it is let go
+		held = lcdReadButtons(lcdPort);
+		pressTime = millis();
+		while (page < 2 && !isEnabled() && millis() - pressTime < timeout) {
+			delay(SELECTOR_POLL_MS);
+			buttons = lcdReadButtons(lcdPort);
+			pressed = buttons & ~held;
+			held = buttons;
+			if (!pressed)
+				continue;
+			pressTime = millis();
+			if (pressed & LCD_BTN_CENTER)
+				page++;
+			else if (page == 0)
+				red = !red;
+			else if (pressed & LCD_BTN_LEFT)
+				routine = routine > 0 ? routine - 1 : count - 1;
+			else
+				routine = routine < count - 1 ? routine + 1 : 0;
+			selectorPage(lcdPort, page);
+		}
+		selectorSave();
+	}
+	selectorPage(lcdPort, 2);
+	chosen = routines[routine].run;
+}
+
+void selectorRun() {
+	if (chosen)
+		chosen(red);
+}
+
+unsigned char selectorRoutine() {
+	return routine;
+}
+
+unsigned char selectorCount() {
+	return routineCount;
+}
+
+bool selectorRed() {
+	return red;
+}
@@ -0,0 +1,25 @@
+/** @file sensors.c
+ * @brief Line sensor configuration and reading
+ */
+
+#include "internal.h"
+
+static LineConfig line;
+bool lineConfigured = false;
+
+void lineInit(const LineConfig *config) {
+	line = *config;
+	lineConfigured = true;
+}
+
+int lineReadLeft() {
+	return analogRead(line.left);
+}
+
+int lineReadRight() {
+	return analogRead(line.right);
+}
+
+bool lineSeen(int value) {
+	return value <= line.thresh;
+}
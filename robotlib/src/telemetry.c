@@ -0,0 +1,30 @@
+/** @file telemetry.c
+ * @brief Sensor dumps over the serial port
+ */
+
+#include "internal.h"
+
+void telemetryPrint(Ultrasonic ult) {
+	int countL, countR;
+
+	if (armConfigured)
+		printf("Arm:%d, ", armGetPos());
+	if (driveConfigured) {
+		driveGetCounts(&countL, &countR);
+		printf("IME_L:%d, IME_R:%d, ", countL, countR);
+	}
+	if (ult)
+		printf("UltraDist:%d, ", ultrasonicGet(ult));
+	if (lineConfigured)
+		printf("LineL:%d, LineR:%d", lineReadLeft(), lineReadRight());
+	printf("\r\n");
+}
+
+void telemetryRun(Ultrasonic ult, unsigned long period) {
+	unsigned long wakeTime = millis();
+
+	while (1) {
+		telemetryPrint(ult);
+		taskDelayUntil(&wakeTime, period);
+	}
+}
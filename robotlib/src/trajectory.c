@@ -0,0 +1,47 @@
+/** @file trajectory.c
+ * @brief Drive trajectories planned on the host and played from tables in flash
+ */
+
+#include "internal.h"
+
+unsigned long trajectoryTime(const Trajectory *trajectory) {
+	return (unsigned long)trajectory->count * trajectory->period;
+}
+
+// Output for one side: feedforward from the table plus how far behind it the side is
+static int trajectorySide(const TrajectoryGains *gains, int target, int velocity, int last,
+	int period, int count) {
+	return feedforward(&gains->ff, velocity, (velocity - last) * 1000 / period) +
+		gains->kP * (target - count) / 1000;
+}
+
+bool trajectoryFollow(const Trajectory *trajectory, const TrajectoryGains *gains, bool mirror) {
+	const TrajectoryPoint *point;
+	unsigned long wakeTime = millis();
+	int startLeft, startRight, left, right, targetLeft = 0, targetRight = 0;
+	int velLeft, velRight, lastLeft = 0, lastRight = 0;
+	unsigned short i;
+
+	driveGetCounts(&startLeft, &startRight);
+	for (i = 0; i < trajectory->count; i++) {
+		point = &trajectory->points[i];
+		//Mirrored, each side drives what the other would
+		targetLeft = mirror ? point->right : point->left;
+		targetRight = mirror ? point->left : point->right;
+		velLeft = mirror ? point->rightVelocity : point->leftVelocity;
+		velRight = mirror ? point->leftVelocity : point->rightVelocity;
+		driveGetCounts(&left, &right);
+		driveTank(trajectorySide(gains, targetLeft, velLeft, lastLeft, trajectory->period,
+			left - startLeft), trajectorySide(gains, targetRight, velRight, lastRight,
+			trajectory->period, right - startRight));
+		lastLeft = velLeft;
+		lastRight = velRight;
+		taskDelayUntil(&wakeTime, trajectory->period);
+	}
+	driveStop();
+	driveGetCounts(&left, &right);
+	left -= startLeft + targetLeft;
+	right -= startRight + targetRight;
+	return left < TRAJECTORY_TOLERANCE && left > -TRAJECTORY_TOLERANCE &&
+		right < TRAJECTORY_TOLERANCE && right > -TRAJECTORY_TOLERANCE;
+}
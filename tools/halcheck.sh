@@ -0,0 +1,75 @@
+#!/bin/sh
+# Checks that functions written with the C++ ports in robotlib/include/hal.h compile to the same
+# instructions as the hand-written C they stand for.
+#
+# Usage: halcheck.sh <objdump> <c object> <c++ object>
+#   objdump     the objdump to disassemble with, e.g. arm-none-eabi-objdump
+#   c object    halcheck.c compiled with CFLAGS
+#   c++ object  halcheck.cpp compiled with CPPFLAGS
+#
+# Each function nameC in the C object is compared with nameHal in the C++ object. Prints the
+# number of instructions in both and exits nonzero if a hal.h function is missing, longer, or
+# as long but different. It can come out shorter where C++ treats bool results more simply.
+
+OBJDUMP=$1
+COBJ=$2
+CPPOBJ=$3
+
+if [ ! -f "$COBJ" ] || [ ! -f "$CPPOBJ" ]; then
+	echo "halcheck: $COBJ or $CPPOBJ missing" >&2
+	exit 1
+fi
+
+# Prints "<function> <instruction>" for every instruction and relocation, with addresses and
+# the function's own name taken out so the same code reads the same in both objects
+disassemble() {
+	"$OBJDUMP" -dr --no-show-raw-insn "$1" | awk -v suffix="$2" '
+	/^[0-9a-f]+ <.*>:$/ {
+		name = $2
+		gsub(/[<>:]/, "", name)
+		if (substr(name, length(name) - length(suffix) + 1) == suffix)
+			func = substr(name, 1, length(name) - length(suffix))
+		else
+			func = ""
+		next
+	}
+	func != "" && /^ *[0-9a-f]+:/ {
+		line = $0
+		sub(/^ *[0-9a-f]+:[ \t]*/, "", line)
+		gsub("<" func suffix, "<", line)
+		# Branches within the function are compared by their offset alone
+		gsub(/[ \t]+[0-9a-f]+ </, " <", line)
+		gsub(/[ \t]+/, " ", line)
+		print func, line
+	}'
+}
+
+TMP=${TMPDIR:-/tmp}/halcheck.$$
+trap 'rm -f "$TMP".c "$TMP".hal' EXIT
+disassemble "$COBJ" C > "$TMP".c
+disassemble "$CPPOBJ" Hal > "$TMP".hal
+
+status=0
+printf '%-16s %6s %6s\n' function C hal.h
+for func in $(cut -d' ' -f1 "$TMP".c | uniq); do
+	c=$(grep -c "^$func " "$TMP".c)
+	hal=$(grep -c "^$func " "$TMP".hal)
+	if [ "$hal" -eq 0 ]; then
+		result="missing"
+		status=1
+	elif [ "$(grep "^$func " "$TMP".c)" = "$(grep "^$func " "$TMP".hal)" ]; then
+		result="same"
+	elif [ "$hal" -lt "$c" ]; then
+		result="shorter"
+	else
+		result="DIFFERENT"
+		status=1
+	fi
+	printf '%-16s %6d %6d  %s\n' "$func" "$c" "$hal" "$result"
+done
+if [ $status -eq 0 ]; then
+	echo "halcheck: hal.h adds no instructions"
+else
+	echo "halcheck: hal.h code is longer or differs from the C" >&2
+fi
+exit $status
@@ -0,0 +1,40 @@
+/** @file halcheck.c
+ * @brief Hand-written C for the functions in halcheck.cpp, ports as #define numbers
+ */
+
+#include <API.h>
+
+#define DRIVE_L 6
+#define DRIVE_R 9
+#define ARM_POT 1
+#define LIMIT_TOP 3
+#define IME_LEFT 0
+
+void driveC(int left, int right) {
+	motorSet(DRIVE_L, left);
+	motorSet(DRIVE_R, -right);
+}
+
+int driveRightC() {
+	return -motorGet(DRIVE_R);
+}
+
+void driveStopC() {
+	motorStop(DRIVE_L);
+	motorStop(DRIVE_R);
+}
+
+bool armClearC() {
+	return analogRead(ARM_POT) > 2000 && digitalRead(LIMIT_TOP) == HIGH;
+}
+
+int armOffsetC() {
+	return analogReadCalibrated(ARM_POT);
+}
+
+bool imeLeftC(int *count) {
+	bool ok = imeGet(IME_LEFT, count);
+
+	*count = -*count;
+	return ok;
+}
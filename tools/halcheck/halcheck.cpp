@@ -0,0 +1,44 @@
+/** @file halcheck.cpp
+ * @brief The functions of halcheck.c written with hal.h, for comparing their code
+ */
+
+#include <hal.h>
+
+typedef hal::Motor<6> DriveLeft;
+typedef hal::Motor<9, true> DriveRight;
+typedef hal::AnalogIn<1> ArmPot;
+typedef hal::DigitalIn<3> LimitTop;
+typedef hal::Ime<0, true> ImeLeft;
+
+static_assert(hal::distinct<DriveLeft, DriveRight, ArmPot, LimitTop, ImeLeft>(),
+	"two devices share a port");
+
+extern "C" {
+
+void driveHal(int left, int right) {
+	DriveLeft::set(left);
+	DriveRight::set(right);
+}
+
+int driveRightHal() {
+	return DriveRight::get();
+}
+
+void driveStopHal() {
+	DriveLeft::stop();
+	DriveRight::stop();
+}
+
+bool armClearHal() {
+	return ArmPot::read() > 2000 && LimitTop::read() == HIGH;
+}
+
+int armOffsetHal() {
+	return ArmPot::readCalibrated();
+}
+
+bool imeLeftHal(int *count) {
+	return ImeLeft::get(count);
+}
+
+}
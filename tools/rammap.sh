@@ -0,0 +1,101 @@
+#!/bin/sh
+# Prints how the RAM of a linked PROS program is spent: .data (with the RAMFUNC code copied
+# into it) and .bss by owner (the program's objects, librobot.a, the PROS libccos.a) and by
+# symbol, and the heap left after them, which FreeRTOS task stacks and malloc() share.
+#
+# Usage: rammap.sh <nm> <elf> <map>
+#   nm        the nm to read symbols with, e.g. arm-none-eabi-nm
+#   elf       the linked program (bin/output.elf)
+#   map       the linker map written next to it (bin/output.map)
+
+NM=$1
+ELF=$2
+MAP=$3
+
+# RAM of the VEX Cortex STM32F103 (see firmware/STM32F10x.ld)
+RAM_START=536870912
+RAM_SIZE=65536
+# A task of TASK_DEFAULT_STACK_SIZE words takes its stack, a FreeRTOS control block and the
+# heap's header on each; the last two are about 80 bytes on the Cortex
+TASK_BYTES=2128
+# Number of symbols listed for each section
+TOP=30
+
+if [ ! -f "$ELF" ] || [ ! -f "$MAP" ]; then
+	echo "rammap: $ELF or $MAP missing, build first" >&2
+	exit 1
+fi
+
+SYMBOLS=$("$NM" -S -t d "$ELF")
+
+# Where the heap starts and the stack ends, from cortex.ld and STM32F10x.ld
+echo "$SYMBOLS" | awk -v ramStart=$RAM_START -v ramSize=$RAM_SIZE -v taskBytes=$TASK_BYTES '
+$NF == "_sdata" { sdata = $1 }
+$NF == "_edata" { edata = $1 }
+$NF == "_sbss" { sbss = $1 }
+$NF == "_ebss" { ebss = $1 }
+$NF == "_heapbegin" { heap = $1 }
+$NF == "_estack" { stack = $1 }
+END {
+	if (stack == "")
+		stack = ramStart + ramSize
+	if (heap == "") {
+		print "rammap: no _heapbegin in the program, was it linked with cortex.ld?" > "/dev/stderr"
+		exit 1
+	}
+	printf "RAM %d bytes from 0x%08x\n", ramSize, ramStart
+	printf "  .data %7d bytes (initial values kept in flash)\n", edata - sdata
+	printf "  .bss  %7d bytes\n", ebss - sbss
+	printf "  heap  %7d bytes from 0x%08x, room for about %d tasks of TASK_DEFAULT_STACK_SIZE\n",
+		stack - heap, heap, (stack - heap) / taskBytes
+	print "  The heap also holds the PROS system tasks and the interrupt stack at its top."
+}' || exit 1
+
+# Owners, from the input sections in the memory map part of the linker map; objects in an
+# archive are shown as the archive
+echo
+echo "By owner:"
+printf "%8s %8s  %s\n" data bss owner
+awk '
+function hex(s,    i, n) {
+	n = 0
+	s = tolower(substr(s, 3))
+	for (i = 1; i <= length(s); i++)
+		n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}
+function add(sect, size, file) {
+	if (size == 0 || file == "")
+		return
+	sub(/\(.*\)$/, "", file)
+	if (sect ~ /^\.(bss|COMMON)/ || sect == "COMMON")
+		bss[file] += size
+	else if (sect ~ /^\.(data|RAMtext)/)
+		data[file] += size
+	else
+		return
+	seen[file] = 1
+}
+/^Linker script and memory map/ { inmap = 1; next }
+!inmap { next }
+/^ [.A-Z]/ && NF >= 4 && $2 ~ /^0x/ { add($1, hex($3), $4); pending = ""; next }
+/^ [.A-Z]/ && NF == 1 { pending = $1; next }
+pending != "" && NF >= 3 && $1 ~ /^0x/ { add(pending, hex($2), $3); pending = ""; next }
+{ pending = "" }
+END {
+	for (f in seen)
+		printf "%8d %8d  %s\n", data[f], bss[f], f
+}' "$MAP" | sort -k1,1nr -k2,2nr
+
+# Symbols in RAM, largest first
+for section in data bss; do
+	echo
+	echo "Largest $TOP .$section symbols:"
+	printf "%8s  %s\n" bytes symbol
+	echo "$SYMBOLS" | awk -v section=$section -v ramStart=$RAM_START -v ramSize=$RAM_SIZE '
+	NF >= 4 && $1 + 0 >= ramStart && $1 + 0 < ramStart + ramSize {
+		# RAMFUNC code is text that lives in .data
+		if ((section == "data" && $3 ~ /^[DdTt]$/) || (section == "bss" && $3 ~ /^[BbCc]$/))
+			printf "%8d  %s\n", $2, $4
+	}' | sort -k1,1nr | head -n $TOP
+done
@@ -0,0 +1,134 @@
+#!/bin/sh
+# Prints per-object and per-symbol flash/RAM use of a linked PROS program, and what changed
+# since a saved baseline.
+#
+# Usage: sizereport.sh <nm> <elf> <map> <report> [baseline]
+#   nm        the nm to read symbols with, e.g. arm-none-eabi-nm
+#   elf       the linked program (bin/output.elf)
+#   map       the linker map written next to it (bin/output.map)
+#   report    where to write the raw report; copy it to the baseline to compare against later
+#   baseline  a raw report from an earlier build (optional)
+#
+# Raw report lines are "<kind> <flash> <ram> <name>" where kind is obj, sym or total.
+
+NM=$1
+ELF=$2
+MAP=$3
+REPORT=$4
+BASELINE=$5
+
+# Budget of the VEX Cortex STM32F103 (see firmware/STM32F10x.ld), less the kept USERFLASH and
+# CALIBFLASH
+FLASH_SIZE=376832
+# Start of USERFLASH, with CALIBFLASH after it; their variables are data kept in flash, not program
+USERFLASH=134594560
+RAM_SIZE=65536
+# Number of symbols listed in the table
+TOP=40
+
+if [ ! -f "$ELF" ] || [ ! -f "$MAP" ]; then
+	echo "sizereport: $ELF or $MAP missing, build first" >&2
+	exit 1
+fi
+
+{
+	# Objects, from the input sections in the memory map part of the linker map
+	awk '
+	function hex(s,    i, n) {
+		n = 0
+		s = tolower(substr(s, 3))
+		for (i = 1; i <= length(s); i++)
+			n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+		return n
+	}
+	function add(sect, size, file) {
+		if (size == 0 || file == "")
+			return
+		if (sect ~ /^\.(bss|COMMON)/ || sect == "COMMON")
+			ram[file] += size
+		else if (sect ~ /^\.(data|RAMtext)/) {
+			flash[file] += size
+			ram[file] += size
+		}
+		else if (sect ~ /^\.(text|rodata|isr_vector|glue_7|init|fini|ctors|dtors|preinit_array|init_array|fini_array|ARM\.ex)/)
+			flash[file] += size
+	}
+	/^Linker script and memory map/ { inmap = 1; next }
+	!inmap { next }
+	# Input section on one line: " .text.foo 0x08000000 0x54 bin/auto.o"
+	/^ [.A-Z]/ && NF >= 4 && $2 ~ /^0x/ { add($1, hex($3), $4); pending = ""; next }
+	# Long input section names wrap onto a second line
+	/^ [.A-Z]/ && NF == 1 { pending = $1; next }
+	pending != "" && NF >= 3 && $1 ~ /^0x/ { add(pending, hex($2), $3); pending = ""; next }
+	{ pending = "" }
+	END {
+		for (f in flash)
+			seen[f] = 1
+		for (f in ram)
+			seen[f] = 1
+		for (f in seen)
+			printf "obj %d %d %s\n", flash[f], ram[f], f
+	}' "$MAP"
+
+	# Symbols, from the symbol table
+	"$NM" -S -t d --size-sort "$ELF" | awk -v userFlash=$USERFLASH '
+	NF >= 4 && $1 + 0 < userFlash {
+		size = $2 + 0
+		type = $3
+		name = $4
+		if (type ~ /^[TtWwRr]$/)
+			printf "sym %d 0 %s\n", size, name
+		else if (type ~ /^[Dd]$/)
+			printf "sym %d %d %s\n", size, size, name
+		else if (type ~ /^[BbCc]$/)
+			printf "sym 0 %d %s\n", size, name
+	}'
+} > "$REPORT.tmp"
+
+# Totals come from the objects, which include anonymous data the symbol table does not name
+awk '$1 == "obj" { flash += $2; ram += $3 } END { printf "total %d %d all\n", flash, ram }' \
+	"$REPORT.tmp" >> "$REPORT.tmp"
+sort -k1,1 -k2,2nr -k3,3nr "$REPORT.tmp" > "$REPORT"
+rm -f "$REPORT.tmp"
+
+awk -v flashSize=$FLASH_SIZE -v ramSize=$RAM_SIZE '
+$1 == "total" {
+	printf "Flash: %7d / %d bytes (%.1f%%)\n", $2, flashSize, 100 * $2 / flashSize
+	printf "RAM:   %7d / %d bytes (%.1f%%)\n", $3, ramSize, 100 * $3 / ramSize
+}' "$REPORT"
+
+echo
+echo "By object:"
+printf "%8s %8s  %s\n" flash ram object
+awk '$1 == "obj" { printf "%8d %8d  %s\n", $2, $3, $4 }' "$REPORT" | sort -k1,1nr -k2,2nr
+
+echo
+echo "Largest $TOP symbols:"
+printf "%8s %8s  %s\n" flash ram symbol
+awk '$1 == "sym" { printf "%8d %8d  %s\n", $2, $3, $4 }' "$REPORT" | \
+	sort -k1,1nr -k2,2nr | head -n $TOP
+
+if [ -n "$BASELINE" ] && [ -f "$BASELINE" ]; then
+	echo
+	echo "Changes since $BASELINE:"
+	printf "%8s %8s  %s\n" flash ram name
+	awk '
+	NR == FNR { oldFlash[$1 " " $4] = $2; oldRam[$1 " " $4] = $3; key[$1 " " $4] = 1; next }
+	{ newFlash[$1 " " $4] = $2; newRam[$1 " " $4] = $3; key[$1 " " $4] = 1 }
+	END {
+		for (k in key) {
+			df = newFlash[k] - oldFlash[k]
+			dr = newRam[k] - oldRam[k]
+			if (df != 0 || dr != 0) {
+				split(k, part, " ")
+				if (!(k in newFlash))
+					note = " (removed)"
+				else if (!(k in oldFlash))
+					note = " (new)"
+				else
+					note = ""
+				printf "%+8d %+8d  %s %s%s\n", df, dr, part[1], part[2], note
+			}
+		}
+	}' "$BASELINE" "$REPORT" | sort -k3,3 -k1,1nr
+fi
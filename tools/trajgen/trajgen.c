@@ -0,0 +1,410 @@
+/** @file trajgen.c
+ * @brief Plans drive trajectories on the host and writes them as tables for trajectory.h
+ *
+ * Fits a spline through waypoints, finds the fastest speed along it that keeps the outside
+ * wheel within maxVelocity, the sideways pull within maxLateral and the speed changes within
+ * maxAccel, starting and ending stopped, and samples where each drive side should be and how
+ * fast it should go every period. The table is written as a const Trajectory, so it is linked
+ * into flash and the robot only reads it; see trajectory.h.
+ *
+ * Usage: trajgen <path> <c file>
+ *   path     a path spec, as below
+ *   c file   the C source to write, e.g. src/<name>.c
+ *
+ * A path spec has one setting or waypoint per line; # starts a comment:
+ *
+ *     name ramCurve          # name of the Trajectory, default the file's name
+ *     countsPerInch 49.34    # drive counts per inch, as in OdomConfig
+ *     trackWidth 15          # inches between the left and right wheels
+ *     period 10              # milliseconds between table entries
+ *     maxVelocity 16         # inches per second of the faster wheel
+ *     maxAccel 30            # inches per second squared along the path
+ *     maxLateral 40          # inches per second squared sideways on curves, 0 for no limit
+ *     reverse 1              # drive the path backwards
+ *     point 0 0              # waypoints in inches, x forward and y left at the start
+ *     point -14 4
+ *
+ * The spline is a centripetal Catmull-Rom, which unlike the uniform kind does not swing wide
+ * where waypoints are unevenly spaced. The robot starts facing along the first leg and the end
+ * is left free. A tangent is turned onto a leg where it would otherwise make the spline weave
+ * across it, so the first leg is driven straight. A path that still turns on a leg the other
+ * way from the waypoints at its ends is refused.
+ *
+ * Prints the path's length, time and table size.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Most waypoints in a path
+#define TRAJGEN_POINTS 32
+// Spline samples between two waypoints, fine enough that the table's steps are far longer
+#define TRAJGEN_STEPS 2000
+// Largest table, which at 10 ms is a whole autonomous period
+#define TRAJGEN_TABLE 1500
+// Size of a TrajectoryPoint on the Cortex
+#define TRAJGEN_ENTRY_BYTES 12
+// Radians a leg may turn the other way from the waypoints at its ends; the uniform spline swung
+// 18 degrees the wrong way off ramCurve's straight first leg
+#define TRAJGEN_OVERSHOOT (M_PI / 180)
+// Radians off a leg that a tangent still counts as along it
+#define TRAJGEN_ALONG 1e-9
+
+typedef struct {
+	char name[64];
+	double countsPerInch;
+	double trackWidth;
+	int period;
+	double maxVelocity;
+	double maxAccel;
+	double maxLateral;
+	int reverse;
+	double x[TRAJGEN_POINTS];
+	double y[TRAJGEN_POINTS];
+	int count;
+} Spec;
+
+// A point on the spline: distance along it, curvature, speed limit, speed and time there
+typedef struct {
+	double s;
+	double k;
+	double limit;
+	double v;
+	double t;
+} Sample;
+
+static Sample samples[(TRAJGEN_POINTS - 1) * TRAJGEN_STEPS + 1];
+// Tangent at each waypoint for the legs before and after it, scaled to their lengths
+static double tangentIn[TRAJGEN_POINTS][2], tangentOut[TRAJGEN_POINTS][2];
+
+static void fail(const char *file, int line, const char *message) {
+	if (line)
+		fprintf(stderr, "trajgen: %s:%d: %s\n", file, line, message);
+	else
+		fprintf(stderr, "trajgen: %s: %s\n", file, message);
+	exit(1);
+}
+
+// Reads a path spec, with the defaults for anything it leaves out
+static void readSpec(const char *file, Spec *spec) {
+	char text[256], key[32], *hash;
+	const char *base;
+	double a, b;
+	int line = 0, fields;
+	FILE *in = fopen(file, "r");
+
+	if (!in)
+		fail(file, 0, "cannot open");
+	memset(spec, 0, sizeof(*spec));
+	base = strrchr(file, '/') ? strrchr(file, '/') + 1 : file;
+	snprintf(spec->name, sizeof(spec->name), "%.*s", (int)strcspn(base, "."), base);
+	spec->countsPerInch = 1;
+	spec->trackWidth = 15;
+	spec->period = 10;
+	spec->maxVelocity = 12;
+	spec->maxAccel = 24;
+	while (fgets(text, sizeof(text), in)) {
+		line++;
+		if ((hash = strchr(text, '#')))
+			*hash = '\0';
+		fields = sscanf(text, "%31s %lf %lf", key, &a, &b);
+		if (fields < 1)
+			continue;
+		if (!strcmp(key, "name")) {
+			if (sscanf(text, "%*s %63s", spec->name) != 1)
+				fail(file, line, "name needs a value");
+		}
+		else if (!strcmp(key, "point")) {
+			if (fields != 3)
+				fail(file, line, "point needs x and y");
+			if (spec->count >= TRAJGEN_POINTS)
+				fail(file, line, "too many points");
+			spec->x[spec->count] = a;
+			spec->y[spec->count] = b;
+			spec->count++;
+		}
+		else if (fields != 2)
+			fail(file, line, "setting needs one number");
+		else if (!strcmp(key, "countsPerInch"))
+			spec->countsPerInch = a;
+		else if (!strcmp(key, "trackWidth"))
+			spec->trackWidth = a;
+		else if (!strcmp(key, "period"))
+			spec->period = (int)a;
+		else if (!strcmp(key, "maxVelocity"))
+			spec->maxVelocity = a;
+		else if (!strcmp(key, "maxAccel"))
+			spec->maxAccel = a;
+		else if (!strcmp(key, "maxLateral"))
+			spec->maxLateral = a;
+		else if (!strcmp(key, "reverse"))
+			spec->reverse = a != 0;
+		else
+			fail(file, line, "unknown setting");
+	}
+	fclose(in);
+	if (spec->count < 2)
+		fail(file, 0, "needs at least two points");
+	if (spec->countsPerInch <= 0 || spec->trackWidth <= 0 || spec->period <= 0 ||
+		spec->maxVelocity <= 0 || spec->maxAccel <= 0 || spec->maxLateral < 0)
+		fail(file, 0, "limits must be positive");
+	if (!isalpha((unsigned char)spec->name[0]) && spec->name[0] != '_')
+		fail(file, 0, "name is not a C identifier");
+}
+
+// Parameter span of the leg from point i: the square root of its length, for centripetal
+static double legSpan(const Spec *spec, int i) {
+	double span = sqrt(hypot(spec->x[i + 1] - spec->x[i], spec->y[i + 1] - spec->y[i]));
+
+	return span > 0 ? span : 1e-9;
+}
+
+// Angle that turns direction (ax, ay) to (bx, by), -pi to pi counterclockwise
+static double turnBetween(double ax, double ay, double bx, double by) {
+	return atan2(ax * by - ay * bx, ax * bx + ay * by);
+}
+
+// Turns a tangent onto the direction of leg i, keeping its length
+static void tangentAlong(const Spec *spec, int i, double *tangent) {
+	double length = hypot(tangent[0], tangent[1]);
+	double legX = spec->x[i + 1] - spec->x[i], legY = spec->y[i + 1] - spec->y[i];
+	double leg = hypot(legX, legY);
+
+	if (leg > 0) {
+		tangent[0] = legX * length / leg;
+		tangent[1] = legY * length / leg;
+	}
+}
+
+// Which way the waypoints turn at point p: 1 left, -1 right, 0 straight or an end
+static int cornerTurn(const Spec *spec, int p) {
+	double cross;
+
+	if (p <= 0 || p >= spec->count - 1)
+		return 0;
+	cross = (spec->x[p] - spec->x[p - 1]) * (spec->y[p + 1] - spec->y[p]) -
+		(spec->y[p] - spec->y[p - 1]) * (spec->x[p + 1] - spec->x[p]);
+	return cross > 0 ? 1 : cross < 0 ? -1 : 0;
+}
+
+// Works out the spline's tangent at each waypoint
+static void splineTangents(const Spec *spec) {
+	int last = spec->count - 1, p, i;
+	double velocity[2], turnStart, turnEnd, d0, d1;
+
+	//The robot starts facing along the first leg
+	tangentOut[0][0] = spec->x[1] - spec->x[0];
+	tangentOut[0][1] = spec->y[1] - spec->y[0];
+	for (p = 1; p < last; p++) {
+		//Velocity through the point against the centripetal parameter
+		d0 = legSpan(spec, p - 1);
+		d1 = legSpan(spec, p);
+		velocity[0] = (spec->x[p] - spec->x[p - 1]) / d0 - (spec->x[p + 1] - spec->x[p - 1]) /
+			(d0 + d1) + (spec->x[p + 1] - spec->x[p]) / d1;
+		velocity[1] = (spec->y[p] - spec->y[p - 1]) / d0 - (spec->y[p + 1] - spec->y[p - 1]) /
+			(d0 + d1) + (spec->y[p + 1] - spec->y[p]) / d1;
+		tangentIn[p][0] = velocity[0] * d0;
+		tangentIn[p][1] = velocity[1] * d0;
+		tangentOut[p][0] = velocity[0] * d1;
+		tangentOut[p][1] = velocity[1] * d1;
+	}
+	//Both tangents of a leg off the same side of it make it weave, which only belongs where
+	//the waypoints turn one way then the other; elsewhere, from the start, the far one is
+	//turned onto the leg, so a first leg the robot starts along is driven straight
+	for (i = 0; i < last - 1; i++) {
+		if (cornerTurn(spec, i) * cornerTurn(spec, i + 1) < 0)
+			continue;
+		turnStart = turnBetween(spec->x[i + 1] - spec->x[i], spec->y[i + 1] - spec->y[i],
+			tangentOut[i][0], tangentOut[i][1]);
+		turnEnd = turnBetween(spec->x[i + 1] - spec->x[i], spec->y[i + 1] - spec->y[i],
+			tangentIn[i + 1][0], tangentIn[i + 1][1]);
+		//A tangent along the leg counts as on the same side as the other
+		if (fabs(turnEnd) > TRAJGEN_ALONG && (turnEnd > 0 ? turnStart > -TRAJGEN_ALONG :
+			turnStart < TRAJGEN_ALONG)) {
+			tangentAlong(spec, i, tangentIn[i + 1]);
+			tangentAlong(spec, i, tangentOut[i + 1]);
+		}
+	}
+	//The end is left free, with no curvature, so the last leg does not turn back to meet it
+	tangentIn[last][0] = (3 * (spec->x[last] - spec->x[last - 1]) - tangentOut[last - 1][0]) / 2;
+	tangentIn[last][1] = (3 * (spec->y[last] - spec->y[last - 1]) - tangentOut[last - 1][1]) / 2;
+}
+
+// The first and second derivatives at u of the spline's leg from point i
+static void splineDerivatives(const Spec *spec, int i, double u, double *dx, double *dy,
+	double *ddx, double *ddy) {
+	const double *t0 = tangentOut[i], *t1 = tangentIn[i + 1];
+
+	//Derivatives of the cubic Hermite basis
+	*dx = (6 * u * u - 6 * u) * spec->x[i] + (3 * u * u - 4 * u + 1) * t0[0] +
+		(-6 * u * u + 6 * u) * spec->x[i + 1] + (3 * u * u - 2 * u) * t1[0];
+	*dy = (6 * u * u - 6 * u) * spec->y[i] + (3 * u * u - 4 * u + 1) * t0[1] +
+		(-6 * u * u + 6 * u) * spec->y[i + 1] + (3 * u * u - 2 * u) * t1[1];
+	*ddx = (12 * u - 6) * spec->x[i] + (6 * u - 4) * t0[0] +
+		(-12 * u + 6) * spec->x[i + 1] + (6 * u - 2) * t1[0];
+	*ddy = (12 * u - 6) * spec->y[i] + (6 * u - 4) * t0[1] +
+		(-12 * u + 6) * spec->y[i + 1] + (6 * u - 2) * t1[1];
+}
+
+// Refuses a spline that turns on a leg the way the waypoints at neither end of it turn
+static void checkHeading(const Spec *spec, const char *source) {
+	double dx, dy, ddx, ddy, turn, least, most;
+	char message[80];
+	int i, step, before, after;
+	bool left, right;
+
+	for (i = 0; i < spec->count - 1; i++) {
+		before = cornerTurn(spec, i);
+		after = cornerTurn(spec, i + 1);
+		left = before > 0 || after > 0;
+		right = before < 0 || after < 0;
+		least = 0;
+		most = 0;
+		for (step = 1; step < TRAJGEN_STEPS; step++) {
+			splineDerivatives(spec, i, (double)step / TRAJGEN_STEPS, &dx, &dy, &ddx, &ddy);
+			turn = turnBetween(tangentOut[i][0], tangentOut[i][1], dx, dy);
+			if ((!left && turn - least > TRAJGEN_OVERSHOOT) ||
+				(!right && most - turn > TRAJGEN_OVERSHOOT)) {
+				snprintf(message, sizeof(message), "heading overshoots between points %d and %d",
+					i + 1, i + 2);
+				fail(source, 0, message);
+			}
+			least = fmin(least, turn);
+			most = fmax(most, turn);
+		}
+	}
+}
+
+// Samples the spline and works out the speed and time at each sample
+static int plan(const Spec *spec) {
+	double dx, dy, ddx, ddy, speed, wheelScale, ds, u;
+	int n = 0, i, step;
+
+	//Distance and curvature, and the speed the limits allow there
+	for (i = 0; i < spec->count - 1; i++) {
+		for (step = i ? 1 : 0; step <= TRAJGEN_STEPS; step++) {
+			u = (double)step / TRAJGEN_STEPS;
+			splineDerivatives(spec, i, u, &dx, &dy, &ddx, &ddy);
+			speed = sqrt(dx * dx + dy * dy);
+			samples[n].k = speed > 0 ? (dx * ddy - dy * ddx) / (speed * speed * speed) : 0;
+			samples[n].s = n ? samples[n - 1].s + speed / TRAJGEN_STEPS : 0;
+			wheelScale = 1 + fabs(samples[n].k) * spec->trackWidth / 2;
+			samples[n].limit = spec->maxVelocity / wheelScale;
+			if (spec->maxLateral > 0 && samples[n].k != 0 &&
+				sqrt(spec->maxLateral / fabs(samples[n].k)) < samples[n].limit)
+				samples[n].limit = sqrt(spec->maxLateral / fabs(samples[n].k));
+			n++;
+		}
+	}
+	//Speeding up from a stop, then slowing down to one, as hard as maxAccel allows
+	samples[0].v = 0;
+	for (i = 1; i < n; i++) {
+		ds = samples[i].s - samples[i - 1].s;
+		samples[i].v = sqrt(samples[i - 1].v * samples[i - 1].v + 2 * spec->maxAccel * ds);
+		if (samples[i].v > samples[i].limit)
+			samples[i].v = samples[i].limit;
+	}
+	samples[n - 1].v = 0;
+	for (i = n - 2; i >= 0; i--) {
+		ds = samples[i + 1].s - samples[i].s;
+		speed = sqrt(samples[i + 1].v * samples[i + 1].v + 2 * spec->maxAccel * ds);
+		if (speed < samples[i].v)
+			samples[i].v = speed;
+	}
+	//Each step takes its length over its mean speed
+	samples[0].t = 0;
+	for (i = 1; i < n; i++) {
+		ds = samples[i].s - samples[i - 1].s;
+		samples[i].t = samples[i - 1].t +
+			(ds > 0 ? 2 * ds / (samples[i].v + samples[i - 1].v) : 0);
+	}
+	return n;
+}
+
+// Writes the table, one entry every period from the start to the end
+static void writeTable(const Spec *spec, int n, const char *source, const char *file) {
+	double period = spec->period / 1000.0, t, f, k, v, s, along, left, right, time;
+	double wheelLeft = 0, wheelRight = 0, ds;
+	long countLeft, countRight, velLeft, velRight, swap;
+	int entries = (int)ceil(samples[n - 1].t / period) + 1, entry, i = 1;
+	FILE *out;
+
+	if (entries > TRAJGEN_TABLE)
+		fail(source, 0, "path takes too long for the table");
+	out = fopen(file, "w");
+	if (!out)
+		fail(file, 0, "cannot write");
+	time = samples[n - 1].t;
+	fprintf(out, "/** @file %s\n", strrchr(file, '/') ? strrchr(file, '/') + 1 : file);
+	fprintf(out, " * @brief Trajectory %s, written by tools/trajgen from %s; do not edit\n",
+		spec->name, source);
+	fprintf(out, " *\n * %.1f inches %s in %.2f s, ", samples[n - 1].s,
+		spec->reverse ? "backwards" : "forwards", time);
+	fprintf(out, "%d entries every %d ms (%d bytes of flash)\n */\n\n", entries, spec->period,
+		entries * TRAJGEN_ENTRY_BYTES);
+	fprintf(out, "#include \"main.h\"\n\n");
+	fprintf(out, "static const TrajectoryPoint %sPoints[%d] = {\n", spec->name, entries);
+	//Wheel travel is summed sample by sample, so each side's distance follows the curve
+	for (entry = 0; entry < entries; entry++) {
+		t = entry * period;
+		if (t > time)
+			t = time;
+		while (i < n - 1 && samples[i].t < t) {
+			ds = samples[i].s - samples[i - 1].s;
+			wheelLeft += ds * (1 - samples[i].k * spec->trackWidth / 2);
+			wheelRight += ds * (1 + samples[i].k * spec->trackWidth / 2);
+			i++;
+		}
+		f = samples[i].t > samples[i - 1].t ?
+			(t - samples[i - 1].t) / (samples[i].t - samples[i - 1].t) : 1;
+		if (f > 1)
+			f = 1;
+		k = samples[i - 1].k + (samples[i].k - samples[i - 1].k) * f;
+		v = samples[i - 1].v + (samples[i].v - samples[i - 1].v) * f;
+		s = samples[i].s - samples[i - 1].s;
+		along = s * f;
+		left = wheelLeft + along * (1 - k * spec->trackWidth / 2);
+		right = wheelRight + along * (1 + k * spec->trackWidth / 2);
+		countLeft = lround(left * spec->countsPerInch);
+		countRight = lround(right * spec->countsPerInch);
+		velLeft = lround(v * (1 - k * spec->trackWidth / 2) * spec->countsPerInch);
+		velRight = lround(v * (1 + k * spec->trackWidth / 2) * spec->countsPerInch);
+		if (labs(velLeft) > 32767 || labs(velRight) > 32767)
+			fail(source, 0, "speed too high for the table");
+		//Backwards the robot's left wheel runs the path's right side in reverse
+		if (spec->reverse) {
+			swap = countLeft;
+			countLeft = -countRight;
+			countRight = -swap;
+			swap = velLeft;
+			velLeft = -velRight;
+			velRight = -swap;
+		}
+		fprintf(out, "\t{ %ld, %ld, %ld, %ld },\n", countLeft, countRight, velLeft, velRight);
+	}
+	fprintf(out, "};\n\nconst Trajectory %s = { %sPoints, %d, %d };\n", spec->name, spec->name,
+		entries, spec->period);
+	fclose(out);
+	printf("%s: %.1f in, %.2f s, %d entries of %d ms, %d bytes\n", spec->name, samples[n - 1].s,
+		time, entries, spec->period, entries * TRAJGEN_ENTRY_BYTES);
+}
+
+int main(int argc, char **argv) {
+	Spec spec;
+	int n;
+
+	if (argc != 3) {
+		fprintf(stderr, "usage: trajgen <path> <c file>\n");
+		return 2;
+	}
+	readSpec(argv[1], &spec);
+	splineTangents(&spec);
+	checkHeading(&spec, argv[1]);
+	n = plan(&spec);
+	writeTable(&spec, n, argv[1], argv[2]);
+	return 0;
+}